@@ -269,6 +269,8 @@ static void update_global_location_list_nothrow (enum ugll_insert_mode);
 
 static void insert_breakpoint_locations (void);
 
+static bool add_breakpoint_locations_to_global_list (breakpoint *b);
+
 static void trace_pass_command (const char *, int);
 
 static void set_tracepoint_count (int num);
@@ -860,20 +862,48 @@ set_breakpoint_count (int num)
    breakpoint count before "rbreak" creates any breakpoint.  */
 static int rbreak_start_breakpoint_count;
 
+/* While greater than zero, install_breakpoint does not rebuild the
+   global location list for each new breakpoint, but only records
+   that a rebuild is pending.  Every rebuild walks and sorts all the
+   locations, so doing it once per breakpoint makes creating many
+   breakpoints in a row quadratic.  */
+static int location_list_update_deferred;
+
+/* If set, a breakpoint was installed while the global location list
+   update was deferred, and the list must still be updated in this
+   mode, the strongest one requested while deferred.  */
+static gdb::optional<ugll_insert_mode> location_list_update_pending;
+
 /* Called at the start an "rbreak" command to record the first
    breakpoint made.  */
 
 scoped_rbreak_breakpoints::scoped_rbreak_breakpoints ()
 {
   rbreak_start_breakpoint_count = breakpoint_count;
+  ++location_list_update_deferred;
 }
 
 /* Called at the end of an "rbreak" command to record the last
-   breakpoint made.  */
+   breakpoint made, and to insert the locations of all the
+   breakpoints it created at once.  */
 
 scoped_rbreak_breakpoints::~scoped_rbreak_breakpoints ()
 {
   prev_breakpoint_count = rbreak_start_breakpoint_count;
+
+  gdb_assert (location_list_update_deferred > 0);
+  if (--location_list_update_deferred == 0
+      && location_list_update_pending.has_value ())
+    {
+      try
+	{
+	  update_global_location_list (*location_list_update_pending);
+	}
+      catch (const gdb_exception &e)
+	{
+	  exception_print (gdb_stderr, e);
+	}
+    }
 }
 
 /* Used in run_command to zero the hit count when a new run starts.  */
@@ -4530,6 +4560,30 @@ hardware_watchpoint_inserted_in_range (const address_space *aspace,
 
 /* See breakpoint.h.  */
 
+std::vector<std::pair<CORE_ADDR, ULONGEST>>
+hardware_watchpoint_inserted_ranges (const address_space *aspace)
+{
+  std::vector<std::pair<CORE_ADDR, ULONGEST>> ranges;
+
+  for (breakpoint &bpt : all_breakpoints ())
+    {
+      if (bpt.type != bp_hardware_watchpoint
+	  && bpt.type != bp_access_watchpoint)
+	continue;
+
+      if (!breakpoint_enabled (&bpt))
+	continue;
+
+      for (bp_location &loc : bpt.locations ())
+	if (loc.pspace->aspace == aspace && loc.inserted)
+	  ranges.emplace_back (loc.address, loc.length);
+    }
+
+  return ranges;
+}
+
+/* See breakpoint.h.  */
+
 bool
 is_catchpoint (struct breakpoint *b)
 {
@@ -8193,7 +8247,15 @@ install_breakpoint (int internal, std::unique_ptr<breakpoint> &&arg, int update_
   notify_breakpoint_created (b);
 
   if (update_gll)
-    update_global_location_list (UGLL_MAY_INSERT);
+    {
+      if (location_list_update_deferred > 0)
+	{
+	  if (!location_list_update_pending.has_value ())
+	    location_list_update_pending = UGLL_MAY_INSERT;
+	}
+      else if (!add_breakpoint_locations_to_global_list (b))
+	update_global_location_list (UGLL_MAY_INSERT);
+    }
 
   return b;
 }
@@ -11428,6 +11490,91 @@ force_breakpoint_reinsertion (struct bp_location *bl)
     }
 }
 
+/* Rescan the breakpoint locations in [BEGIN, END), a range of
+   bp_locations made of whole runs of locations at the same address,
+   marking the first one at each address and section as "first" and
+   any others as "duplicates".  This is so that the bpt instruction is
+   only inserted once.  If we have a permanent breakpoint at the same
+   place as BPT, make that one the official one, and the rest as
+   duplicates.  Permanent breakpoints are sorted first for the same
+   address.
+
+   Do the same for hardware watchpoints, but also considering the
+   watchpoint's type (regular/access/read) and length.  */
+
+static void
+mark_duplicate_locations (std::vector<bp_location *>::iterator begin,
+			  std::vector<bp_location *>::iterator end)
+{
+  /* When iterating over the locations, points to the first
+     bp_location of a given address.  Breakpoints and watchpoints of
+     different types are never duplicates of each other.  Keep one
+     pointer for each type of breakpoint/watchpoint, so we only need to
+     loop over all locations once.  */
+  struct bp_location *bp_loc_first = NULL;  /* breakpoint */
+  struct bp_location *wp_loc_first = NULL;  /* hardware watchpoint */
+  struct bp_location *awp_loc_first = NULL; /* access watchpoint */
+  struct bp_location *rwp_loc_first = NULL; /* read watchpoint */
+
+  for (; begin != end; ++begin)
+    {
+      bp_location *loc = *begin;
+
+      /* ALL_BP_LOCATIONS bp_location has LOC->OWNER always
+	 non-NULL.  */
+      struct bp_location **loc_first_p;
+      breakpoint *b = loc->owner;
+
+      if (!unduplicated_should_be_inserted (loc)
+	  || !bl_address_is_meaningful (loc)
+	  /* Don't detect duplicate for tracepoint locations because they are
+	   never duplicated.  See the comments in field `duplicate' of
+	   `struct bp_location'.  */
+	  || is_tracepoint (b))
+	{
+	  /* Clear the condition modification flag.  */
+	  loc->condition_changed = condition_unchanged;
+	  continue;
+	}
+
+      if (b->type == bp_hardware_watchpoint)
+	loc_first_p = &wp_loc_first;
+      else if (b->type == bp_read_watchpoint)
+	loc_first_p = &rwp_loc_first;
+      else if (b->type == bp_access_watchpoint)
+	loc_first_p = &awp_loc_first;
+      else
+	loc_first_p = &bp_loc_first;
+
+      if (*loc_first_p == NULL
+	  || (overlay_debugging && loc->section != (*loc_first_p)->section)
+	  || !breakpoint_locations_match (loc, *loc_first_p))
+	{
+	  *loc_first_p = loc;
+	  loc->duplicate = 0;
+
+	  if (is_breakpoint (loc->owner) && loc->condition_changed)
+	    {
+	      loc->needs_update = 1;
+	      /* Clear the condition modification flag.  */
+	      loc->condition_changed = condition_unchanged;
+	    }
+	  continue;
+	}
+
+
+      /* This and the above ensure the invariant that the first location
+	 is not duplicated, and is the inserted one.
+	 All following are marked as duplicated, and are not inserted.  */
+      if (loc->inserted)
+	swap_insertion (loc, *loc_first_p);
+      loc->duplicate = 1;
+
+      /* Clear the condition modification flag.  */
+      loc->condition_changed = condition_unchanged;
+    }
+}
+
 /* Called whether new breakpoints are created, or existing breakpoints
    deleted, to update the global location list and recompute which
    locations are duplicate of which.
@@ -11447,16 +11594,13 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
   breakpoint_debug_printf ("insert_mode = %s",
 			   ugll_insert_mode_text (insert_mode));
 
-  /* Used in the duplicates detection below.  When iterating over all
-     bp_locations, points to the first bp_location of a given address.
-     Breakpoints and watchpoints of different types are never
-     duplicates of each other.  Keep one pointer for each type of
-     breakpoint/watchpoint, so we only need to loop over all locations
-     once.  */
-  struct bp_location *bp_loc_first;  /* breakpoint */
-  struct bp_location *wp_loc_first;  /* hardware watchpoint */
-  struct bp_location *awp_loc_first; /* access watchpoint */
-  struct bp_location *rwp_loc_first; /* read watchpoint */
+  /* The list is rebuilt from scratch below, so this also picks up
+     any breakpoint whose update was deferred.  A deferred update
+     still has to be done if it may insert locations and this one does
+     not.  */
+  if (location_list_update_pending.has_value ()
+      && insert_mode >= *location_list_update_pending)
+    location_list_update_pending.reset ();
 
   /* Saved former bp_locations array which we compare against the newly
      built bp_locations from the current state of ALL_BREAKPOINTS.  */
@@ -11695,76 +11839,7 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
 	}
     }
 
-  /* Rescan breakpoints at the same address and section, marking the
-     first one as "first" and any others as "duplicates".  This is so
-     that the bpt instruction is only inserted once.  If we have a
-     permanent breakpoint at the same place as BPT, make that one the
-     official one, and the rest as duplicates.  Permanent breakpoints
-     are sorted first for the same address.
-
-     Do the same for hardware watchpoints, but also considering the
-     watchpoint's type (regular/access/read) and length.  */
-
-  bp_loc_first = NULL;
-  wp_loc_first = NULL;
-  awp_loc_first = NULL;
-  rwp_loc_first = NULL;
-
-  for (bp_location *loc : all_bp_locations ())
-    {
-      /* ALL_BP_LOCATIONS bp_location has LOC->OWNER always
-	 non-NULL.  */
-      struct bp_location **loc_first_p;
-      breakpoint *b = loc->owner;
-
-      if (!unduplicated_should_be_inserted (loc)
-	  || !bl_address_is_meaningful (loc)
-	  /* Don't detect duplicate for tracepoint locations because they are
-	   never duplicated.  See the comments in field `duplicate' of
-	   `struct bp_location'.  */
-	  || is_tracepoint (b))
-	{
-	  /* Clear the condition modification flag.  */
-	  loc->condition_changed = condition_unchanged;
-	  continue;
-	}
-
-      if (b->type == bp_hardware_watchpoint)
-	loc_first_p = &wp_loc_first;
-      else if (b->type == bp_read_watchpoint)
-	loc_first_p = &rwp_loc_first;
-      else if (b->type == bp_access_watchpoint)
-	loc_first_p = &awp_loc_first;
-      else
-	loc_first_p = &bp_loc_first;
-
-      if (*loc_first_p == NULL
-	  || (overlay_debugging && loc->section != (*loc_first_p)->section)
-	  || !breakpoint_locations_match (loc, *loc_first_p))
-	{
-	  *loc_first_p = loc;
-	  loc->duplicate = 0;
-
-	  if (is_breakpoint (loc->owner) && loc->condition_changed)
-	    {
-	      loc->needs_update = 1;
-	      /* Clear the condition modification flag.  */
-	      loc->condition_changed = condition_unchanged;
-	    }
-	  continue;
-	}
-
-
-      /* This and the above ensure the invariant that the first location
-	 is not duplicated, and is the inserted one.
-	 All following are marked as duplicated, and are not inserted.  */
-      if (loc->inserted)
-	swap_insertion (loc, *loc_first_p);
-      loc->duplicate = 1;
-
-      /* Clear the condition modification flag.  */
-      loc->condition_changed = condition_unchanged;
-    }
+  mark_duplicate_locations (bp_locations.begin (), bp_locations.end ());
 
   if (insert_mode == UGLL_INSERT || breakpoints_should_be_inserted_now ())
     {
@@ -11786,6 +11861,70 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
     download_tracepoint_locations ();
 }
 
+/* Add the locations of B, a breakpoint that was just added to the
+   breakpoint chain, to the global location list, as
+   update_global_location_list (UGLL_MAY_INSERT) would, but without
+   rebuilding the list.  Each location is inserted in the sorted
+   bp_locations by binary search, and duplicates are only recomputed
+   among the locations at its address, so that adding a breakpoint
+   does not cost time proportional to all the others.  Return false,
+   leaving the list alone, if the whole list must be updated instead:
+   for other kinds of breakpoints, with overlays, or if locations are
+   to be inserted in the target now.  */
+
+static bool
+add_breakpoint_locations_to_global_list (breakpoint *b)
+{
+  if (!is_breakpoint (b)
+      || overlay_debugging
+      || breakpoints_should_be_inserted_now ())
+    return false;
+
+  breakpoint_debug_printf ("breakpoint %d", b->number);
+
+  /* Append the new locations, sort them, and merge them into the list
+     in one pass.  Inserting them one by one would move the tail of the
+     list for each.  Both steps are stable, so each new location still
+     goes after the locations that compare equal to it.  */
+  size_t old_size = bp_locations.size ();
+  for (bp_location &loc : b->locations ())
+    {
+      if (!loc.inserted && should_be_inserted (&loc))
+	handle_automatic_hardware_breakpoints (&loc);
+
+      bp_locations.push_back (&loc);
+    }
+
+  auto added = bp_locations.begin () + old_size;
+  std::stable_sort (added, bp_locations.end (), bp_location_is_less_than);
+  std::inplace_merge (bp_locations.begin (), added, bp_locations.end (),
+		      bp_location_is_less_than);
+
+  for (bp_location &loc : b->locations ())
+    {
+      auto range = all_bp_locations_at_addr (loc.address);
+
+      /* Locations at the same address are not totally ordered by
+	 bp_location_is_less_than; sort them the way the whole list
+	 would be.  */
+      std::sort (range.begin (), range.end (), bp_location_is_less_than);
+
+      /* Target-side condition evaluation: a new location at the
+	 address of existing ones.  */
+      if (loc.condition_changed == condition_modified
+	  && std::any_of (range.begin (), range.end (),
+			  [b] (const bp_location *other)
+			  {
+			    return other->owner != b;
+			  }))
+	force_breakpoint_reinsertion (&loc);
+
+      mark_duplicate_locations (range.begin (), range.end ());
+    }
+
+  return true;
+}
+
 void
 breakpoint_retire_moribund (void)
 {
@@ -13266,22 +13405,58 @@ create_sals_from_location_spec_default (location_spec *locspec,
   parse_breakpoint_sals (locspec, canonical);
 }
 
-/* Reset a breakpoint.  */
+/* Return true if breakpoint B may resolve to different locations now
+   that NEW_OBJFILES were added to the current program space.  This is
+   the case if B's location spec matches anything in NEW_OBJFILES: the
+   objfiles that were already loaded have not changed, so they would
+   resolve to the same locations as before.  */
+
+static bool
+breakpoint_re_set_needed_p (breakpoint *b,
+			    const std::vector<objfile *> &new_objfiles)
+{
+  /* Only plain user breakpoints are known to depend on nothing but
+     their location spec.  Other kinds, like dprintfs, ranged or
+     internal breakpoints, do more work in their re_set method.  */
+  if ((b->type != bp_breakpoint && b->type != bp_hardware_breakpoint)
+      || dynamic_cast<ordinary_breakpoint *> (b) == nullptr
+      || b->locspec == nullptr
+      || b->locspec_range_end != nullptr)
+    return true;
+
+  /* A condition that failed to parse may refer to a symbol in one of
+     the new objfiles.  A location in a library that was unloaded is
+     only dropped by a full re-set.  */
+  for (bp_location &loc : b->locations ())
+    if (loc.disabled_by_cond || loc.shlib_disabled)
+      return true;
+
+  return decode_line_in_objfiles_p (b->locspec.get (),
+				    DECODE_LINE_FUNFIRSTLINE,
+				    current_program_space, new_objfiles);
+}
+
+/* Reset a breakpoint.  If NEW_OBJFILES is not NULL, B is only reset
+   if it may be affected by these newly added objfiles.  */
 
 static void
-breakpoint_re_set_one (breakpoint *b)
+breakpoint_re_set_one (breakpoint *b,
+		       const std::vector<objfile *> *new_objfiles)
 {
   input_radix = b->input_radix;
   set_language (b->language);
 
+  if (new_objfiles != nullptr
+      && !breakpoint_re_set_needed_p (b, *new_objfiles))
+    return;
+
   b->re_set ();
 }
 
-/* Re-set breakpoint locations for the current program space.
-   Locations bound to other program spaces are left untouched.  */
+/* Helper for breakpoint_re_set and breakpoint_re_set_new_objfiles.  */
 
-void
-breakpoint_re_set (void)
+static void
+breakpoint_re_set_1 (const std::vector<objfile *> *new_objfiles)
 {
   {
     scoped_restore_current_language save_language;
@@ -13301,6 +13476,13 @@ breakpoint_re_set (void)
     scoped_restore save_language_mode = make_scoped_restore (&language_mode);
     language_mode = language_mode_manual;
 
+    /* Shared libraries whose debug information is read in the
+       background only contribute their minimal symbols for now.  The
+       breakpoints are re-set again once it has been read, see
+       solib_background_read_handler.  */
+    scoped_restore save_defer_reads
+      = make_scoped_restore (&defer_background_symbol_reads, true);
+
     /* Note: we must not try to insert locations until after all
        breakpoints have been re-set.  Otherwise, e.g., when re-setting
        breakpoint 1, we'd insert the locations of breakpoint 2, which
@@ -13310,7 +13492,7 @@ breakpoint_re_set (void)
       {
 	try
 	  {
-	    breakpoint_re_set_one (&b);
+	    breakpoint_re_set_one (&b, new_objfiles);
 	  }
 	catch (const gdb_exception &ex)
 	  {
@@ -13331,6 +13513,23 @@ breakpoint_re_set (void)
   /* Now we can insert.  */
   update_global_location_list (UGLL_MAY_INSERT);
 }
+
+/* Re-set breakpoint locations for the current program space.
+   Locations bound to other program spaces are left untouched.  */
+
+void
+breakpoint_re_set (void)
+{
+  breakpoint_re_set_1 (nullptr);
+}
+
+/* See breakpoint.h.  */
+
+void
+breakpoint_re_set_new_objfiles (const std::vector<objfile *> &objfiles)
+{
+  breakpoint_re_set_1 (&objfiles);
+}
 
 /* Reset the thread number of this breakpoint:
 
@@ -1482,6 +1482,12 @@ extern int hardware_watchpoint_inserted_in_range (const address_space *,
 						  CORE_ADDR addr,
 						  ULONGEST len);
 
+/* Return the address and length of the ranges of memory watched by the
+   hardware watchpoints and access watchpoints inserted in ASPACE, the
+   ones hardware_watchpoint_inserted_in_range checks.  */
+extern std::vector<std::pair<CORE_ADDR, ULONGEST>>
+  hardware_watchpoint_inserted_ranges (const address_space *aspace);
+
 /* Returns true if {ASPACE1,ADDR1} and {ASPACE2,ADDR2} represent the
    same breakpoint location.  In most targets, this can only be true
    if ASPACE1 matches ASPACE2.  On targets that have global
@@ -1504,6 +1510,14 @@ extern void update_breakpoint_locations
 
 extern void breakpoint_re_set (void);
 
+/* Like breakpoint_re_set, but for use after OBJFILES were added to the
+   current program space, and nothing else changed.  Breakpoints whose
+   location specs match nothing in OBJFILES keep their locations,
+   which saves searching all the other objfiles again.  */
+
+extern void breakpoint_re_set_new_objfiles
+  (const std::vector<objfile *> &objfiles);
+
 extern void breakpoint_re_set_thread (struct breakpoint *);
 
 extern void delete_breakpoint (struct breakpoint *);
@@ -41,6 +41,19 @@
 #include <inttypes.h>
 #include <ctype.h>
 #include <algorithm>
+#include <map>
+#include <unordered_map>
+#include "gdbsupport/parallel-for.h"
+
+#if defined (HAVE_LIBIPT)
+#include "gdbsupport/scope-exit.h"
+#include "gdbsupport/function-view.h"
+#endif
+
+#if defined (HAVE_LIBIPT) && CXX_STD_THREAD
+#include "gdbsupport/thread-pool.h"
+#include <atomic>
+#endif
 
 /* Command lists for btrace maintenance commands.  */
 static struct cmd_list_element *maint_btrace_cmdlist;
@@ -52,6 +65,12 @@ static struct cmd_list_element *maint_btrace_pt_show_cmdlist;
 /* Control whether to skip PAD packets when computing the packet history.  */
 static bool maint_btrace_pt_skip_pad = true;
 
+/* Control whether large Intel PT traces are decoded in worker threads.  */
+static bool maint_btrace_pt_parallel_decode = false;
+
+/* See btrace.h.  */
+unsigned int btrace_pt_max_decoded_insns = UINT_MAX;
+
 static void btrace_add_pc (struct thread_info *tp);
 
 /* Print a record debug message.  Use do ... while (0) to avoid ambiguities
@@ -134,7 +153,7 @@ ftrace_debug (const struct btrace_function *bfun, const char *prefix)
   level = bfun->level;
 
   ibegin = bfun->insn_offset;
-  iend = ibegin + bfun->insn.size ();
+  iend = ibegin + bfun->ninsns;
 
   DEBUG_FTRACE ("%s: fun = %s, file = %s, level = %d, insn = [%u; %u)",
 		prefix, fun, file, level, ibegin, iend);
@@ -152,7 +171,7 @@ ftrace_call_num_insn (const struct btrace_function* bfun)
   if (bfun->errcode != 0)
     return 1;
 
-  return bfun->insn.size ();
+  return bfun->ninsns;
 }
 
 /* Return the function segment with the given NUMBER or NULL if no such segment
@@ -397,7 +416,7 @@ ftrace_find_call (struct btrace_thread_info *btinfo,
       if (bfun->errcode != 0)
 	continue;
 
-      btrace_insn &last = bfun->insn.back ();
+      const btrace_insn &last = btrace_function_insns (btinfo, bfun).back ();
 
       if (last.iclass == BTRACE_INSN_CALL)
 	break;
@@ -529,7 +548,7 @@ ftrace_new_gap (struct btrace_thread_info *btinfo, int errcode,
     {
       /* We hijack the previous function segment if it was empty.  */
       bfun = &btinfo->functions.back ();
-      if (bfun->errcode != 0 || !bfun->insn.empty ())
+      if (bfun->errcode != 0 || bfun->ninsns != 0)
 	bfun = ftrace_new_function (btinfo, NULL, NULL);
     }
 
@@ -575,9 +594,10 @@ ftrace_update_function (struct btrace_thread_info *btinfo, CORE_ADDR pc)
   /* Check the last instruction, if we have one.
      We do this check first, since it allows us to fill in the call stack
      links in addition to the normal flow links.  */
-  btrace_insn *last = NULL;
-  if (!bfun->insn.empty ())
-    last = &bfun->insn.back ();
+  const btrace_insn *last = NULL;
+  scoped_btrace_insns_pin pin (btinfo, bfun);
+  if (bfun->ninsns != 0)
+    last = &btrace_function_insns (btinfo, bfun).back ();
 
   if (last != NULL)
     {
@@ -665,6 +685,7 @@ static void
 ftrace_update_insns (struct btrace_function *bfun, const btrace_insn &insn)
 {
   bfun->insn.push_back (insn);
+  bfun->ninsns += 1;
 
   if (record_debug > 1)
     ftrace_debug (bfun, "update insn");
@@ -759,7 +780,7 @@ ftrace_compute_global_level_offset (struct btrace_thread_info *btinfo)
      really part of the trace.  If it contains just this one instruction, we
      ignore the segment.  */
   struct btrace_function *last = &btinfo->functions.back();
-  if (last->insn.size () != 1)
+  if (last->ninsns != 1)
     level = std::min (level, last->level);
 
   DEBUG_FTRACE ("setting global level offset: %d", -level);
@@ -1336,92 +1357,1150 @@ ftrace_add_pt (struct btrace_thread_info *btinfo,
 	  if (status < 0)
 	    break;
 
-	  status = pt_insn_next (decoder, &insn, sizeof(insn));
-	  if (status < 0)
-	    break;
+	  status = pt_insn_next (decoder, &insn, sizeof(insn));
+	  if (status < 0)
+	    break;
+
+	  /* Handle events indicated by flags in INSN.  */
+	  handle_pt_insn_event_flags (btinfo, decoder, insn, gaps);
+
+	  bfun = ftrace_update_function (btinfo, insn.ip);
+
+	  /* Maintain the function level offset.  */
+	  *plevel = std::min (*plevel, bfun->level);
+
+	  ftrace_update_insns (bfun, pt_btrace_insn (insn));
+	}
+
+      if (status == -pte_eos)
+	break;
+
+      /* Indicate the gap in the trace.  */
+      bfun = ftrace_new_gap (btinfo, status, gaps);
+
+      pt_insn_get_offset (decoder, &offset);
+
+      warning (_("Decode error (%d) at instruction %u (offset = 0x%" PRIx64
+		 ", pc = 0x%" PRIx64 "): %s."), status, bfun->insn_offset - 1,
+	       offset, insn.ip, pt_errstr (pt_errcode (status)));
+    }
+}
+
+/* A callback function to allow the trace decoder to read the inferior's
+   memory.  */
+
+static int
+btrace_pt_readmem_callback (gdb_byte *buffer, size_t size,
+			    const struct pt_asid *asid, uint64_t pc,
+			    void *context)
+{
+  int result, errcode;
+
+  result = (int) size;
+  try
+    {
+      /* CONTEXT, if not NULL, is the target to read from.  */
+      if (context != nullptr)
+	{
+	  struct target_ops *ops = (struct target_ops *) context;
+
+	  if (target_read (ops, TARGET_OBJECT_CODE_MEMORY, nullptr, buffer,
+			   (CORE_ADDR) pc, size) != (LONGEST) size)
+	    result = -pte_nomap;
+	}
+      else
+	{
+	  errcode = target_read_code ((CORE_ADDR) pc, buffer, size);
+	  if (errcode != 0)
+	    result = -pte_nomap;
+	}
+    }
+  catch (const gdb_exception_error &error)
+    {
+      result = -pte_nomap;
+    }
+
+  return result;
+}
+
+/* Translate the vendor from one enum to another.  */
+
+static enum pt_cpu_vendor
+pt_translate_cpu_vendor (enum btrace_cpu_vendor vendor)
+{
+  switch (vendor)
+    {
+    default:
+      return pcv_unknown;
+
+    case CV_INTEL:
+      return pcv_intel;
+    }
+}
+
+/* Finalize the function branch trace after decode.  DECODER may be
+   NULL if the trace was decoded in worker threads.  */
+
+static void btrace_finalize_ftrace_pt (struct pt_insn_decoder *decoder,
+				       struct thread_info *tp, int level)
+{
+  if (decoder != nullptr)
+    pt_insn_free_decoder (decoder);
+
+  /* LEVEL is the minimal function level of all btrace function segments.
+     Define the global level offset to -LEVEL so all function levels are
+     normalized to start at zero.  */
+  tp->btrace.level = -level;
+
+  /* Add a single last instruction entry for the current PC.
+     This allows us to compute the backtrace at the current PC using both
+     standard unwind and btrace unwind.
+     This extra entry is ignored by all record commands.  */
+  btrace_add_pc (tp);
+}
+
+/* Configure CONFIG for decoding the Intel PT trace BTRACE.  */
+
+static void
+btrace_pt_config_init (struct pt_config *config,
+		       const struct btrace_data_pt *btrace)
+{
+  int errcode;
+
+  pt_config_init(config);
+  config->begin = btrace->data;
+  config->end = btrace->data + btrace->size;
+
+  /* We treat an unknown vendor as 'no errata'.  */
+  if (btrace->config.cpu.vendor != CV_UNKNOWN)
+    {
+      config->cpu.vendor
+	= pt_translate_cpu_vendor (btrace->config.cpu.vendor);
+      config->cpu.family = btrace->config.cpu.family;
+      config->cpu.model = btrace->config.cpu.model;
+      config->cpu.stepping = btrace->config.cpu.stepping;
+
+      errcode = pt_cpu_errata (&config->errata, &config->cpu);
+      if (errcode < 0)
+	error (_("Failed to configure the Intel Processor Trace "
+		 "decoder: %s."), pt_errstr (pt_errcode (errcode)));
+    }
+}
+
+/* Something the decoder of a segment reported other than an
+   instruction.  */
+
+struct btrace_pt_event
+{
+  /* The number of instructions of the segment before the event.  */
+  size_t insn_index;
+
+  /* BDE_PT_DISABLED or BDE_PT_OVERFLOW, or the libipt error code of a
+     decode error.  */
+  int errcode;
+
+  /* The offset in the trace where the event was found.  */
+  uint64_t offset;
+
+  /* Whether PC is the address of the instruction the event is bound
+     to, or of the instruction that failed to decode.  */
+  bool has_pc;
+  uint64_t pc;
+};
+
+/* A part of an Intel PT trace starting at a PSB packet, and what was
+   decoded from it.  */
+
+struct btrace_pt_segment
+{
+  /* The offsets of the segment in the trace.  END is the offset of the
+     PSB packet the next segment starts with, if there is one.  */
+  uint64_t begin, end;
+
+  /* The decoder reads the trace up to this offset, past END, to find
+     the PSB packet the next segment starts with.  */
+  uint64_t limit;
+
+  /* The decoder for the segment.  */
+  struct pt_insn_decoder *decoder = nullptr;
+
+  /* The decoded instructions and events.  */
+  std::vector<btrace_insn> insns;
+  std::vector<btrace_pt_event> events;
+
+  /* Whether decoding stopped at the PSB packet at END.  INSNS then
+     holds exactly the instructions before it.  */
+  bool at_seam = false;
+
+  /* Whether decoding failed in a way we cannot stitch.  */
+  bool failed = false;
+};
+
+/* Record events from the decoder of SEG in SEG (libipt-v2).  Return
+   the decoder status.  */
+
+static int
+pt_segment_add_events (struct btrace_pt_segment *seg, int status)
+{
+#if defined (HAVE_PT_INSN_EVENT)
+  while (status & pts_event_pending)
+    {
+      struct pt_event event;
+      uint64_t offset, sync;
+
+      status = pt_insn_event (seg->decoder, &event, sizeof (event));
+      if (status < 0)
+	break;
+
+      /* The first event from the PSB packet at the end of SEG marks the
+	 seam: the next segment decodes everything from there on.  An
+	 event past the end that does not come from that PSB packet means
+	 the decoder skipped it, and we cannot tell where SEG ends.  */
+      pt_insn_get_offset (seg->decoder, &offset);
+      if (offset >= seg->end - seg->begin)
+	{
+	  if (event.status_update != 0
+	      || (pt_insn_get_sync_offset (seg->decoder, &sync) >= 0
+		  && sync == seg->end - seg->begin))
+	    seg->at_seam = true;
+	  else
+	    seg->failed = true;
+
+	  return status;
+	}
+
+      switch (event.type)
+	{
+	default:
+	  break;
+
+	case ptev_enabled:
+	  if (event.status_update != 0 || event.variant.enabled.resumed != 0)
+	    break;
+
+	  seg->events.push_back ({seg->insns.size (), BDE_PT_DISABLED,
+				  offset, false, 0});
+	  break;
+
+	case ptev_overflow:
+	  seg->events.push_back ({seg->insns.size (), BDE_PT_OVERFLOW,
+				  offset, false, 0});
+	  break;
+	}
+    }
+#endif /* defined (HAVE_PT_INSN_EVENT) */
+
+  return status;
+}
+
+/* Record events indicated by flags in INSN in SEG (libipt-v1).  */
+
+static void
+pt_segment_add_event_flags (struct btrace_pt_segment *seg,
+			    const struct pt_insn &insn)
+{
+#if defined (HAVE_STRUCT_PT_INSN_ENABLED)
+  if (insn.enabled)
+    {
+      uint64_t offset;
+
+      pt_insn_get_offset (seg->decoder, &offset);
+      seg->events.push_back ({seg->insns.size (), BDE_PT_DISABLED,
+			      offset, true, insn.ip});
+    }
+#endif /* defined (HAVE_STRUCT_PT_INSN_ENABLED) */
+
+#if defined (HAVE_STRUCT_PT_INSN_RESYNCED)
+  if (insn.resynced)
+    {
+      uint64_t offset;
+
+      pt_insn_get_offset (seg->decoder, &offset);
+      seg->events.push_back ({seg->insns.size (), BDE_PT_OVERFLOW,
+			      offset, true, insn.ip});
+    }
+#endif /* defined (HAVE_STRUCT_PT_INSN_RESYNCED) */
+}
+
+/* Decode SEG, like ftrace_add_pt does for the whole trace, but only
+   recording what was decoded.  Stop at the PSB packet at the end of SEG.
+   This may run in a worker thread and must not call into the rest of
+   GDB.  Stop early, marking SEG as failed, if ABORTED returns true.  */
+
+static void
+pt_decode_segment (struct btrace_pt_segment *seg,
+		   gdb::function_view<bool ()> aborted)
+{
+  struct pt_insn insn {};
+  uint64_t offset;
+  int status;
+
+  for (;;)
+    {
+      status = pt_insn_sync_forward (seg->decoder);
+      if (status < 0)
+	{
+	  if (status != -pte_eos)
+	    seg->failed = true;
+	  break;
+	}
+
+      for (;;)
+	{
+	  status = pt_segment_add_events (seg, status);
+	  if (seg->at_seam || seg->failed)
+	    return;
+
+	  if (status < 0)
+	    break;
+
+	  if (aborted ())
+	    {
+	      seg->failed = true;
+	      return;
+	    }
+
+	  status = pt_insn_next (seg->decoder, &insn, sizeof (insn));
+	  if (status < 0)
+	    break;
+
+	  pt_segment_add_event_flags (seg, insn);
+
+	  seg->insns.push_back (pt_btrace_insn (insn));
+	}
+
+      if (status == -pte_eos)
+	break;
+
+      pt_insn_get_offset (seg->decoder, &offset);
+      seg->events.push_back ({seg->insns.size (), status, offset, true,
+			      insn.ip});
+    }
+}
+
+/* Check that NEXT, the segment following PREV, continues where PREV
+   stopped.  Return false if the two segments do not fit together.  */
+
+static bool
+pt_stitch_segments (struct btrace_pt_segment *prev,
+		    struct btrace_pt_segment *next)
+{
+  if (prev->failed || next->failed)
+    return false;
+
+  /* PREV must have stopped right at the PSB packet NEXT starts with,
+     after the instructions executed before it.  If it ran out of trace
+     first, we cannot tell which of its instructions NEXT decodes
+     again.  */
+  if (!prev->at_seam)
+    return false;
+
+  /* Decoding NEXT starts with a status update from its PSB packet that
+     may look like tracing was just enabled.  The trace is contiguous
+     across the seam, so drop it.  Other events right at the seam are
+     too hard to place.  */
+  auto first_event = next->events.begin ();
+  while (first_event != next->events.end ()
+	 && first_event->insn_index == 0
+	 && first_event->errcode == BDE_PT_DISABLED)
+    ++first_event;
+  if (first_event != next->events.end () && first_event->insn_index == 0)
+    return false;
+  next->events.erase (next->events.begin (), first_event);
+
+  return true;
+}
+
+/* Add the instructions and events decoded from SEG to the function
+   trace in BTINFO, like ftrace_add_pt does.  */
+
+static void
+ftrace_add_pt_segment (struct btrace_thread_info *btinfo,
+		       const struct btrace_pt_segment &seg,
+		       int *plevel, std::vector<unsigned int> &gaps)
+{
+  struct btrace_function *bfun;
+  auto event = seg.events.begin ();
+
+  for (size_t i = 0; i <= seg.insns.size (); ++i)
+    {
+      for (; event != seg.events.end () && event->insn_index == i; ++event)
+	switch (event->errcode)
+	  {
+	  case BDE_PT_DISABLED:
+	    if (btinfo->functions.empty ())
+	      break;
+
+	    bfun = ftrace_new_gap (btinfo, BDE_PT_DISABLED, gaps);
+	    if (event->has_pc)
+	      warning (_("Non-contiguous trace at instruction %u (offset = 0x%"
+			 PRIx64 ", pc = 0x%" PRIx64 ")."),
+		       bfun->insn_offset - 1, event->offset, event->pc);
+	    else
+	      warning (_("Non-contiguous trace at instruction %u (offset = 0x%"
+			 PRIx64 ")."), bfun->insn_offset - 1, event->offset);
+	    break;
+
+	  case BDE_PT_OVERFLOW:
+	    bfun = ftrace_new_gap (btinfo, BDE_PT_OVERFLOW, gaps);
+	    if (event->has_pc)
+	      warning (_("Overflow at instruction %u (offset = 0x%" PRIx64
+			 ", pc = 0x%" PRIx64 ")."), bfun->insn_offset - 1,
+		       event->offset, event->pc);
+	    else
+	      warning (_("Overflow at instruction %u (offset = 0x%" PRIx64
+			 ")."), bfun->insn_offset - 1, event->offset);
+	    break;
+
+	  default:
+	    bfun = ftrace_new_gap (btinfo, event->errcode, gaps);
+	    warning (_("Decode error (%d) at instruction %u (offset = 0x%"
+		       PRIx64 ", pc = 0x%" PRIx64 "): %s."), event->errcode,
+		     bfun->insn_offset - 1, event->offset, event->pc,
+		     pt_errstr (pt_errcode (event->errcode)));
+	    break;
+	  }
+
+      if (i == seg.insns.size ())
+	break;
+
+      bfun = ftrace_update_function (btinfo, seg.insns[i].pc);
+
+      /* Maintain the function level offset.  */
+      *plevel = std::min (*plevel, bfun->level);
+
+      ftrace_update_insns (bfun, seg.insns[i]);
+    }
+}
+
+/* Split the trace configured in CONFIG at PSB packets into segments of
+   at least SEGMENT_SIZE bytes.  */
+
+static std::vector<btrace_pt_segment>
+pt_split_trace (const struct pt_config &config, uint64_t segment_size)
+{
+  std::vector<btrace_pt_segment> segments;
+  uint64_t size = config.end - config.begin;
+
+  struct pt_packet_decoder *decoder = pt_pkt_alloc_decoder (&config);
+  if (decoder == nullptr)
+    return segments;
+
+  SCOPE_EXIT { pt_pkt_free_decoder (decoder); };
+
+  uint64_t begin = 0;
+  bool have_begin = false;
+  while (pt_pkt_sync_forward (decoder) >= 0)
+    {
+      uint64_t offset;
+
+      if (pt_pkt_get_sync_offset (decoder, &offset) < 0)
+	break;
+
+      if (!have_begin)
+	{
+	  begin = offset;
+	  have_begin = true;
+	}
+      else if (offset - begin >= segment_size)
+	{
+	  if (!segments.empty ())
+	    segments.back ().limit = offset;
+
+	  segments.emplace_back ();
+	  segments.back ().begin = begin;
+	  segments.back ().end = offset;
+	  begin = offset;
+	}
+    }
+
+  if (have_begin)
+    {
+      if (!segments.empty ())
+	segments.back ().limit = size;
+
+      segments.emplace_back ();
+      segments.back ().begin = begin;
+      segments.back ().end = size;
+      segments.back ().limit = size;
+    }
+
+  return segments;
+}
+
+#if CXX_STD_THREAD
+
+/* Traces smaller than this many bytes are decoded on the main thread.
+   Larger ones are split at PSB packets into segments of at least this
+   size, which are decoded in worker threads.  */
+
+#define BTRACE_PT_MIN_SEGMENT_SIZE (1024 * 1024)
+
+/* The granularity at which worker threads read code.  */
+
+#define BTRACE_PT_CODE_PAGE_SIZE 4096
+
+/* The inferior's code, as read by the decoders running in worker
+   threads.  Target memory may only be accessed from the main thread,
+   so the decoders post requests for the pages they miss, which the
+   main thread serves in btrace_pt_code_cache::serve.  */
+
+class btrace_pt_code_cache
+{
+public:
+  explicit btrace_pt_code_cache (size_t workers)
+    : m_workers (workers)
+  {
+  }
+
+  DISABLE_COPY_AND_ASSIGN (btrace_pt_code_cache);
+
+  /* Read SIZE bytes of code at PC into BUFFER, as a libipt read memory
+     callback.  Called from worker threads.  */
+  int read (gdb_byte *buffer, size_t size, uint64_t pc);
+
+  /* Read the pages the workers ask for until all of them are done.
+     Called from the main thread.  May throw a quit exception.  */
+  void serve ();
+
+  /* Called by each worker when it is done.  */
+  void worker_done ();
+
+  /* Make the workers stop early.  */
+  void abort ()
+  {
+    std::lock_guard<std::mutex> guard (m_lock);
+    m_aborted = true;
+    m_cond.notify_all ();
+  }
+
+  /* Return true if the workers should stop.  */
+  bool aborted () const
+  {
+    return m_aborted;
+  }
+
+private:
+
+  /* Return the page at PAGE_ADDR, waiting for the main thread to read
+     it if necessary.  Return NULL if the page cannot be read.  */
+  const gdb::byte_vector *get_page (uint64_t page_addr);
+
+  std::mutex m_lock;
+  std::condition_variable m_cond;
+
+  /* The pages read so far, by address.  Unreadable pages are empty.  */
+  std::unordered_map<uint64_t, gdb::byte_vector> m_pages;
+
+  /* The pages requested by the workers but not read yet.  */
+  std::vector<uint64_t> m_requests;
+
+  size_t m_workers;
+  size_t m_done = 0;
+  std::atomic<bool> m_aborted { false };
+};
+
+const gdb::byte_vector *
+btrace_pt_code_cache::get_page (uint64_t page_addr)
+{
+  std::unique_lock<std::mutex> guard (m_lock);
+
+  for (;;)
+    {
+      if (m_aborted)
+	return nullptr;
+
+      auto iter = m_pages.find (page_addr);
+      if (iter != m_pages.end ())
+	{
+	  /* Elements of an unordered_map do not move when others are
+	     added, and pages are never removed while workers run.  */
+	  if (iter->second.empty ())
+	    return nullptr;
+	  return &iter->second;
+	}
+
+      if (std::find (m_requests.begin (), m_requests.end (), page_addr)
+	  == m_requests.end ())
+	{
+	  m_requests.push_back (page_addr);
+	  m_cond.notify_all ();
+	}
+
+      m_cond.wait (guard);
+    }
+}
+
+int
+btrace_pt_code_cache::read (gdb_byte *buffer, size_t size, uint64_t pc)
+{
+  size_t done = 0;
+
+  while (done < size)
+    {
+      uint64_t addr = pc + done;
+      uint64_t page_addr = addr & ~(uint64_t) (BTRACE_PT_CODE_PAGE_SIZE - 1);
+      const gdb::byte_vector *page = get_page (page_addr);
+
+      if (page == nullptr)
+	break;
+
+      size_t offset = addr - page_addr;
+      size_t len = std::min (size - done,
+			     (size_t) BTRACE_PT_CODE_PAGE_SIZE - offset);
+      memcpy (buffer + done, page->data () + offset, len);
+      done += len;
+    }
+
+  if (done == 0)
+    return -pte_nomap;
+
+  return (int) done;
+}
+
+void
+btrace_pt_code_cache::serve ()
+{
+  std::unique_lock<std::mutex> guard (m_lock);
+
+  while (m_done < m_workers)
+    {
+      if (m_requests.empty ())
+	{
+	  /* Wake up now and then to let the user interrupt us.  */
+	  m_cond.wait_for (guard, std::chrono::milliseconds (100));
+
+	  guard.unlock ();
+	  QUIT;
+	  guard.lock ();
+	  continue;
+	}
+
+      std::vector<uint64_t> requests = std::move (m_requests);
+      m_requests.clear ();
+      guard.unlock ();
+
+      std::vector<gdb::byte_vector> pages (requests.size ());
+      for (size_t i = 0; i < requests.size (); ++i)
+	{
+	  pages[i].resize (BTRACE_PT_CODE_PAGE_SIZE);
+	  try
+	    {
+	      if (target_read_code ((CORE_ADDR) requests[i], pages[i].data (),
+				    BTRACE_PT_CODE_PAGE_SIZE) != 0)
+		pages[i].clear ();
+	    }
+	  catch (const gdb_exception_error &error)
+	    {
+	      pages[i].clear ();
+	    }
+	}
+
+      QUIT;
+
+      guard.lock ();
+      for (size_t i = 0; i < requests.size (); ++i)
+	m_pages.emplace (requests[i], std::move (pages[i]));
+      m_cond.notify_all ();
+    }
+}
+
+void
+btrace_pt_code_cache::worker_done ()
+{
+  std::lock_guard<std::mutex> guard (m_lock);
+  m_done += 1;
+  m_cond.notify_all ();
+}
+
+/* The read memory callback of the decoders running in worker
+   threads.  CONTEXT is the btrace_pt_code_cache.  */
+
+static int
+btrace_pt_parallel_readmem_callback (gdb_byte *buffer, size_t size,
+				     const struct pt_asid *asid, uint64_t pc,
+				     void *context)
+{
+  btrace_pt_code_cache *cache = (btrace_pt_code_cache *) context;
+
+  return cache->read (buffer, size, pc);
+}
+
+/* Try to decode the trace configured in CONFIG in worker threads and
+   add it to BTINFO.  Return false, having changed nothing, if the
+   trace is not worth splitting or cannot be split.  */
+
+static bool
+btrace_compute_ftrace_pt_parallel (struct btrace_thread_info *btinfo,
+				   const struct pt_config &config,
+				   int *plevel, std::vector<unsigned int> &gaps)
+{
+  size_t workers = gdb::thread_pool::g_thread_pool->thread_count ();
+  uint64_t size = config.end - config.begin;
+
+  if (!maint_btrace_pt_parallel_decode || workers == 0
+      || size < 2 * BTRACE_PT_MIN_SEGMENT_SIZE)
+    return false;
+
+#if !defined (HAVE_PT_INSN_EVENT)
+  /* Without events, we cannot find the seams between segments.  */
+  return false;
+#endif
+
+  uint64_t segment_size
+    = std::max ((uint64_t) BTRACE_PT_MIN_SEGMENT_SIZE,
+		size / (workers * 4));
+  std::vector<btrace_pt_segment> segments
+    = pt_split_trace (config, segment_size);
+  if (segments.size () < 2)
+    return false;
+
+  SCOPE_EXIT
+    {
+      for (btrace_pt_segment &seg : segments)
+	if (seg.decoder != nullptr)
+	  pt_insn_free_decoder (seg.decoder);
+    };
+
+  btrace_pt_code_cache cache (segments.size ());
+  for (btrace_pt_segment &seg : segments)
+    {
+      struct pt_config seg_config = config;
+
+      seg_config.begin = config.begin + seg.begin;
+      seg_config.end = config.begin + seg.limit;
+
+      seg.decoder = pt_insn_alloc_decoder (&seg_config);
+      if (seg.decoder == nullptr)
+	return false;
+
+      struct pt_image *image = pt_insn_get_image (seg.decoder);
+      if (image == nullptr
+	  || pt_image_set_callback (image,
+				    btrace_pt_parallel_readmem_callback,
+				    &cache) < 0)
+	return false;
+    }
+
+  DEBUG ("decode %zu trace segments in parallel", segments.size ());
+
+  std::vector<gdb::future<void>> results;
+  for (btrace_pt_segment &seg : segments)
+    results.push_back (gdb::thread_pool::g_thread_pool->post_task
+		       ([&seg, &cache] ()
+			 {
+			   SCOPE_EXIT { cache.worker_done (); };
+			   pt_decode_segment (&seg, [&cache] ()
+					      {
+						return cache.aborted ();
+					      });
+			 }));
+
+  try
+    {
+      cache.serve ();
+    }
+  catch (const gdb_exception &error)
+    {
+      cache.abort ();
+      for (gdb::future<void> &result : results)
+	result.wait ();
+
+      throw;
+    }
+
+  for (gdb::future<void> &result : results)
+    result.get ();
+
+  for (size_t i = 0; i + 1 < segments.size (); ++i)
+    if (!pt_stitch_segments (&segments[i], &segments[i + 1]))
+      {
+	DEBUG ("cannot stitch trace segments at offset 0x%" PRIx64
+	       ", decoding sequentially", segments[i + 1].begin);
+	return false;
+      }
+
+  for (const btrace_pt_segment &seg : segments)
+    {
+      ftrace_add_pt_segment (btinfo, seg, plevel, gaps);
+      QUIT;
+    }
+
+  return true;
+}
+
+#endif /* CXX_STD_THREAD */
+
+/* Windows of Intel PT traces are split at PSB packets and are at least
+   this many bytes.  */
+
+#define BTRACE_PT_WINDOW_SIZE (64 * 1024)
+
+/* Ticks whenever a window is used, to find the least recently used
+   one.  */
+
+static unsigned long long btrace_window_clock;
+
+/* Decode SEG, a part of the trace configured in CONFIG, on the main
+   thread.  Read the code from OPS, or from the current target if OPS
+   is NULL.  */
+
+static void
+pt_decode_segment_inline (const struct pt_config &config,
+			  struct btrace_pt_segment *seg,
+			  struct target_ops *ops = nullptr)
+{
+  struct pt_config seg_config = config;
+  struct pt_image *image;
+  int errcode;
+
+  seg_config.begin = config.begin + seg->begin;
+  seg_config.end = config.begin + seg->limit;
+
+  seg->decoder = pt_insn_alloc_decoder (&seg_config);
+  if (seg->decoder == nullptr)
+    error (_("Failed to allocate the Intel Processor Trace decoder."));
+
+  SCOPE_EXIT
+    {
+      pt_insn_free_decoder (seg->decoder);
+      seg->decoder = nullptr;
+    };
+
+  image = pt_insn_get_image (seg->decoder);
+  if (image == nullptr)
+    error (_("Failed to configure the Intel Processor Trace decoder."));
+
+  errcode = pt_image_set_callback (image, btrace_pt_readmem_callback, ops);
+  if (errcode < 0)
+    error (_("Failed to configure the Intel Processor Trace decoder: "
+	     "%s."), pt_errstr (pt_errcode (errcode)));
+
+  pt_decode_segment (seg, [] () { return false; });
+}
+
+/* Drop the instructions of function segments owned by windows in
+   BTINFO, least recently used first, until no more than
+   btrace_pt_max_decoded_insns instructions remain.  The most recently
+   used window and windows pinned by scoped_btrace_insns_pin are
+   kept.  */
+
+static void
+btrace_evict_windows (struct btrace_thread_info *btinfo)
+{
+  if (btinfo->windows.empty ())
+    return;
+
+  /* The instructions of function segments that may still grow are
+     needed to build the trace.  They are owned by the last window or
+     continue into it.  */
+  unsigned int last_begin = btinfo->windows.back ().own_begin;
+
+  while (btinfo->window_insns > btrace_pt_max_decoded_insns)
+    {
+      struct btrace_window *lru = nullptr;
+
+      for (btrace_window &window : btinfo->windows)
+	{
+	  if (!window.present || window.own_begin == window.own_end
+	      || window.own_end >= last_begin || window.pins != 0
+	      || window.last_use == btrace_window_clock)
+	    continue;
+
+	  if (lru == nullptr || window.last_use < lru->last_use)
+	    lru = &window;
+	}
+
+      if (lru == nullptr)
+	break;
+
+      DEBUG_FTRACE ("drop insns of function segments [%u; %u)",
+		    lru->own_begin, lru->own_end);
+
+      for (unsigned int number = lru->own_begin; number < lru->own_end;
+	   ++number)
+	{
+	  std::vector<btrace_insn> &insn = btinfo->functions[number - 1].insn;
+
+	  btinfo->window_insns -= std::min (btinfo->window_insns,
+					    (unsigned long long) insn.size ());
+	  std::vector<btrace_insn> ().swap (insn);
+	}
+
+      lru->present = false;
+    }
+}
+
+/* Return the thread whose branch trace is BTINFO.  */
+
+static struct thread_info *
+btrace_find_thread (const struct btrace_thread_info *btinfo)
+{
+  for (thread_info *tp : all_non_exited_threads ())
+    if (&tp->btrace == btinfo)
+      return tp;
+
+  error (_("No thread for the branch trace."));
+}
+
+/* Decode the window WINDOW of the Intel PT trace in BTINFO again and
+   restore the instructions of the function segments it owns.  */
+
+static void
+btrace_materialize_window (struct btrace_thread_info *btinfo,
+			   struct btrace_window *window)
+{
+  struct btrace_data_pt btrace;
+  struct pt_config config;
+  unsigned long long expected = 0, placed = 0;
+
+  gdb_assert (!window->present);
+  gdb_assert (window->own_end <= btinfo->functions.size ());
+
+  DEBUG_FTRACE ("decode insns of function segments [%u; %u) again",
+		window->own_begin, window->own_end);
+
+  /* We may read memory through btrace_pt_readmem_callback.  */
+  scoped_restore_current_thread restore_thread;
+  switch_to_thread (btrace_find_thread (btinfo));
+
+  /* We are likely replaying, where the record target only lets us read
+     read-only memory.  Read the code from the target beneath it, like
+     when the trace was first decoded.  */
+  struct target_ops *ops = find_record_target ();
+  if (ops != nullptr)
+    ops = ops->beneath ();
+
+  gdb_assert (btinfo->data.format == BTRACE_FORMAT_PT);
+  btrace = btinfo->data.variant.pt;
+  btrace.config.cpu = btinfo->window_cpu;
+  btrace_pt_config_init (&config, &btrace);
+
+  for (unsigned int number = window->own_begin; number < window->own_end;
+       ++number)
+    {
+      btrace_function &bfun = btinfo->functions[number - 1];
+
+      if (bfun.errcode == 0)
+	{
+	  bfun.insn.resize (bfun.ninsns);
+	  expected += bfun.ninsns;
+	}
+    }
+
+  /* The function segment the window's last instruction belongs to may
+     continue in the next windows.  */
+  const btrace_function &last = btinfo->functions[window->own_end - 2];
+  const btrace_window *end = btinfo->windows.data ()
+			     + btinfo->windows.size ();
+  unsigned int call = 0;
+
+  try
+    {
+      for (const btrace_window *next = window;
+	   next < end && call < window->own_end; ++next)
+	{
+	  if (next != window
+	      && (next->own_begin != window->own_end
+		  || last.errcode != 0 || next->index >= last.ninsns))
+	    break;
+
+	  struct btrace_pt_segment seg;
+
+	  seg.begin = next->begin;
+	  seg.end = next->end;
+	  seg.limit = next->limit;
+	  pt_decode_segment_inline (config, &seg, ops);
+
+	  if (seg.insns.size () < next->ninsns)
+	    error (_("Failed to decode the trace at offset 0x%" PRIx64
+		     " again."), next->begin);
+
+	  /* Place the instructions the way ftrace_add_pt_segment did,
+	     skipping gaps.  */
+	  call = next->call;
+	  unsigned int index = next->index;
+	  for (unsigned int i = 0; i < next->ninsns; ++i, ++index)
+	    {
+	      while (call == 0
+		     || btinfo->functions[call - 1].errcode != 0
+		     || index >= btinfo->functions[call - 1].ninsns)
+		{
+		  ++call;
+		  index = 0;
+
+		  if (call > btinfo->functions.size ())
+		    error (_("Failed to decode the trace at offset 0x%"
+			     PRIx64 " again."), next->begin);
+		}
+
+	      if (call >= window->own_end)
+		break;
+
+	      if (call >= window->own_begin)
+		{
+		  btinfo->functions[call - 1].insn[index] = seg.insns[i];
+		  ++placed;
+		}
+	    }
+	}
+
+      if (placed != expected)
+	error (_("Failed to decode the trace at offset 0x%" PRIx64
+		 " again."), window->begin);
+    }
+  catch (const gdb_exception &error)
+    {
+      for (unsigned int number = window->own_begin;
+	   number < window->own_end; ++number)
+	std::vector<btrace_insn> ().swap (btinfo->functions[number - 1].insn);
+
+      throw;
+    }
 
-	  /* Handle events indicated by flags in INSN.  */
-	  handle_pt_insn_event_flags (btinfo, decoder, insn, gaps);
+  window->present = true;
+  window->last_use = ++btrace_window_clock;
+  btinfo->window_insns += expected;
 
-	  bfun = ftrace_update_function (btinfo, insn.ip);
+  btrace_evict_windows (btinfo);
+}
 
-	  /* Maintain the function level offset.  */
-	  *plevel = std::min (*plevel, bfun->level);
+/* Return the window in BTINFO that owns the function segment with the
+   given NUMBER, or NULL if the function segment is not owned by a
+   window.  */
 
-	  ftrace_update_insns (bfun, pt_btrace_insn (insn));
-	}
+static struct btrace_window *
+btrace_find_window (const struct btrace_thread_info *btinfo,
+		    unsigned int number)
+{
+  auto it = std::upper_bound (btinfo->windows.begin (),
+			      btinfo->windows.end (), number,
+			      [] (unsigned int value,
+				  const btrace_window &window)
+			      {
+				return value < window.own_begin;
+			      });
+
+  if (it == btinfo->windows.begin ())
+    return nullptr;
+
+  --it;
+  if (number >= it->own_end)
+    return nullptr;
+
+  return const_cast<btrace_window *> (&*it);
+}
 
-      if (status == -pte_eos)
-	break;
+/* Compute the function branch trace from the Intel PT trace BTRACE,
+   configured in CONFIG, one window at a time and drop the instructions
+   of older windows as we go to stay within
+   btrace_pt_max_decoded_insns.  Return false, having changed nothing,
+   if the number of decoded instructions is not limited or BTRACE is
+   not the trace recorded for TP.  */
 
-      /* Indicate the gap in the trace.  */
-      bfun = ftrace_new_gap (btinfo, status, gaps);
+static bool
+btrace_compute_ftrace_pt_windows (struct thread_info *tp,
+				  const struct btrace_data_pt *btrace,
+				  const struct pt_config &config,
+				  int *plevel, std::vector<unsigned int> &gaps)
+{
+  struct btrace_thread_info *btinfo = &tp->btrace;
 
-      pt_insn_get_offset (decoder, &offset);
+  /* We decode windows again from the stored trace, so BTRACE must be
+     all of it.  */
+  if (btrace_pt_max_decoded_insns == UINT_MAX
+      || !btinfo->functions.empty ()
+      || btinfo->data.format != BTRACE_FORMAT_PT
+      || btinfo->data.variant.pt.size != btrace->size
+      || btrace->size < 2 * BTRACE_PT_WINDOW_SIZE)
+    return false;
 
-      warning (_("Decode error (%d) at instruction %u (offset = 0x%" PRIx64
-		 ", pc = 0x%" PRIx64 "): %s."), status, bfun->insn_offset - 1,
-	       offset, insn.ip, pt_errstr (pt_errcode (status)));
-    }
-}
+#if !defined (HAVE_PT_INSN_EVENT)
+  /* Without events, we cannot find the seams between windows.  */
+  return false;
+#endif
 
-/* A callback function to allow the trace decoder to read the inferior's
-   memory.  */
+  std::vector<btrace_pt_segment> bounds
+    = pt_split_trace (config, BTRACE_PT_WINDOW_SIZE);
+  if (bounds.size () < 2)
+    return false;
 
-static int
-btrace_pt_readmem_callback (gdb_byte *buffer, size_t size,
-			    const struct pt_asid *asid, uint64_t pc,
-			    void *context)
-{
-  int result, errcode;
+  DEBUG ("decode trace in %zu windows", bounds.size ());
 
-  result = (int) size;
-  try
-    {
-      errcode = target_read_code ((CORE_ADDR) pc, buffer, size);
-      if (errcode != 0)
-	result = -pte_nomap;
-    }
-  catch (const gdb_exception_error &error)
+  btinfo->window_cpu = btrace->config.cpu;
+
+  btrace_pt_segment seg;
+  seg.begin = bounds[0].begin;
+  seg.end = bounds[0].end;
+  seg.limit = bounds[0].limit;
+  pt_decode_segment_inline (config, &seg);
+
+  size_t next = 1;
+  for (;;)
     {
-      result = -pte_nomap;
-    }
+      btrace_pt_segment following;
+      bool have_following = false;
 
-  return result;
-}
+      /* If SEG and the following part of the trace do not fit together,
+	 decode them as one window, as the sequential decode would.  */
+      while (!have_following && next < bounds.size ())
+	{
+	  following.begin = bounds[next].begin;
+	  following.end = bounds[next].end;
+	  following.limit = bounds[next].limit;
+	  ++next;
 
-/* Translate the vendor from one enum to another.  */
+	  pt_decode_segment_inline (config, &following);
+	  if (pt_stitch_segments (&seg, &following))
+	    {
+	      have_following = true;
+	      break;
+	    }
 
-static enum pt_cpu_vendor
-pt_translate_cpu_vendor (enum btrace_cpu_vendor vendor)
-{
-  switch (vendor)
-    {
-    default:
-      return pcv_unknown;
+	  DEBUG ("cannot stitch trace windows at offset 0x%" PRIx64,
+		 following.begin);
 
-    case CV_INTEL:
-      return pcv_intel;
-    }
-}
+	  uint64_t begin = seg.begin;
+	  seg = btrace_pt_segment ();
+	  seg.begin = begin;
+	  seg.end = following.end;
+	  seg.limit = following.limit;
+	  following = btrace_pt_segment ();
 
-/* Finalize the function branch trace after decode.  */
+	  pt_decode_segment_inline (config, &seg);
+	}
 
-static void btrace_finalize_ftrace_pt (struct pt_insn_decoder *decoder,
-				       struct thread_info *tp, int level)
-{
-  pt_insn_free_decoder (decoder);
+      btrace_window window;
+      window.begin = seg.begin;
+      window.end = seg.end;
+      window.limit = seg.limit;
+      window.ninsns = seg.insns.size ();
+      window.call = btinfo->functions.size ();
+      window.index = (window.call == 0 ? 0
+		      : btinfo->functions.back ().ninsns);
+      window.own_begin = window.call + 1;
+      window.own_end = UINT_MAX;
+      window.present = true;
 
-  /* LEVEL is the minimal function level of all btrace function segments.
-     Define the global level offset to -LEVEL so all function levels are
-     normalized to start at zero.  */
-  tp->btrace.level = -level;
+      ftrace_add_pt_segment (btinfo, seg, plevel, gaps);
 
-  /* Add a single last instruction entry for the current PC.
-     This allows us to compute the backtrace at the current PC using both
-     standard unwind and btrace unwind.
-     This extra entry is ignored by all record commands.  */
-  btrace_add_pc (tp);
+      if (!btinfo->windows.empty ())
+	btinfo->windows.back ().own_end = window.own_begin;
+
+      window.last_use = ++btrace_window_clock;
+      btinfo->windows.push_back (window);
+      btinfo->window_insns += window.ninsns;
+
+      btrace_evict_windows (btinfo);
+
+      if (!have_following)
+	break;
+
+      seg = std::move (following);
+      QUIT;
+    }
+
+  return true;
 }
 
 /* Compute the function branch trace from Intel Processor Trace
@@ -1452,23 +2531,33 @@ btrace_compute_ftrace_pt (struct thread_info *tp,
   else
     level = -btinfo->level;
 
-  pt_config_init(&config);
-  config.begin = btrace->data;
-  config.end = btrace->data + btrace->size;
+  btrace_pt_config_init (&config, btrace);
 
-  /* We treat an unknown vendor as 'no errata'.  */
-  if (btrace->config.cpu.vendor != CV_UNKNOWN)
+  try
     {
-      config.cpu.vendor
-	= pt_translate_cpu_vendor (btrace->config.cpu.vendor);
-      config.cpu.family = btrace->config.cpu.family;
-      config.cpu.model = btrace->config.cpu.model;
-      config.cpu.stepping = btrace->config.cpu.stepping;
+      bool done
+	= btrace_compute_ftrace_pt_windows (tp, btrace, config, &level, gaps);
+#if CXX_STD_THREAD
+      if (!done)
+	done = btrace_compute_ftrace_pt_parallel (btinfo, config, &level,
+						  gaps);
+#endif /* CXX_STD_THREAD */
+
+      if (done)
+	{
+	  btrace_finalize_ftrace_pt (nullptr, tp, level);
+	  return;
+	}
+    }
+  catch (const gdb_exception &error)
+    {
+      /* Indicate a gap in the trace if we quit trace processing.  */
+      if (error.reason == RETURN_QUIT && !btinfo->functions.empty ())
+	ftrace_new_gap (btinfo, BDE_PT_USER_QUIT, gaps);
 
-      errcode = pt_cpu_errata (&config.errata, &config.cpu);
-      if (errcode < 0)
-	error (_("Failed to configure the Intel Processor Trace "
-		 "decoder: %s."), pt_errstr (pt_errcode (errcode)));
+      btrace_finalize_ftrace_pt (nullptr, tp, level);
+
+      throw;
     }
 
   decoder = pt_insn_alloc_decoder (&config);
@@ -1649,11 +2738,45 @@ btrace_enable (struct thread_info *tp, const struct btrace_config *conf)
 
 /* See btrace.h.  */
 
+void
+btrace_restore (struct thread_info *tp, const struct btrace_config *conf,
+		struct btrace_data *data, const struct btrace_cpu *cpu)
+{
+  struct btrace_thread_info *btinfo = &tp->btrace;
+
+  if (btinfo->target != NULL)
+    error (_("Recording already enabled on thread %s (%s)."),
+	   print_thread_id (tp), target_pid_to_str (tp->ptid).c_str ());
+
+#if !defined (HAVE_LIBIPT)
+  if (conf->format == BTRACE_FORMAT_PT)
+    error (_("Intel Processor Trace support was disabled at compile time."));
+#endif /* !defined (HAVE_LIBIPT) */
+
+  DEBUG ("restore thread %s (%s)", print_thread_id (tp),
+	 tp->ptid.to_string ().c_str ());
+
+  btrace_clear (tp);
+  btinfo->restored = *conf;
+
+  if (data->empty ())
+    return;
+
+  /* We compute the trace for TP, which need not be the current thread.  */
+  scoped_restore_current_thread restore_thread;
+  switch_to_thread (tp);
+
+  btrace_data_append (&btinfo->data, data);
+  btrace_compute_ftrace (tp, data, cpu);
+}
+
+/* See btrace.h.  */
+
 const struct btrace_config *
 btrace_conf (const struct btrace_thread_info *btinfo)
 {
   if (btinfo->target == NULL)
-    return NULL;
+    return btinfo->restored.has_value () ? &*btinfo->restored : NULL;
 
   return target_btrace_conf (btinfo->target);
 }
@@ -1665,15 +2788,17 @@ btrace_disable (struct thread_info *tp)
 {
   struct btrace_thread_info *btp = &tp->btrace;
 
-  if (btp->target == NULL)
+  if (btp->target == NULL && !btp->restored.has_value ())
     error (_("Recording not enabled on thread %s (%s)."),
 	   print_thread_id (tp), target_pid_to_str (tp->ptid).c_str ());
 
   DEBUG ("disable thread %s (%s)", print_thread_id (tp),
 	 tp->ptid.to_string ().c_str ());
 
-  target_disable_btrace (btp->target);
+  if (btp->target != NULL)
+    target_disable_btrace (btp->target);
   btp->target = NULL;
+  btp->restored.reset ();
 
   btrace_clear (tp);
 }
@@ -1685,14 +2810,16 @@ btrace_teardown (struct thread_info *tp)
 {
   struct btrace_thread_info *btp = &tp->btrace;
 
-  if (btp->target == NULL)
+  if (btp->target == NULL && !btp->restored.has_value ())
     return;
 
   DEBUG ("teardown thread %s (%s)", print_thread_id (tp),
 	 tp->ptid.to_string ().c_str ());
 
-  target_teardown_btrace (btp->target);
+  if (btp->target != NULL)
+    target_teardown_btrace (btp->target);
   btp->target = NULL;
+  btp->restored.reset ();
 
   btrace_clear (tp);
 }
@@ -1715,7 +2842,7 @@ btrace_stitch_bts (struct btrace_data_bts *btrace, struct thread_info *tp)
   /* If the existing trace ends with a gap, we just glue the traces
      together.  We need to drop the last (i.e. chronologically first) block
      of the new trace,  though, since we can't fill in the start address.*/
-  if (last_bfun->insn.empty ())
+  if (last_bfun->ninsns == 0)
     {
       btrace->blocks->pop_back ();
       return 0;
@@ -1765,6 +2892,7 @@ btrace_stitch_bts (struct btrace_data_bts *btrace, struct thread_info *tp)
 	 ftrace_print_insn_addr (&last_insn));
 
   last_bfun->insn.pop_back ();
+  last_bfun->ninsns -= 1;
 
   /* The instructions vector may become empty temporarily if this has
      been the only instruction in this function segment.
@@ -1775,7 +2903,7 @@ btrace_stitch_bts (struct btrace_data_bts *btrace, struct thread_info *tp)
      of just that one instruction.  If we remove it, we might turn the now
      empty btrace function segment into a gap.  But we don't want gaps at
      the beginning.  To avoid this, we remove the entire old trace.  */
-  if (last_bfun->number == 1 && last_bfun->insn.empty ())
+  if (last_bfun->number == 1 && last_bfun->ninsns == 0)
     btrace_clear (tp);
 
   return 0;
@@ -1998,6 +3126,8 @@ btrace_clear (struct thread_info *tp)
 
   btinfo->functions.clear ();
   btinfo->ngaps = 0;
+  btinfo->windows.clear ();
+  btinfo->window_insns = 0;
 
   /* Must clear the maint data before - it depends on BTINFO->DATA.  */
   btrace_maint_clear (btinfo);
@@ -2007,6 +3137,63 @@ btrace_clear (struct thread_info *tp)
 
 /* See btrace.h.  */
 
+const std::vector<btrace_insn> &
+btrace_function_insns (const struct btrace_thread_info *btinfo,
+		       const struct btrace_function *bfun)
+{
+#if defined (HAVE_LIBIPT)
+  if (!btinfo->windows.empty () && bfun->errcode == 0)
+    {
+      struct btrace_window *window = btrace_find_window (btinfo,
+							 bfun->number);
+
+      if (window != nullptr)
+	{
+	  if (!window->present)
+	    btrace_materialize_window
+	      (const_cast<struct btrace_thread_info *> (btinfo), window);
+	  else
+	    window->last_use = ++btrace_window_clock;
+	}
+    }
+#endif /* defined (HAVE_LIBIPT)  */
+
+  gdb_assert (bfun->insn.size () == bfun->ninsns);
+  return bfun->insn;
+}
+
+/* See btrace.h.  */
+
+scoped_btrace_insns_pin::scoped_btrace_insns_pin
+  (const struct btrace_thread_info *btinfo,
+   const struct btrace_function *bfun)
+  : m_btinfo (const_cast<struct btrace_thread_info *> (btinfo))
+{
+#if defined (HAVE_LIBIPT)
+  if (m_btinfo->windows.empty ())
+    return;
+
+  struct btrace_window *window = btrace_find_window (m_btinfo, bfun->number);
+  if (window == nullptr)
+    return;
+
+  m_window = window - m_btinfo->windows.data ();
+  window->pins += 1;
+#endif /* defined (HAVE_LIBIPT)  */
+}
+
+/* See btrace.h.  */
+
+scoped_btrace_insns_pin::~scoped_btrace_insns_pin ()
+{
+  /* The trace may have been cleared in the meantime.  */
+  if (m_window < m_btinfo->windows.size ()
+      && m_btinfo->windows[m_window].pins != 0)
+    m_btinfo->windows[m_window].pins -= 1;
+}
+
+/* See btrace.h.  */
+
 void
 btrace_free_objfile (struct objfile *objfile)
 {
@@ -2032,11 +3219,11 @@ btrace_insn_get (const struct btrace_insn_iterator *it)
     return NULL;
 
   /* The index is within the bounds of this function's instruction vector.  */
-  end = bfun->insn.size ();
+  end = bfun->ninsns;
   gdb_assert (0 < end);
   gdb_assert (index < end);
 
-  return &bfun->insn[index];
+  return &btrace_function_insns (it->btinfo, bfun)[index];
 }
 
 /* See btrace.h.  */
@@ -2082,7 +3269,7 @@ btrace_insn_end (struct btrace_insn_iterator *it,
     error (_("No trace."));
 
   bfun = &btinfo->functions.back ();
-  length = bfun->insn.size ();
+  length = bfun->ninsns;
 
   /* The last function may either be a gap or it contains the current
      instruction, which is one past the end of the execution trace; ignore
@@ -2111,7 +3298,7 @@ btrace_insn_next (struct btrace_insn_iterator *it, unsigned int stride)
     {
       unsigned int end, space, adv;
 
-      end = bfun->insn.size ();
+      end = bfun->ninsns;
 
       /* An empty function segment represents a gap in the trace.  We count
 	 it as one instruction.  */
@@ -2204,7 +3391,7 @@ btrace_insn_prev (struct btrace_insn_iterator *it, unsigned int stride)
 
 	  /* We point to one after the last instruction in the new function.  */
 	  bfun = prev;
-	  index = bfun->insn.size ();
+	  index = bfun->ninsns;
 
 	  /* An empty function segment represents a gap in the trace.  We count
 	     it as one instruction.  */
@@ -2524,6 +3711,355 @@ btrace_is_empty (struct thread_info *tp)
   return btrace_insn_cmp (&begin, &end) == 0;
 }
 
+/* The key of a function in an execution profile.  */
+
+typedef std::pair<const minimal_symbol *, const symbol *> btrace_profile_key;
+
+/* Hash the keys of the maps used to compute an execution profile.  */
+
+struct btrace_profile_hash
+{
+  static size_t combine (size_t h, size_t v)
+  {
+    return h ^ (v + 0x9e3779b9 + (h << 6) + (h >> 2));
+  }
+
+  size_t operator() (const btrace_profile_key &key) const
+  {
+    return combine (std::hash<const void *> () (key.first),
+		    std::hash<const void *> () (key.second));
+  }
+
+  size_t operator() (const std::pair<btrace_profile_key,
+				     btrace_profile_key> &key) const
+  {
+    return combine ((*this) (key.first), (*this) (key.second));
+  }
+
+  size_t operator() (const std::pair<CORE_ADDR, CORE_ADDR> &key) const
+  {
+    return combine (std::hash<CORE_ADDR> () (key.first),
+		    std::hash<CORE_ADDR> () (key.second));
+  }
+};
+
+/* The counts of a function, see btrace_profile_function.  */
+
+struct btrace_profile_counts
+{
+  unsigned long long self = 0;
+  unsigned long long total = 0;
+  unsigned long long calls = 0;
+};
+
+/* The counts of a basic block, see btrace_profile_block.  */
+
+struct btrace_profile_block_counts
+{
+  unsigned int ninsns = 0;
+  unsigned long long count = 0;
+};
+
+/* The part of an execution profile computed from a range of function
+   segments.  Instructions are counted by address; mapping them to
+   source lines needs the symbol tables, which are not thread-safe.  */
+
+struct btrace_profile_part
+{
+  std::unordered_map<btrace_profile_key, btrace_profile_counts,
+		     btrace_profile_hash> functions;
+  std::unordered_map<std::pair<btrace_profile_key, btrace_profile_key>,
+		     unsigned long long, btrace_profile_hash> calls;
+  std::unordered_map<std::pair<CORE_ADDR, CORE_ADDR>,
+		     btrace_profile_block_counts, btrace_profile_hash> blocks;
+  std::unordered_map<CORE_ADDR, unsigned long long> pcs;
+  unsigned long long insns = 0;
+};
+
+/* Return the profile key of BFUN.  */
+
+static btrace_profile_key
+btrace_profile_key_of (const struct btrace_function &bfun)
+{
+  return { bfun.msym, bfun.sym };
+}
+
+/* See btrace.h.  */
+
+const char *
+btrace_profile_function_name (const struct btrace_profile_function &fun)
+{
+  if (fun.sym != NULL)
+    return fun.sym->print_name ();
+
+  if (fun.msym != NULL)
+    return fun.msym->print_name ();
+
+  return "??";
+}
+
+/* Compute the part of an execution profile for the function segments
+   from FIRST to LAST in BTINFO.  GET_INSNS returns the instructions of
+   a function segment.  This may run in a worker thread.  */
+
+static btrace_profile_part
+btrace_profile_segments
+  (const struct btrace_thread_info *btinfo,
+   const struct btrace_function *first, const struct btrace_function *last,
+   gdb::function_view<const std::vector<btrace_insn> &
+		      (const struct btrace_function *)> get_insns)
+{
+  const struct btrace_function *back = &btinfo->functions.back ();
+  btrace_profile_part part;
+
+  for (const struct btrace_function *bfun = first; bfun != last; ++bfun)
+    {
+      if (bfun->errcode != 0)
+	continue;
+
+      btrace_profile_key key = btrace_profile_key_of (*bfun);
+      btrace_profile_counts &counts = part.functions[key];
+
+      /* The last instruction of the trace is the current instruction.
+	 It has not been executed yet.  */
+      unsigned int ninsns = bfun->ninsns;
+      if (bfun == back)
+	ninsns -= 1;
+
+      counts.self += ninsns;
+      part.insns += ninsns;
+
+      const std::vector<btrace_insn> &insns = get_insns (bfun);
+      unsigned int begin = 0;
+      for (unsigned int i = 0; i < ninsns; ++i)
+	{
+	  part.pcs[insns[i].pc] += 1;
+
+	  if (insns[i].iclass != BTRACE_INSN_OTHER || i + 1 == ninsns)
+	    {
+	      btrace_profile_block_counts &block
+		= part.blocks[{ insns[begin].pc, insns[i].pc }];
+
+	      block.ninsns = i - begin + 1;
+	      block.count += 1;
+	      begin = i + 1;
+	    }
+	}
+
+      /* The rest is done once for each call, at its first segment.  */
+      if (bfun->prev != 0)
+	continue;
+
+      const struct btrace_function *end = bfun;
+      while (end->next != 0)
+	end = &btinfo->functions[end->next - 1];
+
+      /* Count recursive calls only once, at the outermost call.  */
+      bool recursive = false;
+      for (unsigned int up = bfun->up; up != 0;
+	   up = btinfo->functions[up - 1].up)
+	if (btrace_profile_key_of (btinfo->functions[up - 1]) == key)
+	  {
+	    recursive = true;
+	    break;
+	  }
+
+      if (!recursive)
+	counts.total += (end->insn_offset + end->ninsns
+			 - (end == back ? 1 : 0) - bfun->insn_offset);
+
+      if (bfun->up != 0 && (bfun->flags & BFUN_UP_LINKS_TO_RET) == 0)
+	{
+	  const struct btrace_function &caller
+	    = btinfo->functions[bfun->up - 1];
+
+	  counts.calls += 1;
+	  part.calls[{ btrace_profile_key_of (caller), key }] += 1;
+	}
+    }
+
+  return part;
+}
+
+/* See btrace.h.  */
+
+btrace_profile
+btrace_compute_profile (const struct btrace_thread_info *btinfo)
+{
+  btrace_profile profile;
+
+  if (btinfo->functions.empty ())
+    return profile;
+
+  const struct btrace_function *first = btinfo->functions.data ();
+  const struct btrace_function *last = first + btinfo->functions.size ();
+  std::vector<btrace_profile_part> parts;
+
+  /* Instructions that were dropped to save memory must be decoded again,
+     which we can only do on the main thread.  */
+  if (btinfo->windows.empty ())
+    {
+      auto task_size_ = [] (const struct btrace_function *bfun) -> size_t
+	{
+	  return bfun->ninsns + 1;
+	};
+      auto task_size = gdb::make_function_view (task_size_);
+
+      parts = gdb::parallel_for_each
+	(1, first, last,
+	 [btinfo] (const struct btrace_function *begin,
+		   const struct btrace_function *end)
+	   {
+	     return btrace_profile_segments
+	       (btinfo, begin, end,
+		[] (const struct btrace_function *bfun)
+		  -> const std::vector<btrace_insn> &
+		  {
+		    return bfun->insn;
+		  });
+	   },
+	 task_size);
+    }
+  else
+    parts = gdb::sequential_for_each
+      (1, first, last,
+       [btinfo] (const struct btrace_function *begin,
+		 const struct btrace_function *end)
+	 {
+	   return btrace_profile_segments
+	     (btinfo, begin, end,
+	      [btinfo] (const struct btrace_function *bfun)
+		-> const std::vector<btrace_insn> &
+		{
+		  return btrace_function_insns (btinfo, bfun);
+		});
+	 });
+
+  /* Merge the parts.  */
+  btrace_profile_part all = std::move (parts.back ());
+  parts.pop_back ();
+  for (const btrace_profile_part &part : parts)
+    {
+      for (const auto &it : part.functions)
+	{
+	  btrace_profile_counts &counts = all.functions[it.first];
+
+	  counts.self += it.second.self;
+	  counts.total += it.second.total;
+	  counts.calls += it.second.calls;
+	}
+
+      for (const auto &it : part.calls)
+	all.calls[it.first] += it.second;
+
+      for (const auto &it : part.blocks)
+	{
+	  btrace_profile_block_counts &block = all.blocks[it.first];
+
+	  block.ninsns = it.second.ninsns;
+	  block.count += it.second.count;
+	}
+
+      for (const auto &it : part.pcs)
+	all.pcs[it.first] += it.second;
+
+      all.insns += part.insns;
+    }
+  parts.clear ();
+
+  profile.insns = all.insns;
+
+  for (const auto &it : all.functions)
+    profile.functions.push_back
+      ({ const_cast<minimal_symbol *> (it.first.first),
+	 const_cast<symbol *> (it.first.second),
+	 it.second.self, it.second.total, it.second.calls });
+
+  std::sort (profile.functions.begin (), profile.functions.end (),
+	     [] (const btrace_profile_function &lhs,
+		 const btrace_profile_function &rhs)
+	     {
+	       if (lhs.self != rhs.self)
+		 return lhs.self > rhs.self;
+	       if (lhs.total != rhs.total)
+		 return lhs.total > rhs.total;
+	       return strcmp (btrace_profile_function_name (lhs),
+			      btrace_profile_function_name (rhs)) < 0;
+	     });
+
+  std::unordered_map<btrace_profile_key, unsigned int,
+		     btrace_profile_hash> index;
+  for (unsigned int i = 0; i < profile.functions.size (); ++i)
+    index[{ profile.functions[i].msym, profile.functions[i].sym }] = i;
+
+  for (const auto &it : all.calls)
+    profile.calls.push_back ({ index[it.first.first], index[it.first.second],
+			       it.second });
+
+  std::sort (profile.calls.begin (), profile.calls.end (),
+	     [] (const btrace_profile_call &lhs,
+		 const btrace_profile_call &rhs)
+	     {
+	       if (lhs.count != rhs.count)
+		 return lhs.count > rhs.count;
+	       if (lhs.caller != rhs.caller)
+		 return lhs.caller < rhs.caller;
+	       return lhs.callee < rhs.callee;
+	     });
+
+  for (const auto &it : all.blocks)
+    profile.blocks.push_back ({ it.first.first, it.first.second,
+				it.second.ninsns, it.second.count });
+
+  std::sort (profile.blocks.begin (), profile.blocks.end (),
+	     [] (const btrace_profile_block &lhs,
+		 const btrace_profile_block &rhs)
+	     {
+	       unsigned long long lhs_insns = lhs.count * lhs.ninsns;
+	       unsigned long long rhs_insns = rhs.count * rhs.ninsns;
+
+	       if (lhs_insns != rhs_insns)
+		 return lhs_insns > rhs_insns;
+	       if (lhs.begin != rhs.begin)
+		 return lhs.begin < rhs.begin;
+	       return lhs.end < rhs.end;
+	     });
+
+  /* Map instructions to source lines, looking up each address once.  */
+  std::map<std::pair<const symtab *, int>, unsigned int> lines;
+  for (const auto &it : all.pcs)
+    {
+      struct symtab_and_line sal = find_pc_line (it.first, 0);
+
+      if (sal.symtab == NULL || sal.line == 0)
+	continue;
+
+      auto inserted = lines.emplace (std::make_pair (sal.symtab, sal.line),
+				     profile.lines.size ());
+      if (inserted.second)
+	profile.lines.push_back ({ sal.symtab, sal.line, 0 });
+
+      profile.lines[inserted.first->second].insns += it.second;
+    }
+
+  std::sort (profile.lines.begin (), profile.lines.end (),
+	     [] (const btrace_profile_line &lhs,
+		 const btrace_profile_line &rhs)
+	     {
+	       if (lhs.insns != rhs.insns)
+		 return lhs.insns > rhs.insns;
+	       int cmp = filename_cmp (symtab_to_filename_for_display
+				       (lhs.symtab),
+				       symtab_to_filename_for_display
+				       (rhs.symtab));
+	       if (cmp != 0)
+		 return cmp < 0;
+	       return lhs.line < rhs.line;
+	     });
+
+  return profile;
+}
+
 #if defined (HAVE_LIBIPT)
 
 /* Print a single packet.  */
@@ -3124,6 +4660,16 @@ show_maint_btrace_pt_skip_pad  (struct ui_file *file, int from_tty,
 }
 
 
+/* The "maint show btrace pt parallel-decode" show value function.  */
+
+static void
+show_maint_btrace_pt_parallel_decode (struct ui_file *file, int from_tty,
+				      struct cmd_list_element *c,
+				      const char *value)
+{
+  gdb_printf (file, _("Parallel decoding of large traces is %s.\n"), value);
+}
+
 /* Initialize btrace maintenance commands.  */
 
 void _initialize_btrace ();
@@ -3162,6 +4708,17 @@ When enabled, PAD packets are ignored in the btrace packet history."),
 			   &maint_btrace_pt_set_cmdlist,
 			   &maint_btrace_pt_show_cmdlist);
 
+  add_setshow_boolean_cmd ("parallel-decode", class_maintenance,
+			   &maint_btrace_pt_parallel_decode, _("\
+Set whether large traces are decoded in worker threads."), _("\
+Show whether large traces are decoded in worker threads."), _("\
+When enabled, Intel Processor Trace traces of several megabytes are split\n\
+at PSB packets and the parts are decoded in parallel, using the worker\n\
+threads set with \"maint set worker-threads\"."),
+			   NULL, show_maint_btrace_pt_parallel_decode,
+			   &maint_btrace_pt_set_cmdlist,
+			   &maint_btrace_pt_show_cmdlist);
+
   add_cmd ("packet-history", class_maintenance, maint_btrace_packet_history_cmd,
 	   _("Print the raw branch tracing data.\n\
 With no argument, print ten more packets after the previous ten-line print.\n\
@@ -29,6 +29,7 @@
 #include "gdbsupport/btrace-common.h"
 #include "target/waitstatus.h"
 #include "gdbsupport/enum-flags.h"
+#include "gdbsupport/gdb_optional.h"
 
 #if defined (HAVE_LIBIPT)
 #  include <intel-pt.h>
@@ -156,9 +157,15 @@ struct btrace_function
 
   /* The instructions in this function segment.
      The instruction vector will be empty if the function segment
-     represents a decode error.  */
+     represents a decode error.  It is also empty if the instructions
+     were dropped to save memory, see btrace_window; use
+     btrace_function_insns to access them.  */
   std::vector<btrace_insn> insn;
 
+  /* The number of instructions in this function segment.  This is
+     the size of INSN unless the instructions were dropped.  */
+  unsigned int ninsns = 0;
+
   /* The error code of a decode error that led to a gap.
      Must be zero unless INSN is empty; non-zero otherwise.  */
   int errcode = 0;
@@ -186,6 +193,48 @@ struct btrace_function
   btrace_function_flags flags = 0;
 };
 
+/* A part of the raw trace that can be decoded again on its own.  When
+   the number of decoded instructions is limited, see "set record btrace
+   pt max-decoded-insns", the instructions of function segments are
+   dropped one window at a time, least recently used first, and decoded
+   again from the window when they are needed.  */
+struct btrace_window
+{
+  /* The offsets of the window in the raw trace, from BEGIN (inclusive)
+     to END (exclusive).  */
+  uint64_t begin;
+  uint64_t end;
+
+  /* The offset up to which the window is decoded, to find the PSB
+     packet the next window starts with at END.  */
+  uint64_t limit;
+
+  /* The number of instructions decoded from the window.  */
+  unsigned int ninsns;
+
+  /* The number of the function segment that holds the first instruction
+     of the window, and the index of that instruction in it.  */
+  unsigned int call;
+  unsigned int index;
+
+  /* The numbers of the function segments that start in this window,
+     from OWN_BEGIN (inclusive) to OWN_END (exclusive).  Their
+     instructions are dropped and decoded again together.  */
+  unsigned int own_begin;
+  unsigned int own_end;
+
+  /* Whether the instructions of the function segments this window owns
+     are present.  */
+  bool present;
+
+  /* The number of scoped_btrace_insns_pin objects keeping the
+     instructions present.  */
+  unsigned int pins = 0;
+
+  /* When the window was last used.  */
+  unsigned long long last_use;
+};
+
 /* A branch trace instruction iterator.  */
 struct btrace_insn_iterator
 {
@@ -322,6 +371,10 @@ struct btrace_thread_info
      the underlying architecture.  */
   struct btrace_target_info *target;
 
+  /* The configuration of a trace restored from a file by btrace_restore.
+     TARGET is NULL in this case; the thread is not being traced.  */
+  gdb::optional<btrace_config> restored;
+
   /* The raw branch trace data for the below branch trace.  */
   struct btrace_data data;
 
@@ -338,6 +391,18 @@ struct btrace_thread_info
   /* The number of gaps in the trace.  */
   unsigned int ngaps;
 
+  /* The windows of the trace in trace order, if instructions may be
+     dropped to save memory.  Empty otherwise.  */
+  std::vector<btrace_window> windows;
+
+  /* The number of instructions present in function segments owned by
+     a window.  */
+  unsigned long long window_insns;
+
+  /* The cpu the trace was decoded for.  Windows are decoded again for
+     the same cpu.  */
+  struct btrace_cpu window_cpu;
+
   /* A bit-vector of btrace_thread_flag.  */
   btrace_thread_flags flags;
 
@@ -363,8 +428,17 @@ struct btrace_thread_info
 extern void btrace_enable (struct thread_info *tp,
 			   const struct btrace_config *conf);
 
+/* Use the branch trace DATA, recorded with configuration CONF and saved
+   to a file, as the trace of thread TP.  If CPU is not NULL, overwrite
+   the cpu in the branch trace configuration.  */
+extern void btrace_restore (struct thread_info *tp,
+			    const struct btrace_config *conf,
+			    struct btrace_data *data,
+			    const struct btrace_cpu *cpu);
+
 /* Get the branch trace configuration for a thread.
-   Return NULL if branch tracing is not enabled for that thread.  */
+   Return NULL if branch tracing is not enabled for that thread and its
+   trace was not restored from a file.  */
 extern const struct btrace_config *
   btrace_conf (const struct btrace_thread_info *);
 
@@ -390,12 +464,47 @@ extern void btrace_fetch (struct thread_info *,
 /* Clear the branch trace for a single thread.  */
 extern void btrace_clear (struct thread_info *);
 
+/* The maximum number of instructions of Intel PT traces kept decoded
+   in function segments, or UINT_MAX for no limit.  */
+extern unsigned int btrace_pt_max_decoded_insns;
+
+/* Return the instructions of BFUN, a function segment of BTINFO,
+   decoding them again if they were dropped to save memory.  The
+   returned reference may be invalidated by the next call, unless BFUN
+   is pinned with scoped_btrace_insns_pin.  */
+extern const std::vector<btrace_insn> &
+  btrace_function_insns (const struct btrace_thread_info *btinfo,
+			 const struct btrace_function *bfun);
+
+/* Keep the instructions of BFUN, a function segment of BTINFO, from
+   being dropped to save memory while this object exists.  References
+   and pointers to them from btrace_function_insns and btrace_insn_get
+   stay valid until then.  */
+class scoped_btrace_insns_pin
+{
+public:
+  scoped_btrace_insns_pin (const struct btrace_thread_info *btinfo,
+			   const struct btrace_function *bfun);
+  ~scoped_btrace_insns_pin ();
+
+  DISABLE_COPY_AND_ASSIGN (scoped_btrace_insns_pin);
+
+private:
+  struct btrace_thread_info *m_btinfo;
+
+  /* The index of the pinned window, or a value past the end of the
+     windows if there is none.  */
+  size_t m_window = SIZE_MAX;
+};
+
 /* Clear the branch trace for all threads when an object file goes away.  */
 extern void btrace_free_objfile (struct objfile *);
 
 /* Dereference a branch trace instruction iterator.  Return a pointer to the
    instruction the iterator points to.
-   May return NULL if the iterator points to a gap in the trace.  */
+   May return NULL if the iterator points to a gap in the trace.
+   The pointer may be invalidated like the reference returned by
+   btrace_function_insns.  */
 extern const struct btrace_insn *
   btrace_insn_get (const struct btrace_insn_iterator *);
 
@@ -498,4 +607,81 @@ extern int btrace_is_replaying (struct thread_info *tp);
 /* Return non-zero if the branch trace for TP is empty; zero otherwise.  */
 extern int btrace_is_empty (struct thread_info *tp);
 
+/* A function in an execution profile.  */
+struct btrace_profile_function
+{
+  /* The function, as in struct btrace_function.  Either may be NULL.  */
+  struct minimal_symbol *msym;
+  struct symbol *sym;
+
+  /* The number of instructions executed in the function itself.  */
+  unsigned long long self;
+
+  /* The number of instructions executed in the function and the
+     functions it called.  Recursive calls are counted once.  */
+  unsigned long long total;
+
+  /* The number of times the function was called.  */
+  unsigned long long calls;
+};
+
+/* A source line in an execution profile.  */
+struct btrace_profile_line
+{
+  struct symtab *symtab;
+  int line;
+
+  /* The number of instructions executed for the line.  */
+  unsigned long long insns;
+};
+
+/* A basic block in an execution profile: a sequence of instructions
+   that was entered at its first instruction and left after its last,
+   which is a branch, or at a gap or the end of the trace.  */
+struct btrace_profile_block
+{
+  /* The addresses of the first and last instruction.  */
+  CORE_ADDR begin;
+  CORE_ADDR end;
+
+  /* The number of instructions in the block.  */
+  unsigned int ninsns;
+
+  /* The number of times the block was executed.  */
+  unsigned long long count;
+};
+
+/* A caller-callee edge of the call graph in an execution profile.  */
+struct btrace_profile_call
+{
+  /* Indices of the caller and the callee in btrace_profile::functions.  */
+  unsigned int caller;
+  unsigned int callee;
+
+  /* The number of calls.  */
+  unsigned long long count;
+};
+
+/* An execution profile computed from a branch trace.  Gaps are
+   ignored.  Each vector is sorted by decreasing instruction count or,
+   for CALLS, by decreasing number of calls.  */
+struct btrace_profile
+{
+  std::vector<btrace_profile_function> functions;
+  std::vector<btrace_profile_line> lines;
+  std::vector<btrace_profile_block> blocks;
+  std::vector<btrace_profile_call> calls;
+
+  /* The total number of instructions in the trace.  */
+  unsigned long long insns = 0;
+};
+
+/* Compute the execution profile of the branch trace in BTINFO.  */
+extern btrace_profile btrace_compute_profile
+  (const struct btrace_thread_info *btinfo);
+
+/* Return the name of the function in an execution profile FUN.  */
+extern const char *btrace_profile_function_name
+  (const struct btrace_profile_function &fun);
+
 #endif /* BTRACE_H */
@@ -250,10 +250,16 @@ c_value_print_array (struct value *val,
 {
   struct type *type = check_typedef (val->type ());
   CORE_ADDR address = val->address ();
-  const gdb_byte *valaddr = val->contents_for_printing ().data ();
   struct type *unresolved_elttype = type->target_type ();
   struct type *elttype = check_typedef (unresolved_elttype);
 
+  /* VAL may still be lazy if it is a large array which
+     value_print_array_elements reads a chunk at a time.  Arrays printed
+     as strings need all of their contents.  */
+  if (val->lazy () && c_textual_element_type (unresolved_elttype,
+					      options->format))
+    val->fetch_lazy ();
+
   if (type->length () > 0 && unresolved_elttype->length () > 0)
     {
       LONGEST low_bound, high_bound;
@@ -274,6 +280,7 @@ c_value_print_array (struct value *val,
 	  && !val->bits_any_optimized_out (0,
 					   TARGET_CHAR_BIT * type->length ()))
 	{
+	  const gdb_byte *valaddr = val->contents_for_printing ().data ();
 	  int force_ellipses = 0;
 
 	  /* If requested, look for the first null char and only
@@ -329,7 +336,8 @@ c_value_print_array (struct value *val,
   else
     {
       /* Array of unspecified length: treat like pointer to first elt.  */
-      print_unpacked_pointer (type, elttype, unresolved_elttype, valaddr,
+      print_unpacked_pointer (type, elttype, unresolved_elttype,
+			      val->contents_for_printing ().data (),
 			      0, address, stream, recurse, options);
     }
 }
@@ -143,6 +143,47 @@ dump_binary_file (const char *filename, const char *mode,
     perror_with_name (filename);
 }
 
+/* Binary dumps of target memory are read and written in chunks of this
+   many bytes.  */
+
+static const ULONGEST dump_chunk_size = 65536;
+
+/* Write LEN bytes of target memory at ADDR to the binary file FILENAME,
+   opened with MODE.  The memory is read a chunk at a time, so that the
+   whole range never needs to be held in GDB's memory.  The file is
+   only opened once the first chunk has been read.  */
+
+static void
+dump_binary_memory (const char *filename, const char *mode,
+		    CORE_ADDR addr, ULONGEST len)
+{
+  gdb::byte_vector buf (std::min (len, dump_chunk_size));
+  gdb_file_up file;
+
+  do
+    {
+      ULONGEST count = std::min (len, dump_chunk_size);
+
+      read_memory (addr, buf.data (), count);
+
+      if (file == nullptr)
+	{
+	  file = gdb_fopen_cloexec (filename, mode);
+	  if (file == nullptr)
+	    perror_with_name (filename);
+	}
+
+      if (count > 0 && fwrite (buf.data (), count, 1, file.get ()) != 1)
+	perror_with_name (filename);
+
+      addr += count;
+      len -= count;
+
+      QUIT;
+    }
+  while (len > 0);
+}
+
 static void
 dump_bfd_file (const char *filename, const char *mode, 
 	       const char *target, CORE_ADDR vaddr, 
@@ -189,16 +230,19 @@ dump_memory_to_file (const char *cmd, const char *mode, const char *file_format)
     error (_("Invalid memory address range (start >= end)."));
   count = hi - lo;
 
+  if (file_format == NULL || strcmp (file_format, "binary") == 0)
+    {
+      dump_binary_memory (filename.get (), mode, lo, count);
+      return;
+    }
+
   /* FIXME: Should use read_memory_partial() and a magic blocking
      value.  */
   gdb::byte_vector buf (count);
   read_memory (lo, buf.data (), count);
   
   /* Have everything.  Open/write the data.  */
-  if (file_format == NULL || strcmp (file_format, "binary") == 0)
-    dump_binary_file (filename.get (), mode, buf.data (), count);
-  else
-    dump_bfd_file (filename.get (), mode, file_format, lo, buf.data (), count);
+  dump_bfd_file (filename.get (), mode, file_format, lo, buf.data (), count);
 }
 
 static void
@@ -224,8 +268,19 @@ dump_value_to_file (const char *cmd, const char *mode, const char *file_format)
 
   /* Have everything.  Open/write the data.  */
   if (file_format == NULL || strcmp (file_format, "binary") == 0)
-    dump_binary_file (filename.get (), mode, val->contents ().data (),
-		      val->type ()->length ());
+    {
+      /* Copy values still in target memory directly, rather than
+	 reading them into GDB's memory in full first.  */
+      if (val->lazy ()
+	  && val->lval () == lval_memory
+	  && val->bitsize () == 0)
+	dump_binary_memory (filename.get (), mode,
+			    val->address () + val->embedded_offset (),
+			    val->type ()->length ());
+      else
+	dump_binary_file (filename.get (), mode, val->contents ().data (),
+			  val->type ()->length ());
+    }
   else
     {
       CORE_ADDR vaddr;
@@ -147,6 +147,14 @@ extern std::string debug_file_directory;
 extern int check_quit_flag (void);
 /* * Set the quit flag.  */
 extern void set_quit_flag (void);
+/* * Set the quit flag of GDB itself, bypassing the extension
+   languages.  Unlike set_quit_flag, this may be called from any
+   thread.  */
+extern void set_quit_flag_from_thread ();
+/* * Clear a quit request made by set_quit_flag_from_thread that was
+   not handled yet, leaving any other quit request, such as from
+   Ctrl-C, pending.  */
+extern void clear_quit_flag_from_thread ();
 
 /* The current quit handler (and its type).  This is called from the
    QUIT macro.  See default_quit_handler below for default behavior.
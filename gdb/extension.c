@@ -32,7 +32,9 @@
 #include "cli/cli-script.h"
 #include "python/python.h"
 #include "guile/guile.h"
+#include "native-printer.h"
 #include <array>
+#include <atomic>
 #include "inferior.h"
 
 static script_sourcer_func source_gdb_script;
@@ -463,9 +465,9 @@ ext_lang_type_printers::~ext_lang_type_printers ()
    OPTIONS.  VAL is the object to print.  Returns non-zero if the
    value was successfully pretty-printed.
 
-   Extension languages are tried in the order specified by
-   extension_languages.  The first one to provide a pretty-printed
-   value "wins".
+   Native pretty-printer plugins are tried first, then extension
+   languages in the order specified by extension_languages.  The first
+   one to provide a pretty-printed value "wins".
 
    If an error is encountered in a pretty-printer, no further extension
    languages are tried.
@@ -479,6 +481,10 @@ apply_ext_lang_val_pretty_printer (struct value *val,
 				   const struct value_print_options *options,
 				   const struct language_defn *language)
 {
+  if (apply_native_val_pretty_printer (val, stream, recurse, options,
+				       language) == EXT_LANG_RC_OK)
+    return 1;
+
   for (const struct extension_language_defn *extlang : extension_languages)
     {
       enum ext_lang_rc rc;
@@ -637,7 +643,52 @@ breakpoint_ext_lang_cond_says_stop (struct breakpoint *b)
 /* This flag tracks quit requests when we haven't called out to an
    extension language.  it also holds quit requests when we transition to
    an extension language that doesn't have cooperative SIGINT handling.  */
-static int quit_flag;
+static std::atomic<int> quit_flag;
+
+/* This flag tracks quit requests made by set_quit_flag_from_thread, kept
+   apart from QUIT_FLAG so that clear_quit_flag_from_thread does not lose
+   a Ctrl-C.  */
+static std::atomic<int> thread_quit_flag;
+
+/* Return true if a quit was requested, clearing the request, like
+   check_quit_flag.  Leave the quit requests of
+   set_quit_flag_from_thread alone unless INCLUDE_THREAD_FLAG, so that
+   moving the quit flag from an extension language to another keeps
+   them apart.  */
+
+static int
+check_quit_flag_1 (bool include_thread_flag)
+{
+  int result = 0;
+
+  for (const struct extension_language_defn *extlang : extension_languages)
+    {
+      if (extlang->ops != nullptr
+	  && extlang->ops->check_quit_flag != NULL)
+	if (extlang->ops->check_quit_flag (extlang) != 0)
+	  result = 1;
+    }
+
+  if (include_thread_flag && thread_quit_flag.exchange (0) != 0)
+    {
+      if (!quit_flag)
+	quit_serial_event_clear ();
+      result = 1;
+    }
+
+  /* This is written in a particular way to avoid races.  */
+  if (quit_flag)
+    {
+      /* No longer need to wake up the event loop or any
+	 interruptible_select.  The caller handles the quit
+	 request.  */
+      quit_serial_event_clear ();
+      quit_flag = 0;
+      result = 1;
+    }
+
+  return result;
+}
 
 /* The current extension language we've called out to, or
    extension_language_gdb if there isn't one.
@@ -784,7 +835,7 @@ set_active_ext_lang (const struct extension_language_defn *now_active)
 	 move it to the new language, or save it in GDB's global flag if the
 	 newly active extension language doesn't use cooperative SIGINT
 	 handling.  */
-      if (check_quit_flag ())
+      if (check_quit_flag_1 (false))
 	set_quit_flag ();
     }
 
@@ -815,7 +866,7 @@ restore_active_ext_lang (struct active_ext_lang_state *previous)
 	 move it to the new language, or save it in GDB's global flag if the
 	 newly active extension language doesn't use cooperative SIGINT
 	 handling.  */
-      if (check_quit_flag ())
+      if (check_quit_flag_1 (false))
 	set_quit_flag ();
     }
   xfree (previous);
@@ -848,6 +899,34 @@ set_quit_flag (void)
     }
 }
 
+/* See defs.h.  */
+
+void
+set_quit_flag_from_thread ()
+{
+  /* Leave the extension languages alone, their quit flag may only be
+     set by the main thread.  check_quit_flag looks at this one
+     whichever extension language is active.  */
+  thread_quit_flag = 1;
+  quit_serial_event_set ();
+}
+
+/* See defs.h.  */
+
+void
+clear_quit_flag_from_thread ()
+{
+  if (thread_quit_flag.exchange (0) == 0)
+    return;
+
+  quit_serial_event_clear ();
+
+  /* A Ctrl-C may have arrived meanwhile, keep waking up the event loop
+     for it.  */
+  if (quit_flag)
+    quit_serial_event_set ();
+}
+
 /* Return true if the quit flag has been set, false otherwise.
    Note: The flag is cleared as a side-effect.
    The flag is checked in all extension languages that support cooperative
@@ -856,28 +935,7 @@ set_quit_flag (void)
 int
 check_quit_flag (void)
 {
-  int result = 0;
-
-  for (const struct extension_language_defn *extlang : extension_languages)
-    {
-      if (extlang->ops != nullptr
-	  && extlang->ops->check_quit_flag != NULL)
-	if (extlang->ops->check_quit_flag (extlang) != 0)
-	  result = 1;
-    }
-
-  /* This is written in a particular way to avoid races.  */
-  if (quit_flag)
-    {
-      /* No longer need to wake up the event loop or any
-	 interruptible_select.  The caller handles the quit
-	 request.  */
-      quit_serial_event_clear ();
-      quit_flag = 0;
-      result = 1;
-    }
-
-  return result;
+  return check_quit_flag_1 (true);
 }
 
 /* See extension.h.  */
@@ -150,6 +150,10 @@ struct linespec_state
      space.  */
   struct program_space *search_pspace;
 
+  /* If not NULL, the search is further restricted to just these
+     objfiles (and their separate debug objfiles).  */
+  const std::vector<objfile *> *search_objfiles;
+
   /* The default symtab to use, if no other symtab is specified.  */
   struct symtab *default_symtab;
 
@@ -365,7 +369,8 @@ static std::vector<symtab_and_line> decode_objc (struct linespec_state *self,
 						 const char *arg);
 
 static std::vector<symtab *> symtabs_from_filename
-  (const char *, struct program_space *pspace);
+  (const char *, struct program_space *pspace,
+   const std::vector<objfile *> *search_objfiles);
 
 static std::vector<block_symbol> find_label_symbols
   (struct linespec_state *self,
@@ -399,7 +404,8 @@ static void add_all_symbol_names_from_pspace
 
 static std::vector<symtab *>
   collect_symtabs_from_filename (const char *file,
-				 struct program_space *pspace);
+				 struct program_space *pspace,
+				 const std::vector<objfile *> *search_objfiles);
 
 static std::vector<symtab_and_line> decode_digits_ordinary
   (struct linespec_state *self,
@@ -1146,10 +1152,29 @@ maybe_add_address (htab_t set, struct program_space *pspace, CORE_ADDR addr)
   return 1;
 }
 
+/* Return true if OBJFILE is among SEARCH_OBJFILES, or is a separate
+   debug objfile of one of them.  A NULL SEARCH_OBJFILES matches every
+   objfile.  */
+
+static bool
+objfile_searched_p (const std::vector<objfile *> *search_objfiles,
+		    struct objfile *objfile)
+{
+  if (search_objfiles == nullptr)
+    return true;
+
+  if (objfile->separate_debug_objfile_backlink != nullptr)
+    objfile = objfile->separate_debug_objfile_backlink;
+
+  return std::find (search_objfiles->begin (), search_objfiles->end (),
+		    objfile) != search_objfiles->end ();
+}
+
 /* A helper that walks over all matching symtabs in all objfiles and
    calls CALLBACK for each symbol matching NAME.  If SEARCH_PSPACE is
    not NULL, then the search is restricted to just that program
-   space.  If INCLUDE_INLINE is true then symbols representing
+   space, and if STATE->SEARCH_OBJFILES is not NULL, to just those
+   objfiles.  If INCLUDE_INLINE is true then symbols representing
    inlined instances of functions will be included in the result.  */
 
 static void
@@ -1172,6 +1197,9 @@ iterate_over_all_matching_symtabs
 
       for (objfile *objfile : current_program_space->objfiles ())
 	{
+	  if (!objfile_searched_p (state->search_objfiles, objfile))
+	    continue;
+
 	  if (lookup_name.name ().find ('.') == std::string::npos)
 	    objfile->expand_symtabs_matching (NULL, &lookup_name, NULL, NULL,
 					      (SEARCH_GLOBAL_BLOCK
@@ -2063,7 +2091,8 @@ create_sals_line_offset (struct linespec_state *self,
       initialize_defaults (&self->default_symtab, &self->default_line);
       ls->file_symtabs
 	= collect_symtabs_from_filename (self->default_symtab->filename,
-					 self->search_pspace);
+					 self->search_pspace,
+					 self->search_objfiles);
       use_default = 1;
     }
 
@@ -2356,7 +2385,8 @@ convert_explicit_location_spec_to_linespec
       try
 	{
 	  result->file_symtabs
-	    = symtabs_from_filename (source_filename, self->search_pspace);
+	    = symtabs_from_filename (source_filename, self->search_pspace,
+				     self->search_objfiles);
 	}
       catch (const gdb_exception_error &except)
 	{
@@ -2587,7 +2617,8 @@ parse_linespec (linespec_parser *parser, const char *arg,
 	{
 	  PARSER_RESULT (parser)->file_symtabs
 	    = symtabs_from_filename (user_filename.get (),
-				     PARSER_STATE (parser)->search_pspace);
+				     PARSER_STATE (parser)->search_pspace,
+				     PARSER_STATE (parser)->search_objfiles);
 	}
       catch (gdb_exception_error &ex)
 	{
@@ -3241,6 +3272,37 @@ decode_line_1 (const location_spec *locspec, int flags,
 
 /* See linespec.h.  */
 
+bool
+decode_line_in_objfiles_p (const location_spec *locspec, int flags,
+			   struct program_space *search_pspace,
+			   const std::vector<objfile *> &objfiles)
+{
+  /* Address and probe location specs are not resolved by searching
+     objfiles, so we cannot tell.  */
+  if (locspec->type () != LINESPEC_LOCATION_SPEC
+      && locspec->type () != EXPLICIT_LOCATION_SPEC)
+    return true;
+
+  linespec_parser parser (flags, current_language,
+			  search_pspace, NULL, 0, NULL);
+  PARSER_STATE (&parser)->search_objfiles = &objfiles;
+
+  scoped_restore_current_program_space restore_pspace;
+
+  try
+    {
+      return !location_spec_to_sals (&parser, locspec).empty ();
+    }
+  catch (const gdb_exception_error &e)
+    {
+      /* Any error other than not finding the symbol or the file might
+	 be unrelated to OBJFILES, so answer conservatively.  */
+      return e.error != NOT_FOUND_ERROR;
+    }
+}
+
+/* See linespec.h.  */
+
 std::vector<symtab_and_line>
 decode_line_with_current_source (const char *string, int flags)
 {
@@ -3723,13 +3785,22 @@ symtab_collector::operator () (struct symtab *symtab)
 
 /* Given a file name, return a list of all matching symtabs.  If
    SEARCH_PSPACE is not NULL, the search is restricted to just that
-   program space.  */
+   program space.  If SEARCH_OBJFILES is not NULL, only those objfiles
+   are searched.  */
 
 static std::vector<symtab *>
 collect_symtabs_from_filename (const char *file,
-			       struct program_space *search_pspace)
+			       struct program_space *search_pspace,
+			       const std::vector<objfile *> *search_objfiles)
 {
   symtab_collector collector;
+  auto objfile_filter = [&] (objfile *objf)
+    {
+      return objfile_searched_p (search_objfiles, objf);
+    };
+  gdb::function_view<bool (objfile *)> filter;
+  if (search_objfiles != nullptr)
+    filter = objfile_filter;
 
   /* Find that file's data.  */
   if (search_pspace == NULL)
@@ -3740,27 +3811,30 @@ collect_symtabs_from_filename (const char *file,
 	    continue;
 
 	  set_current_program_space (pspace);
-	  iterate_over_symtabs (file, collector);
+	  iterate_over_symtabs (file, collector, filter);
 	}
     }
   else
     {
       set_current_program_space (search_pspace);
-      iterate_over_symtabs (file, collector);
+      iterate_over_symtabs (file, collector, filter);
     }
 
   return collector.release_symtabs ();
 }
 
 /* Return all the symtabs associated to the FILENAME.  If SEARCH_PSPACE is
-   not NULL, the search is restricted to just that program space.  */
+   not NULL, the search is restricted to just that program space, and
+   if SEARCH_OBJFILES is not NULL, to just those objfiles.  */
 
 static std::vector<symtab *>
 symtabs_from_filename (const char *filename,
-		       struct program_space *search_pspace)
+		       struct program_space *search_pspace,
+		       const std::vector<objfile *> *search_objfiles)
 {
   std::vector<symtab *> result
-    = collect_symtabs_from_filename (filename, search_pspace);
+    = collect_symtabs_from_filename (filename, search_pspace,
+				     search_objfiles);
 
   if (result.empty ())
     {
@@ -4278,6 +4352,9 @@ search_minsyms_for_name (struct collect_info *info,
 
 	  for (objfile *objfile : current_program_space->objfiles ())
 	    {
+	      if (!objfile_searched_p (info->state->search_objfiles, objfile))
+		continue;
+
 	      iterate_over_minimal_symbols (objfile, name,
 					    [&] (struct minimal_symbol *msym)
 					    {
@@ -4293,7 +4370,9 @@ search_minsyms_for_name (struct collect_info *info,
     {
       program_space *pspace = symtab->compunit ()->objfile ()->pspace;
 
-      if (search_pspace == NULL || pspace == search_pspace)
+      if ((search_pspace == NULL || pspace == search_pspace)
+	  && objfile_searched_p (info->state->search_objfiles,
+				 symtab->compunit ()->objfile ()))
 	{
 	  set_current_program_space (pspace);
 	  iterate_over_minimal_symbols
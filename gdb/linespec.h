@@ -17,6 +17,7 @@
 #if !defined (LINESPEC_H)
 #define LINESPEC_H 1
 
+struct objfile;
 struct symtab;
 
 #include "location.h"
@@ -89,6 +90,19 @@ extern std::vector<symtab_and_line>
 		       struct program_space *search_pspace,
 		       struct symtab *default_symtab, int default_line);
 
+/* Return true if decoding LOCSPEC with the symbol search restricted
+   to OBJFILES (and their separate debug objfiles) finds any location.
+   This is a conservative test: it also returns true if LOCSPEC is not
+   resolved by symbol search, or if decoding fails for a reason other
+   than not finding a match.  It is used to tell whether loading
+   OBJFILES can change the locations LOCSPEC resolves to, without
+   searching the objfiles that were already loaded.  */
+
+extern bool decode_line_in_objfiles_p
+  (const location_spec *locspec, int flags,
+   struct program_space *search_pspace,
+   const std::vector<objfile *> &objfiles);
+
 /* Parse LOCSPEC and return results.  This is the "full"
    interface to this module, which handles multiple results
    properly.
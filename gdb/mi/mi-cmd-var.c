@@ -656,6 +656,7 @@ mi_cmd_var_update (const char *command, const char *const *argv, int argc)
 	 VAROBJ.  Therefore update each VAROBJ only once by iterating
 	 only the root VAROBJs.  */
 
+      scoped_varobj_prefetch prefetch;
       all_root_varobjs ([=] (varobj *var)
 	{ mi_cmd_var_update_iter (var, *name == '0', print_values); });
     }
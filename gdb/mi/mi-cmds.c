@@ -199,6 +199,7 @@ add_builtin_mi_commands ()
 {
   add_mi_cmd_mi ("ada-task-info", mi_cmd_ada_task_info);
   add_mi_cmd_mi ("add-inferior", mi_cmd_add_inferior);
+  add_mi_cmd_mi ("batch-execute", mi_cmd_batch_execute);
   add_mi_cmd_cli ("break-after", "ignore", 1,
 		  &mi_suppress_notification.breakpoint);
   add_mi_cmd_mi ("break-condition",mi_cmd_break_condition,
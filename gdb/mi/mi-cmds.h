@@ -39,6 +39,7 @@ typedef void (mi_cmd_argv_ftype) (const char *command, const char *const *argv,
 
 extern mi_cmd_argv_ftype mi_cmd_ada_task_info;
 extern mi_cmd_argv_ftype mi_cmd_add_inferior;
+extern mi_cmd_argv_ftype mi_cmd_batch_execute;
 extern mi_cmd_argv_ftype mi_cmd_break_insert;
 extern mi_cmd_argv_ftype mi_cmd_dprintf_insert;
 extern mi_cmd_argv_ftype mi_cmd_break_condition;
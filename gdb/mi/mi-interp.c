@@ -915,11 +915,44 @@ mi_interp::set_logging (ui_file_up logfile, bool logging_redirect,
       mi->saved_raw_stdout = nullptr;
     }
 
-  mi->out->set_raw (mi->raw_stdout);
-  mi->err->set_raw (mi->raw_stdout);
-  mi->log->set_raw (mi->raw_stdout);
-  mi->targ->set_raw (mi->raw_stdout);
-  mi->event_channel->set_raw (mi->raw_stdout);
+  set_raw_stdout (mi->raw_stdout);
+}
+
+/* See mi-interp.h.  */
+
+void
+mi_interp::set_raw_stdout (ui_file *file)
+{
+  this->raw_stdout = file;
+  this->out->set_raw (file);
+  this->err->set_raw (file);
+  this->log->set_raw (file);
+  this->targ->set_raw (file);
+  this->event_channel->set_raw (file);
+}
+
+/* See mi-interp.h.  */
+
+void
+mi_interp::defer_output ()
+{
+  gdb_assert (m_deferred_raw_stdout == nullptr);
+
+  m_deferred_raw_stdout = this->raw_stdout;
+  set_raw_stdout (&m_deferred_output);
+}
+
+/* See mi-interp.h.  */
+
+std::string
+mi_interp::end_deferred_output ()
+{
+  if (m_deferred_raw_stdout == nullptr)
+    return {};
+
+  set_raw_stdout (m_deferred_raw_stdout);
+  m_deferred_raw_stdout = nullptr;
+  return m_deferred_output.release ();
 }
 
 /* Factory for MI interpreters.  */
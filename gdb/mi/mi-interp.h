@@ -74,6 +74,16 @@ class mi_interp final : public interp
   void on_memory_changed (inferior *inf, CORE_ADDR addr, ssize_t len,
 			  const bfd_byte *data) override;
 
+  /* Hold back everything written to RAW_STDOUT and to the output
+     channels, while the result record of the current command is
+     streamed to the frontend.  See mi_stream_result.  */
+  void defer_output ();
+
+  /* Stop holding back output, and return what was held back since
+     defer_output, for the caller to write out once the result record
+     is complete.  */
+  std::string end_deferred_output ();
+
   /* MI's output channels */
   mi_console_file *out;
   mi_console_file *err;
@@ -104,6 +114,18 @@ class mi_interp final : public interp
   int mi_proceeded;
 
   const char *current_token;
+
+private:
+
+  /* Make RAW_STDOUT and the output channels write to FILE.  */
+  void set_raw_stdout (ui_file *file);
+
+  /* The value of RAW_STDOUT before defer_output, or NULL if output is
+     not held back.  */
+  ui_file *m_deferred_raw_stdout = nullptr;
+
+  /* The output held back since defer_output.  */
+  string_file m_deferred_output;
 };
 
 /* Output the shared object attributes to UIOUT.  */
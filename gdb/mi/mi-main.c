@@ -59,6 +59,7 @@
 #include "gdbsupport/run-time-clock.h"
 #include <chrono>
 #include "progspace-and-thread.h"
+#include "varobj.h"
 #include "gdbsupport/rsp-low.h"
 #include <algorithm>
 #include <set>
@@ -1671,6 +1672,7 @@ mi_cmd_list_features (const char *command, const char *const *argv, int argc)
       uiout->field_string (NULL, "exec-run-start-option");
       uiout->field_string (NULL, "data-disassemble-a-option");
       uiout->field_string (NULL, "simple-values-ref-types");
+      uiout->field_string (NULL, "batch-execute");
 
       if (ext_lang_initialized_p (get_ext_lang_defn (EXT_LANG_PYTHON)))
 	uiout->field_string (NULL, "python");
@@ -1816,6 +1818,8 @@ captured_mi_execute_command (struct mi_interp *mi, struct ui_out *uiout,
   scoped_restore save_token
     = make_scoped_restore (&mi->current_token, context->token.c_str ());
 
+  std::string deferred_output;
+
   mi->running_result_record_printed = 0;
   mi->mi_proceeded = 0;
   switch (context->op)
@@ -1835,14 +1839,23 @@ captured_mi_execute_command (struct mi_interp *mi, struct ui_out *uiout,
 	 Remember that on the way out of executing a command, you have
 	 to directly use the mi_interp's uiout, since the command
 	 could have reset the interpreter, in which case the current
-	 uiout will most likely crash in the mi_out_* routines.  */
+	 uiout will most likely crash in the mi_out_* routines.  If
+	 the result was streamed, the other output was held back
+	 meanwhile; it is written out after the result record.  */
+      deferred_output = mi->end_deferred_output ();
       if (!mi->running_result_record_printed)
 	{
-	  gdb_puts (context->token.c_str (), mi->raw_stdout);
-	  /* There's no particularly good reason why target-connect results
-	     in not ^done.  Should kill ^connected for MI3.  */
-	  gdb_puts (strcmp (context->command.get (), "target-select") == 0
-		    ? "^connected" : "^done", mi->raw_stdout);
+	  /* If the result was streamed, its start was printed
+	     already.  */
+	  if (!mi_out_streaming_p (uiout))
+	    {
+	      gdb_puts (context->token.c_str (), mi->raw_stdout);
+	      /* There's no particularly good reason why target-connect
+		 results in not ^done.  Should kill ^connected for
+		 MI3.  */
+	      gdb_puts (strcmp (context->command.get (), "target-select") == 0
+			? "^connected" : "^done", mi->raw_stdout);
+	    }
 	  mi_out_put (uiout, mi->raw_stdout);
 	  mi_out_rewind (uiout);
 	  mi_print_timing_maybe (mi->raw_stdout);
@@ -1853,6 +1866,7 @@ captured_mi_execute_command (struct mi_interp *mi, struct ui_out *uiout,
 	   case, the command probably should not have written anything
 	   to uiout, but in case it has written something, discard it.  */
 	mi_out_rewind (uiout);
+      gdb_puts (deferred_output.c_str (), mi->raw_stdout);
       break;
 
     case CLI_COMMAND:
@@ -1892,6 +1906,30 @@ captured_mi_execute_command (struct mi_interp *mi, struct ui_out *uiout,
     }
 }
 
+/* Print a gdb exception that occurred after the result of the
+   command started being streamed to the MI output stream.  The
+   "^done" record was printed already, so end it after the output
+   produced so far with fields saying that it is incomplete, and why.
+   The ui_out objects for the tuples and lists that were still open
+   were destroyed while the exception was propagated, so the output is
+   well formed.  */
+
+static void
+mi_print_streamed_exception (struct mi_interp *mi, struct ui_out *uiout,
+			     const struct gdb_exception &exception)
+{
+  std::string deferred_output = mi->end_deferred_output ();
+
+  mi_out_put (uiout, mi->raw_stdout);
+  gdb_puts (",truncated=\"true\",msg=\"", mi->raw_stdout);
+  if (exception.message == NULL)
+    gdb_puts ("unknown error", mi->raw_stdout);
+  else
+    mi->raw_stdout->putstr (exception.what (), '"');
+  gdb_puts ("\"\n", mi->raw_stdout);
+  gdb_puts (deferred_output.c_str (), mi->raw_stdout);
+}
+
 /* Print a gdb exception to the MI output stream.  */
 
 static void
@@ -1965,7 +2003,10 @@ mi_execute_command (const char *cmd, int from_tty)
 
 	  /* The command execution failed and error() was called
 	     somewhere.  */
-	  mi_print_exception (mi, command->token.c_str (), result);
+	  if (mi_out_streaming_p (current_uiout))
+	    mi_print_streamed_exception (mi, current_uiout, result);
+	  else
+	    mi_print_exception (mi, command->token.c_str (), result);
 	  mi_out_rewind (current_uiout);
 
 	  /* Throw to a higher level catch for SIGTERM sent to GDB.  */
@@ -1999,6 +2040,57 @@ mi_execute_command (mi_parse *context)
   mi_cmd_execute (context);
 }
 
+/* See mi-main.h.  */
+
+void
+mi_stream_result ()
+{
+  mi_interp *mi = as_mi_interp (command_interp ());
+
+  /* The output goes to the frontend only if the command was read by
+     MI and writes to MI's own ui_out; not, for instance, when using
+     the Python gdb.execute_mi function.  */
+  if (mi == nullptr || current_uiout != mi->mi_uiout
+      || mi_out_streaming_p (current_uiout))
+    return;
+
+  if (mi->current_token != nullptr)
+    gdb_puts (mi->current_token, mi->raw_stdout);
+  gdb_puts ("^done", mi->raw_stdout);
+  gdb::checked_static_cast<mi_ui_out *> (current_uiout)->start_streaming
+    (mi->raw_stdout);
+
+  /* Console output, notifications and the like must not end up in the
+     middle of the result record.  */
+  mi->defer_output ();
+}
+
+/* Implementation of the -batch-execute command.  */
+
+void
+mi_cmd_batch_execute (const char *command, const char *const *argv, int argc)
+{
+  if (argc == 0)
+    error (_("-batch-execute: Usage: COMMAND..."));
+
+  mi_interp *mi = as_mi_interp (command_interp ());
+  if (mi == nullptr || current_uiout != mi->mi_uiout)
+    error (_("-batch-execute: Only available to MI frontends."));
+
+  /* The commands print their own result records; this command's
+     "^done" must still be printed after them, whatever they did.  */
+  scoped_restore save_running_result_record_printed
+    = make_scoped_restore (&mi->running_result_record_printed);
+  scoped_restore save_mi_proceeded = make_scoped_restore (&mi->mi_proceeded);
+
+  /* Variable objects are typically updated by several of the
+     commands; fetch their memory once for all of them.  */
+  scoped_varobj_prefetch prefetch;
+
+  for (int i = 0; i < argc; ++i)
+    mi_execute_command (argv[i], 0);
+}
+
 /* Captures the current user selected context state, that is the current
    thread and frame.  Later we can then check if the user selected context
    has changed at all.  */
@@ -73,6 +73,18 @@ extern void mi_cmd_fix_breakpoint_script_output (const char *command,
 						 const char *const *argv,
 						 int argc);
 
+/* Start sending the result of the MI command being executed to the
+   frontend before the command completes, printing the "^done" result
+   record now and its fields as they are produced, rather than
+   buffering them all.  Commands producing large results call this
+   once they are done with the operations that may fail, since the
+   command can no longer report an error afterwards: if it is
+   interrupted, the result record is ended with a "truncated" field.
+   This does nothing if the result does not go straight to the
+   frontend.  */
+
+extern void mi_stream_result ();
+
 /* Parse a thread-group-id from ID, and return the integer part of the
    ID.  A valid thread-group-id is the character 'i' followed by an
    integer that is greater than zero.  */
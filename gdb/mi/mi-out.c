@@ -29,6 +29,11 @@
 #include "utils.h"
 #include "gdbsupport/gdb-checked-static-cast.h"
 
+/* When the output is streamed, the amount of buffered output past
+   which it is written out.  */
+
+static const size_t mi_stream_chunk_size = 64 * 1024;
+
 /* Mark beginning of a table.  */
 
 void
@@ -249,6 +254,15 @@ mi_ui_out::close (ui_out_type type)
     }
 
   m_suppress_field_separator = false;
+
+  /* Write out streamed output at the end of an element, so that the
+     frontend gets whole elements of large lists.  */
+  if (m_stream_target != nullptr && m_streams.size () == 1
+      && main_stream ()->size () >= mi_stream_chunk_size)
+    {
+      put (m_stream_target);
+      gdb_flush (m_stream_target);
+    }
 }
 
 string_file *
@@ -297,6 +311,18 @@ void
 mi_ui_out::rewind ()
 {
   main_stream ()->clear ();
+  m_stream_target = nullptr;
+}
+
+/* See mi-out.h.  */
+
+void
+mi_ui_out::start_streaming (ui_file *stream)
+{
+  gdb_assert (m_stream_target == nullptr);
+
+  put (stream);
+  m_stream_target = stream;
 }
 
 /* Dump the buffer onto the specified stream.  */
@@ -371,3 +397,9 @@ mi_out_rewind (ui_out *uiout)
 {
   return as_mi_ui_out (uiout)->rewind ();
 }
+
+bool
+mi_out_streaming_p (ui_out *uiout)
+{
+  return as_mi_ui_out (uiout)->streaming_p ();
+}
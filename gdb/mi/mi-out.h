@@ -37,6 +37,19 @@ class mi_ui_out : public ui_out
   void rewind ();
   void put (struct ui_file *stream);
 
+  /* Write the output buffered so far to STREAM, then keep writing it
+     there whenever enough was buffered, instead of holding the whole
+     output until the command completes.  This lasts until the next
+     call to rewind.  */
+  void start_streaming (struct ui_file *stream);
+
+  /* Return true if start_streaming was called since the last call to
+     rewind.  */
+  bool streaming_p () const
+  {
+    return m_stream_target != nullptr;
+  }
+
   /* Return the version number of the current MI.  */
   int version ();
 
@@ -137,6 +150,9 @@ class mi_ui_out : public ui_out
   bool m_suppress_output;
   int m_mi_version;
   std::vector<ui_file *> m_streams;
+
+  /* Where the output is streamed to, see start_streaming.  */
+  ui_file *m_stream_target = nullptr;
 };
 
 /* Create an MI ui-out object with MI version MI_VERSION, which should be equal
@@ -147,5 +163,6 @@ std::unique_ptr<mi_ui_out> mi_out_new (const char *mi_version);
 
 void mi_out_put (ui_out *uiout, struct ui_file *stream);
 void mi_out_rewind (ui_out *uiout);
+bool mi_out_streaming_p (ui_out *uiout);
 
 #endif /* MI_MI_OUT_H */
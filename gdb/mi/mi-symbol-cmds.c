@@ -23,6 +23,7 @@
 #include "ui-out.h"
 #include "source.h"
 #include "mi-getopt.h"
+#include "mi-main.h"
 
 /* Print the list of all pc addresses and lines of code for the
    provided (full or base) source file name.  The entries are sorted
@@ -125,6 +126,9 @@ mi_symbol_info (enum search_domain kind, const char *name_regexp,
   ui_out *uiout = current_uiout;
   int i = 0;
 
+  /* The result can be huge, send it out as it is produced.  */
+  mi_stream_result ();
+
   ui_out_emit_tuple outer_symbols_emitter (uiout, "symbols");
 
   /* Debug symbols are placed first. */
@@ -366,6 +370,9 @@ mi_info_module_functions_or_variables (enum search_domain kind,
   std::vector<module_symbol_search> module_symbols
     = search_module_symbols (module_regexp, regexp, type_regexp, kind);
 
+  /* The result can be huge, send it out as it is produced.  */
+  mi_stream_result ();
+
   struct ui_out *uiout = current_uiout;
   ui_out_emit_list all_matching_symbols (uiout, "symbols");
 
@@ -27,6 +27,7 @@
 #include "gdbsupport/filestuff.h"
 #include "gdbsupport/scoped_fd.h"
 #include "gdbsupport/scoped_mmap.h"
+#include "gdbsupport/block-signals.h"
 
 #include <inttypes.h>
 
@@ -38,7 +39,11 @@
 #include <sys/user.h>
 #include "nat/gdb_ptrace.h"
 #include <sys/types.h>
+#include <sys/ioctl.h>
 #include <signal.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <algorithm>
 
 /* A branch trace record in perf_event.  */
 struct perf_event_bts
@@ -180,6 +185,385 @@ perf_event_read_all (struct perf_event_buffer *pev, gdb_byte **data,
   pev->last_head = data_head;
 }
 
+/* Return the buffer to read the trace of TINFO from.  */
+
+static struct perf_event_buffer *
+linux_btrace_buffer (struct linux_btrace_target_info *tinfo)
+{
+#if CXX_STD_THREAD
+  if (tinfo->spill != nullptr)
+    return &tinfo->spill->ring;
+#endif /* CXX_STD_THREAD */
+
+  return &tinfo->pev;
+}
+
+#if CXX_STD_THREAD
+
+linux_btrace_spill::~linux_btrace_spill ()
+{
+  if (ring.mem != nullptr)
+    munmap ((void *) ring.mem, ring.size);
+
+  if (file >= 0)
+    close (file);
+}
+
+/* Create a ring of SIZE bytes, rounded to full pages, to spill the trace
+   to.  The ring is mapped from an unlinked file in $TMPDIR or in /tmp, so
+   the kernel writes it back to disk rather than keeping it in memory.  */
+
+static std::unique_ptr<linux_btrace_spill>
+linux_new_spill (unsigned int size)
+{
+  size_t ring_size
+    = ((size_t) size + PAGE_SIZE - 1) & ~((size_t) PAGE_SIZE - 1);
+
+  /* The ring size is reported back as unsigned int.  */
+  if ((size_t) UINT_MAX < ring_size)
+    ring_size -= PAGE_SIZE;
+
+  const char *tmpdir = getenv ("TMPDIR");
+  if (tmpdir == nullptr || *tmpdir == '\0')
+    tmpdir = "/tmp";
+
+  std::string name = string_printf ("%s/gdb-btrace-XXXXXX", tmpdir);
+  scoped_fd fd = gdb_mkostemp_cloexec (&name[0]);
+  if (fd.get () < 0)
+    error (_("Failed to create trace spill file: %s."),
+	   safe_strerror (errno));
+
+  /* Nobody else needs the file.  It goes away when we close it.  */
+  unlink (name.c_str ());
+
+  if (ftruncate (fd.get (), ring_size) != 0)
+    error (_("Failed to allocate trace spill file: %s."),
+	   safe_strerror (errno));
+
+  scoped_mmap ring (nullptr, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+		    fd.get (), 0);
+  if (ring.get () == MAP_FAILED)
+    error (_("Failed to map trace spill file: %s."), safe_strerror (errno));
+
+  std::unique_ptr<linux_btrace_spill> spill (new linux_btrace_spill);
+  spill->ring.size = ring.size ();
+  spill->ring.mem = (const uint8_t *) ring.release ();
+  spill->ring.data_head = &spill->head;
+  spill->file = fd.release ();
+
+  return spill;
+}
+
+/* Copy the trace in [FROM; TO) of the perf event buffer PEV into the ring
+   of SPILL.  FROM and TO are positions in the stream of trace written into
+   PEV, as is its data_head.  */
+
+static void
+linux_btrace_spill_copy (struct linux_btrace_spill *spill,
+			 const struct perf_event_buffer *pev,
+			 __u64 from, __u64 to)
+{
+  struct perf_event_buffer *ring = &spill->ring;
+  __u64 head = spill->head;
+
+  /* Skip the part that would be overwritten in the ring right away.  We
+     still advance the ring's head by the full amount so the positions in
+     the ring stay aligned with the positions in the perf event stream.  */
+  if (ring->size < to - from)
+    {
+      head += to - from - ring->size;
+      from = to - ring->size;
+    }
+
+  while (from < to)
+    {
+      size_t src = (size_t) (from % pev->size);
+      size_t dst = (size_t) (head % ring->size);
+      size_t len = std::min ({ (size_t) (to - from), pev->size - src,
+			       ring->size - dst });
+
+      memcpy ((uint8_t *) ring->mem + dst, pev->mem + src, len);
+
+      from += len;
+      head += len;
+    }
+
+  spill->head = head;
+}
+
+/* Copy the trace written into the perf event buffer of TINFO since the
+   last call into its spill ring.  The caller must hold the spill's
+   mutex.  */
+
+static void
+linux_btrace_spill_drain (struct linux_btrace_target_info *tinfo)
+{
+  struct linux_btrace_spill *spill = tinfo->spill;
+  struct perf_event_buffer *pev = &tinfo->pev;
+
+  switch (tinfo->conf.format)
+    {
+    case BTRACE_FORMAT_BTS:
+      {
+	/* The BTS buffer is mapped read-only, so the kernel overwrites trace
+	   we did not copy in time.  In that case, we skip to the oldest
+	   sample that is still in the buffer.  Samples are written back to
+	   back from the start of the stream, so this keeps the ring aligned
+	   to samples.  Only one block, spanning the lost trace, will be
+	   wrong.  */
+	__u64 data_head = *pev->data_head;
+	__u64 from = spill->tail;
+
+	if (pev->size < data_head - from)
+	  {
+	    const __u64 sample_size = sizeof (struct perf_event_sample);
+
+	    from = data_head - pev->size;
+	    from += (sample_size - from % sample_size) % sample_size;
+	  }
+
+	linux_btrace_spill_copy (spill, pev, from, data_head);
+	spill->tail = data_head;
+      }
+      return;
+
+#if defined (PERF_ATTR_SIZE_VER5)
+    case BTRACE_FORMAT_PT:
+      {
+	/* The aux buffer is mapped writable when spilling, so the kernel
+	   does not overwrite trace we did not copy, yet.  It stops tracing
+	   when the buffer runs full, instead.  */
+	volatile struct perf_event_mmap_page *header = tinfo->header;
+	__u64 data_head = header->aux_head;
+	__u64 data_tail = header->aux_tail;
+
+	/* Read the trace only after reading its head, and release its
+	   space only after copying it.  */
+	std::atomic_thread_fence (std::memory_order_acquire);
+	linux_btrace_spill_copy (spill, pev, data_tail, data_head);
+	std::atomic_thread_fence (std::memory_order_release);
+
+	header->aux_tail = data_head;
+	spill->tail = data_head;
+
+	/* Tracing resumes with a new PSB, which allows the decoder to
+	   resynchronize after the lost trace.  */
+	if (pev->size <= data_head - data_tail)
+	  ioctl (tinfo->file, PERF_EVENT_IOC_ENABLE, 0);
+      }
+      return;
+#endif /* defined (PERF_ATTR_SIZE_VER5) */
+
+    default:
+      return;
+    }
+}
+
+/* The thread that spills the trace of all threads recorded with a
+   spill ring.  */
+
+struct linux_btrace_spiller
+{
+  /* Protects the members below.  Held by the reader while it drains
+     the perf event buffers, so a thread cannot be removed meanwhile.  */
+  std::mutex mutex;
+
+  /* The threads whose trace is spilled.  */
+  std::vector<linux_btrace_target_info *> tinfos;
+
+  /* Incremented whenever TINFOS changes.  */
+  unsigned int generation = 0;
+
+  /* The reader thread, and whether it shall stop.  */
+  std::thread reader;
+  bool stop = false;
+
+  /* A pipe to wake up the reader when TINFOS changes or when it shall
+     stop.  */
+  int wake[2] = { -1, -1 };
+};
+
+/* The spiller.  It is never destroyed, so that a reader still running
+   when GDB exits is not joined.  */
+
+static linux_btrace_spiller *the_spiller;
+
+/* Wake up the reader of SPILLER.  */
+
+static void
+linux_btrace_spiller_wake (linux_btrace_spiller *spiller)
+{
+  char c = 0;
+  int r;
+
+  /* If the pipe is full, the reader is woken up anyway.  */
+  do
+    r = write (spiller->wake[1], &c, 1);
+  while (r < 0 && errno == EINTR);
+}
+
+/* The body of the spill reader thread.
+
+   The reader waits until a perf event buffer is half full, at which
+   point the kernel signals its perf event file, and copies the trace
+   of that buffer into its ring.  Trace is only produced while the
+   inferior runs, so the reader sleeps for as long as it is stopped.
+   Trace below the watermark is copied by linux_read_btrace when GDB
+   reads the trace.  */
+
+static void
+linux_btrace_spill_reader ()
+{
+  linux_btrace_spiller *spiller = the_spiller;
+  std::vector<struct pollfd> pfds;
+  std::vector<linux_btrace_target_info *> polled;
+  unsigned int generation;
+
+  for (;;)
+    {
+      {
+	std::lock_guard<std::mutex> lock (spiller->mutex);
+	if (spiller->stop)
+	  return;
+
+	generation = spiller->generation;
+	pfds.clear ();
+	polled.clear ();
+	pfds.push_back ({ spiller->wake[0], POLLIN, 0 });
+	for (linux_btrace_target_info *tinfo : spiller->tinfos)
+	  if (!tinfo->spill->hung_up)
+	    {
+	      pfds.push_back ({ tinfo->file, POLLIN, 0 });
+	      polled.push_back (tinfo);
+	    }
+      }
+
+      if (poll (pfds.data (), pfds.size (), -1) < 0)
+	continue;
+
+      if ((pfds[0].revents & POLLIN) != 0)
+	{
+	  char buf[64];
+
+	  while (read (spiller->wake[0], buf, sizeof (buf)) > 0)
+	    ;
+	}
+
+      std::lock_guard<std::mutex> lock (spiller->mutex);
+
+      /* The perf event files we polled may have been closed, and their
+	 file descriptors reused, since.  */
+      if (spiller->stop || generation != spiller->generation)
+	continue;
+
+      for (size_t i = 0; i < polled.size (); ++i)
+	{
+	  short revents = pfds[i + 1].revents;
+	  if (revents == 0)
+	    continue;
+
+	  struct linux_btrace_spill *spill = polled[i]->spill;
+	  std::lock_guard<std::mutex> spill_lock (spill->mutex);
+	  linux_btrace_spill_drain (polled[i]);
+
+	  /* The traced thread exited.  There won't be any more trace.  */
+	  if ((revents & (POLLHUP | POLLERR)) != 0)
+	    spill->hung_up = true;
+	}
+    }
+}
+
+/* Attach SPILL to TINFO and start spilling its trace, starting the
+   spill reader if it is not running.  */
+
+static void
+linux_start_spill (struct linux_btrace_target_info *tinfo,
+		   std::unique_ptr<linux_btrace_spill> spill)
+{
+  if (the_spiller == nullptr)
+    the_spiller = new linux_btrace_spiller;
+
+  linux_btrace_spiller *spiller = the_spiller;
+  std::lock_guard<std::mutex> lock (spiller->mutex);
+
+  if (!spiller->reader.joinable ())
+    {
+      if (gdb_pipe_cloexec (spiller->wake) != 0)
+	error (_("Failed to create trace spill pipe: %s."),
+	       safe_strerror (errno));
+
+      fcntl (spiller->wake[0], F_SETFL, O_NONBLOCK);
+      fcntl (spiller->wake[1], F_SETFL, O_NONBLOCK);
+      spiller->stop = false;
+
+      /* Signals are handled by the main thread.  */
+      gdb::block_signals blocker;
+
+      spiller->reader = std::thread (linux_btrace_spill_reader);
+    }
+
+  tinfo->spill = spill.release ();
+  spiller->tinfos.push_back (tinfo);
+  spiller->generation += 1;
+  linux_btrace_spiller_wake (spiller);
+}
+
+/* Stop spilling the trace of TINFO and free its spill ring.  Stop the
+   spill reader if no other thread is spilled.  */
+
+static void
+linux_stop_spill (struct linux_btrace_target_info *tinfo)
+{
+  if (tinfo->spill == nullptr)
+    return;
+
+  linux_btrace_spiller *spiller = the_spiller;
+  std::thread reader;
+  {
+    std::lock_guard<std::mutex> lock (spiller->mutex);
+
+    auto it = std::find (spiller->tinfos.begin (), spiller->tinfos.end (),
+			 tinfo);
+    gdb_assert (it != spiller->tinfos.end ());
+    spiller->tinfos.erase (it);
+    spiller->generation += 1;
+
+    if (spiller->tinfos.empty ())
+      {
+	spiller->stop = true;
+	reader = std::move (spiller->reader);
+      }
+
+    linux_btrace_spiller_wake (spiller);
+  }
+
+  if (reader.joinable ())
+    {
+      reader.join ();
+      close (spiller->wake[0]);
+      close (spiller->wake[1]);
+      spiller->wake[0] = -1;
+      spiller->wake[1] = -1;
+    }
+
+  delete tinfo->spill;
+  tinfo->spill = nullptr;
+}
+
+#else /* !CXX_STD_THREAD */
+
+/* Spilling requires a background thread.  */
+
+static void
+linux_check_spill (unsigned int size)
+{
+  if (size != 0)
+    error (_("Spilling the branch trace to disk is not supported by this "
+	     "build."));
+}
+
+#endif /* !CXX_STD_THREAD */
+
 /* Try to determine the start address of the Linux kernel.  */
 
 static uint64_t
@@ -484,6 +868,21 @@ linux_enable_bts (ptid_t ptid, const struct btrace_config_bts *conf)
   tinfo->attr.exclude_hv = 1;
   tinfo->attr.exclude_idle = 1;
 
+  /* Create the spill ring before we start tracing.  */
+#if CXX_STD_THREAD
+  std::unique_ptr<linux_btrace_spill> spill;
+  if (conf->spill_size != 0)
+    {
+      spill = linux_new_spill (conf->spill_size);
+
+      /* Wake up the spill reader when the buffer is half full.  */
+      tinfo->attr.watermark = 1;
+      tinfo->attr.wakeup_watermark = conf->size / 2;
+    }
+#else
+  linux_check_spill (conf->spill_size);
+#endif /* CXX_STD_THREAD */
+
   pid = ptid.lwp ();
   if (pid == 0)
     pid = ptid.pid ();
@@ -565,6 +964,15 @@ linux_enable_bts (ptid_t ptid, const struct btrace_config_bts *conf)
   tinfo->file = fd.release ();
 
   tinfo->conf.bts.size = (unsigned int) size;
+
+#if CXX_STD_THREAD
+  if (spill != nullptr)
+    {
+      tinfo->conf.bts.spill_size = (unsigned int) spill->ring.size;
+      linux_start_spill (tinfo.get (), std::move (spill));
+    }
+#endif /* CXX_STD_THREAD */
+
   return tinfo.release ();
 }
 
@@ -628,6 +1036,20 @@ linux_enable_pt (ptid_t ptid, const struct btrace_config_pt *conf)
   tinfo->attr.exclude_hv = 1;
   tinfo->attr.exclude_idle = 1;
 
+  /* Create the spill ring before we start tracing.  */
+#if CXX_STD_THREAD
+  std::unique_ptr<linux_btrace_spill> spill;
+  if (conf->spill_size != 0)
+    {
+      spill = linux_new_spill (conf->spill_size);
+
+      /* Wake up the spill reader when the buffer is half full.  */
+      tinfo->attr.aux_watermark = conf->size / 2;
+    }
+#else
+  linux_check_spill (conf->spill_size);
+#endif /* CXX_STD_THREAD */
+
   errno = 0;
   scoped_fd fd (syscall (SYS_perf_event_open, &tinfo->attr, pid, -1, -1, 0));
   if (fd.get () < 0)
@@ -657,6 +1079,14 @@ linux_enable_pt (ptid_t ptid, const struct btrace_config_pt *conf)
     if ((pages & ((size_t) 1 << pg)) != 0)
       pages += ((size_t) 1 << pg);
 
+  /* When spilling, we map the buffer writable so the kernel does not
+     overwrite trace that the spill reader did not copy, yet.  */
+  int prot = PROT_READ;
+#if CXX_STD_THREAD
+  if (spill != nullptr)
+    prot |= PROT_WRITE;
+#endif /* CXX_STD_THREAD */
+
   /* We try to allocate the requested size.
      If that fails, try to get as much as we can.  */
   scoped_mmap aux;
@@ -680,7 +1110,7 @@ linux_enable_pt (ptid_t ptid, const struct btrace_config_pt *conf)
       header->aux_size = data_size;
 
       errno = 0;
-      aux.reset (nullptr, length, PROT_READ, MAP_SHARED, fd.get (),
+      aux.reset (nullptr, length, prot, MAP_SHARED, fd.get (),
 		 header->aux_offset);
       if (aux.get () != MAP_FAILED)
 	break;
@@ -697,6 +1127,15 @@ linux_enable_pt (ptid_t ptid, const struct btrace_config_pt *conf)
   tinfo->file = fd.release ();
 
   tinfo->conf.pt.size = (unsigned int) tinfo->pev.size;
+
+#if CXX_STD_THREAD
+  if (spill != nullptr)
+    {
+      tinfo->conf.pt.spill_size = (unsigned int) spill->ring.size;
+      linux_start_spill (tinfo.get (), std::move (spill));
+    }
+#endif /* CXX_STD_THREAD */
+
   return tinfo.release ();
 }
 
@@ -736,6 +1175,10 @@ linux_enable_btrace (ptid_t ptid, const struct btrace_config *conf)
 static void
 linux_disable_bts (struct linux_btrace_target_info *tinfo)
 {
+#if CXX_STD_THREAD
+  linux_stop_spill (tinfo);
+#endif /* CXX_STD_THREAD */
+
   munmap ((void *) tinfo->header, tinfo->pev.size + PAGE_SIZE);
   close (tinfo->file);
 }
@@ -745,6 +1188,10 @@ linux_disable_bts (struct linux_btrace_target_info *tinfo)
 static void
 linux_disable_pt (struct linux_btrace_target_info *tinfo)
 {
+#if CXX_STD_THREAD
+  linux_stop_spill (tinfo);
+#endif /* CXX_STD_THREAD */
+
   munmap ((void *) tinfo->pev.mem, tinfo->pev.size);
   munmap ((void *) tinfo->header, PAGE_SIZE);
   close (tinfo->file);
@@ -788,19 +1235,20 @@ linux_read_bts (btrace_data_bts *btrace, linux_btrace_target_info *tinfo,
   size_t buffer_size, size;
   __u64 data_head = 0, data_tail;
   unsigned int retries = 5;
+  struct perf_event_buffer *pev = linux_btrace_buffer (tinfo);
 
   /* For delta reads, we return at least the partial last block containing
      the current PC.  */
-  if (type == BTRACE_READ_NEW && !perf_event_new_data (&tinfo->pev))
+  if (type == BTRACE_READ_NEW && !perf_event_new_data (pev))
     return BTRACE_ERR_NONE;
 
-  buffer_size = tinfo->pev.size;
-  data_tail = tinfo->pev.last_head;
+  buffer_size = pev->size;
+  data_tail = pev->last_head;
 
   /* We may need to retry reading the trace.  See below.  */
   while (retries--)
     {
-      data_head = *tinfo->pev.data_head;
+      data_head = *pev->data_head;
 
       /* Delete any leftover trace from the previous iteration.  */
       delete btrace->blocks;
@@ -838,13 +1286,13 @@ linux_read_bts (btrace_data_bts *btrace, linux_btrace_target_info *tinfo,
 	}
 
       /* Data_head keeps growing; the buffer itself is circular.  */
-      begin = tinfo->pev.mem;
+      begin = pev->mem;
       start = begin + data_head % buffer_size;
 
       if (data_head <= buffer_size)
 	end = start;
       else
-	end = begin + tinfo->pev.size;
+	end = begin + pev->size;
 
       btrace->blocks = perf_event_read_bts (tinfo, begin, end, start, size);
 
@@ -853,11 +1301,11 @@ linux_read_bts (btrace_data_bts *btrace, linux_btrace_target_info *tinfo,
 	 kernel might be writing the last branch trace records.
 
 	 Let's check whether the data head moved while we read the trace.  */
-      if (data_head == *tinfo->pev.data_head)
+      if (data_head == *pev->data_head)
 	break;
     }
 
-  tinfo->pev.last_head = data_head;
+  pev->last_head = data_head;
 
   /* Prune the incomplete last block (i.e. the first one of inferior execution)
      if we're not doing a delta read.  There is no way of filling in its zeroed
@@ -893,11 +1341,30 @@ linux_read_pt (btrace_data_pt *btrace, linux_btrace_target_info *tinfo,
       return BTRACE_ERR_NOT_SUPPORTED;
 
     case BTRACE_READ_NEW:
-      if (!perf_event_new_data (&tinfo->pev))
+      if (!perf_event_new_data (linux_btrace_buffer (tinfo)))
 	return BTRACE_ERR_NONE;
 
       /* Fall through.  */
     case BTRACE_READ_ALL:
+#if CXX_STD_THREAD
+      if (tinfo->spill != nullptr)
+	{
+	  /* Unlike aux_head, the spill ring's head does not wrap around.
+	     Don't read the part of the ring that was not written, yet.  */
+	  struct perf_event_buffer *ring = &tinfo->spill->ring;
+	  __u64 data_head = *ring->data_head;
+	  size_t size = ring->size;
+
+	  if (data_head < size)
+	    size = (size_t) data_head;
+
+	  btrace->data = perf_event_read (ring, data_head, size);
+	  btrace->size = size;
+	  ring->last_head = data_head;
+	  return BTRACE_ERR_NONE;
+	}
+#endif /* CXX_STD_THREAD */
+
       perf_event_read_all (&tinfo->pev, &btrace->data, &btrace->size);
       return BTRACE_ERR_NONE;
     }
@@ -915,6 +1382,18 @@ linux_read_btrace (struct btrace_data *btrace,
   linux_btrace_target_info *tinfo
     = get_linux_btrace_target_info (gtinfo);
 
+#if CXX_STD_THREAD
+  /* Copy the newest trace into the spill ring before reading from it.  We
+     hold the lock until we're done so the spill reader does not modify
+     the ring while we read.  */
+  std::unique_lock<std::mutex> lock;
+  if (tinfo->spill != nullptr)
+    {
+      lock = std::unique_lock<std::mutex> (tinfo->spill->mutex);
+      linux_btrace_spill_drain (tinfo);
+    }
+#endif /* CXX_STD_THREAD */
+
   switch (tinfo->conf.format)
     {
     case BTRACE_FORMAT_NONE:
@@ -27,6 +27,11 @@
 #if HAVE_LINUX_PERF_EVENT_H
 #  include <linux/perf_event.h>
 #endif
+#if CXX_STD_THREAD
+#  include <atomic>
+#  include <mutex>
+#  include <thread>
+#endif
 
 struct target_ops;
 
@@ -46,6 +51,41 @@ struct perf_event_buffer
   /* The data_head value from the last read.  */
   __u64 last_head;
 };
+
+#if CXX_STD_THREAD
+/* A bounded ring in an unlinked temporary file that a background thread,
+   shared by all recorded threads, keeps filling with the trace from a
+   perf event buffer while the inferior runs.  The trace is then read
+   from the ring instead of from the perf event buffer, so it reaches
+   back further than the latter.  */
+struct linux_btrace_spill
+{
+  linux_btrace_spill () = default;
+  ~linux_btrace_spill ();
+
+  DISABLE_COPY_AND_ASSIGN (linux_btrace_spill);
+
+  /* The ring file.  */
+  int file = -1;
+
+  /* The mapped ring file.  Its data_head points to HEAD.  */
+  struct perf_event_buffer ring {};
+
+  /* The number of bytes written into the ring so far.  */
+  __u64 head = 0;
+
+  /* The position in the perf event buffer up to which the trace has been
+     copied into the ring.  */
+  __u64 tail = 0;
+
+  /* Serializes copying the trace into the ring and reading it.  */
+  std::mutex mutex;
+
+  /* Whether the traced thread exited, so its perf event file need not
+     be polled anymore.  Only used by the spill reader.  */
+  bool hung_up = false;
+};
+#endif /* CXX_STD_THREAD */
 #endif /* HAVE_LINUX_PERF_EVENT_H */
 
 /* Branch trace target information per thread.  */
@@ -67,6 +107,12 @@ struct linux_btrace_target_info final : public btrace_target_info
 
   /* The perf event buffer containing the trace data.  */
   struct perf_event_buffer pev {};
+
+#if CXX_STD_THREAD
+  /* The ring the trace is spilled to, or NULL if the trace is read
+     directly from PEV.  */
+  struct linux_btrace_spill *spill = nullptr;
+#endif /* CXX_STD_THREAD */
 #endif /* HAVE_LINUX_PERF_EVENT_H */
 };
 
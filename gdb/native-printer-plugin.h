@@ -0,0 +1,268 @@
+/* Native pretty-printer plugin interface for GDB, the GNU debugger.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef GDB_NATIVE_PRINTER_PLUGIN_H
+#define GDB_NATIVE_PRINTER_PLUGIN_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Versioning information.  See gdb_printer_funcs.  */
+
+#define GDB_PRINTER_INTERFACE_VERSION 2
+
+/* Printers must be released under a GPL compatible license.  To
+   declare that the printer is indeed released under a GPL compatible
+   license, invoke the macro GDB_DECLARE_GPL_COMPATIBLE_PRINTER in a
+   source file.  */
+
+#ifdef __cplusplus
+#define GDB_DECLARE_GPL_COMPATIBLE_PRINTER      \
+  extern "C" {                                  \
+  extern int plugin_is_GPL_compatible (void);   \
+  extern int plugin_is_GPL_compatible (void)    \
+  {                                             \
+    return 0;                                   \
+  }                                             \
+  }
+
+#else
+
+#define GDB_DECLARE_GPL_COMPATIBLE_PRINTER      \
+  extern int plugin_is_GPL_compatible (void);   \
+  extern int plugin_is_GPL_compatible (void)    \
+  {                                             \
+    return 0;                                   \
+  }
+
+#endif
+
+/* Represents an address on the target system.  */
+
+typedef unsigned long long GDB_PRINTER_ADDR;
+
+/* Return status codes of the callbacks.  */
+
+enum gdb_printer_status {
+  GDB_PRINTER_FAIL = 0,
+  GDB_PRINTER_SUCCESS = 1
+};
+
+/* Return codes of gdb_printer_print.  */
+
+enum gdb_printer_result {
+  /* The printer does not handle this value; GDB should try other
+     pretty-printers, or print the value itself.  */
+  GDB_PRINTER_NOT_HANDLED = 0,
+
+  /* The value has been printed.  */
+  GDB_PRINTER_HANDLED = 1,
+
+  /* The printer handles this value but could not print it, typically
+     because one of the callbacks failed.  GDB prints the error
+     reported by the first failing callback in place of the value.  */
+  GDB_PRINTER_ERROR = 2
+};
+
+/* Opaque handles on GDB values and types.  A handle passed to the
+   printer, or returned by a callback, is owned by GDB and remains
+   valid until the call into the printer it was obtained in returns.  */
+
+struct gdb_printer_value;
+struct gdb_printer_type;
+
+struct gdb_printer_callbacks;
+
+/* Return the type of VALUE.  Never fails.  */
+
+typedef struct gdb_printer_type *(gdb_printer_value_type)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_value *value);
+
+/* Return the name of TYPE, after resolving typedefs, or NULL if the
+   type has no name.  For C++ class types this is the fully qualified
+   name, including template arguments, as found in the debug
+   information.  The string is owned by GDB.  */
+
+typedef const char *(gdb_printer_type_name)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_type *type);
+
+/* Return the size of TYPE in bytes.  */
+
+typedef unsigned long long (gdb_printer_type_sizeof)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_type *type);
+
+/* Return the member called NAME of the struct or union VALUE, or NULL
+   on failure.  Base classes are searched too.  */
+
+typedef struct gdb_printer_value *(gdb_printer_value_field)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_value *value,
+   const char *name);
+
+/* Return the value VALUE points to, or NULL on failure.  */
+
+typedef struct gdb_printer_value *(gdb_printer_value_dereference)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_value *value);
+
+/* Return element INDEX of the array or pointer VALUE, as with the C
+   expression VALUE[INDEX], or NULL on failure.  */
+
+typedef struct gdb_printer_value *(gdb_printer_value_subscript)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_value *value,
+   long long index);
+
+/* Store the value of the scalar VALUE, converted to an integer, in
+   *RESULT.  Pointers are converted to their address.  */
+
+typedef enum gdb_printer_status (gdb_printer_value_as_long)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_value *value,
+   long long *result);
+
+/* Store the address of VALUE in *RESULT.  Fails if VALUE is not in
+   memory.  */
+
+typedef enum gdb_printer_status (gdb_printer_value_address)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_value *value,
+   GDB_PRINTER_ADDR *result);
+
+/* Read LEN bytes at ADDR in the inferior's memory into BUF.  */
+
+typedef enum gdb_printer_status (gdb_printer_read_memory)
+  (struct gdb_printer_callbacks *cb, GDB_PRINTER_ADDR addr, void *buf,
+   unsigned long long len);
+
+/* Print TEXT verbatim.  */
+
+typedef void (gdb_printer_print_text)
+  (struct gdb_printer_callbacks *cb, const char *text);
+
+/* Print VALUE the way GDB would print it at the current nesting
+   level, including applying pretty-printers to it.  */
+
+typedef enum gdb_printer_status (gdb_printer_print_value)
+  (struct gdb_printer_callbacks *cb, struct gdb_printer_value *value);
+
+/* Return the maximum number of elements of an aggregate the user
+   wants printed ("set print elements"), or 0 if there is no limit.  */
+
+typedef unsigned int (gdb_printer_print_elements)
+  (struct gdb_printer_callbacks *cb);
+
+/* Report a child called NAME whose value is VALUE.  Only valid in a
+   call to gdb_printer_children; GDB keeps its own reference to VALUE
+   and copies NAME.  */
+
+typedef enum gdb_printer_status (gdb_printer_add_child)
+  (struct gdb_printer_callbacks *cb, const char *name,
+   struct gdb_printer_value *value);
+
+/* The callbacks passed to gdb_printer_print.  */
+
+struct gdb_printer_callbacks
+{
+  gdb_printer_value_type *value_type;
+  gdb_printer_type_name *type_name;
+  gdb_printer_type_sizeof *type_sizeof;
+  gdb_printer_value_field *value_field;
+  gdb_printer_value_dereference *value_dereference;
+  gdb_printer_value_subscript *value_subscript;
+  gdb_printer_value_as_long *value_as_long;
+  gdb_printer_value_address *value_address;
+  gdb_printer_read_memory *read_memory;
+  gdb_printer_print_text *print_text;
+  gdb_printer_print_value *print_value;
+  gdb_printer_print_elements *print_elements;
+  gdb_printer_add_child *add_child;
+
+  /* For internal use by GDB.  */
+  void *priv_data;
+};
+
+struct gdb_printer_funcs;
+
+/* Print VALUE using the callbacks in CB, or decline to.  This is
+   called for every value GDB prints, before any Python or Guile
+   pretty-printer is tried, unless raw printing was requested.  It
+   must therefore decide quickly whether it handles VALUE, usually
+   from the name of its type.  */
+
+typedef enum gdb_printer_result (gdb_printer_print)
+  (struct gdb_printer_funcs *self, struct gdb_printer_callbacks *cb,
+   struct gdb_printer_value *value);
+
+/* Free SELF and any associated data.  Called when the printer is
+   unloaded.  */
+
+typedef void (gdb_destroy_printer) (struct gdb_printer_funcs *self);
+
+/* If the printer provides the children of VALUE, store their number in
+   *RESULT and return GDB_PRINTER_HANDLED.  Return
+   GDB_PRINTER_NOT_HANDLED to let GDB list the children of VALUE
+   itself.  This is called whenever a GDB/MI variable object takes a
+   new value, so it must decide as quickly as gdb_printer_print.  */
+
+typedef enum gdb_printer_result (gdb_printer_num_children)
+  (struct gdb_printer_funcs *self, struct gdb_printer_callbacks *cb,
+   struct gdb_printer_value *value, unsigned long long *result);
+
+/* Report the children of VALUE numbered START to START + COUNT - 1,
+   in order, by calling CB->add_child for each of them.  START and
+   COUNT are within the number returned by gdb_printer_num_children.
+   Reporting fewer than COUNT children ends the list.  Text printed
+   with CB->print_text or CB->print_value is discarded.  */
+
+typedef enum gdb_printer_result (gdb_printer_children)
+  (struct gdb_printer_funcs *self, struct gdb_printer_callbacks *cb,
+   struct gdb_printer_value *value, unsigned long long start,
+   unsigned long long count);
+
+/* Called when the printer is loaded.  Must be defined by the printer
+   shared object and return the printer's gdb_printer_funcs.  */
+
+extern struct gdb_printer_funcs *gdb_init_printer (void);
+
+/* Pointer to the functions which implement the printer's
+   functionality.  The individual functions have been documented
+   above.
+
+   None of the fields are optional.  Later versions of this interface
+   only add fields after DESTROY, so that GDB can release a printer
+   whose version it does not support.  */
+
+struct gdb_printer_funcs
+{
+  /* Must be set to GDB_PRINTER_INTERFACE_VERSION.  */
+  int printer_version;
+
+  /* For use by the printer.  */
+  void *priv_data;
+
+  gdb_printer_print *print;
+  gdb_destroy_printer *destroy;
+
+  /* Added in version 2.  */
+  gdb_printer_num_children *num_children;
+  gdb_printer_children *children;
+};
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
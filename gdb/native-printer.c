@@ -0,0 +1,702 @@
+/* Native pretty-printer plugins for GDB, the GNU debugger.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Native pretty-printers are shared objects, written against the
+   interface in native-printer-plugin.h, that GDB loads with dlopen and
+   calls directly for every value it prints, before the Python and
+   Guile pretty-printers.  Values and types are handed to the plugin as
+   opaque handles, which it inspects through callbacks.  */
+
+#include "defs.h"
+#include "native-printer.h"
+#include "native-printer-plugin.h"
+#include "cli/cli-style.h"
+#include "command.h"
+#include "completer.h"
+#include "gdbcmd.h"
+#include "gdbcore.h"
+#include "gdbtypes.h"
+#include "language.h"
+#include "valprint.h"
+#include "value.h"
+#include "varobj-iter.h"
+#include "gdbsupport/gdb-dlfcn.h"
+#include "readline/tilde.h"
+#include <list>
+
+/* A native pretty-printer plugin that has been loaded successfully.  */
+
+struct native_printer
+{
+  native_printer (std::string &&name, struct gdb_printer_funcs *f,
+		  gdb_dlhandle_up &&h)
+    : file_name (std::move (name)), functions (f), handle (std::move (h))
+  {
+  }
+
+  ~native_printer ()
+  {
+    functions->destroy (functions);
+  }
+
+  DISABLE_COPY_AND_ASSIGN (native_printer);
+
+  /* The file the plugin was loaded from.  */
+  std::string file_name;
+
+  struct gdb_printer_funcs *functions;
+  gdb_dlhandle_up handle;
+};
+
+/* The loaded plugins, in the order they were loaded, which is also the
+   order in which they are tried.  */
+
+static std::list<native_printer> native_printers;
+
+typedef struct gdb_printer_funcs * (printer_init_fn_type) (void);
+static const char printer_init_fn_sym[] = "gdb_init_printer";
+
+/* The state of one call to the print function of a plugin.  The
+   callbacks find it through their priv_data.  */
+
+struct native_print_state
+{
+  struct ui_file *stream;
+  int recurse;
+  const struct value_print_options *options;
+  const struct language_defn *language;
+
+  /* The values handed to the plugin.  They are kept alive until the
+     print function returns.  */
+  std::vector<value_ref_ptr> values;
+
+  /* Where native_printer_add_child stores the children the plugin
+     reports, or NULL outside of a call to its children function.  */
+  std::vector<std::unique_ptr<varobj_item>> *children = nullptr;
+
+  /* The exception thrown in the first failing callback, if any.  */
+  gdb_exception error;
+};
+
+/* Return the state of the print call CB was passed to.  */
+
+static native_print_state *
+get_print_state (struct gdb_printer_callbacks *cb)
+{
+  return (native_print_state *) cb->priv_data;
+}
+
+/* Conversions between GDB's values and types and the plugin's
+   handles.  */
+
+static struct value *
+unwrap_value (struct gdb_printer_value *value)
+{
+  return (struct value *) value;
+}
+
+static struct gdb_printer_value *
+wrap_value (struct gdb_printer_callbacks *cb, struct value *val)
+{
+  get_print_state (cb)->values.push_back (value_ref_ptr::new_reference (val));
+  return (struct gdb_printer_value *) val;
+}
+
+static struct type *
+unwrap_type (struct gdb_printer_type *type)
+{
+  return (struct type *) type;
+}
+
+/* Remember EX as the reason a callback of CB failed, unless an earlier
+   callback already failed.  */
+
+static void
+record_callback_error (struct gdb_printer_callbacks *cb,
+		       const gdb_exception &ex)
+{
+  native_print_state *state = get_print_state (cb);
+
+  if (state->error.reason == 0)
+    state->error = ex;
+}
+
+/* The callbacks.  None of them may let an exception escape into the
+   plugin; see native-printer-plugin.h for their documentation.  */
+
+static struct gdb_printer_type *
+native_printer_value_type (struct gdb_printer_callbacks *cb,
+			   struct gdb_printer_value *value)
+{
+  return (struct gdb_printer_type *) unwrap_value (value)->type ();
+}
+
+static const char *
+native_printer_type_name (struct gdb_printer_callbacks *cb,
+			  struct gdb_printer_type *type)
+{
+  try
+    {
+      return check_typedef (unwrap_type (type))->name ();
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return nullptr;
+}
+
+static unsigned long long
+native_printer_type_sizeof (struct gdb_printer_callbacks *cb,
+			    struct gdb_printer_type *type)
+{
+  try
+    {
+      return check_typedef (unwrap_type (type))->length ();
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return 0;
+}
+
+static struct gdb_printer_value *
+native_printer_value_field (struct gdb_printer_callbacks *cb,
+			    struct gdb_printer_value *value,
+			    const char *name)
+{
+  try
+    {
+      struct value *val = unwrap_value (value);
+      struct value *field = value_struct_elt (&val, {}, name, nullptr,
+					      "struct/class/union");
+      return wrap_value (cb, field);
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return nullptr;
+}
+
+static struct gdb_printer_value *
+native_printer_value_dereference (struct gdb_printer_callbacks *cb,
+				  struct gdb_printer_value *value)
+{
+  try
+    {
+      return wrap_value (cb, value_ind (unwrap_value (value)));
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return nullptr;
+}
+
+static struct gdb_printer_value *
+native_printer_value_subscript (struct gdb_printer_callbacks *cb,
+				struct gdb_printer_value *value,
+				long long index)
+{
+  try
+    {
+      return wrap_value (cb, value_subscript (unwrap_value (value), index));
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return nullptr;
+}
+
+static enum gdb_printer_status
+native_printer_value_as_long (struct gdb_printer_callbacks *cb,
+			      struct gdb_printer_value *value,
+			      long long *result)
+{
+  try
+    {
+      *result = value_as_long (unwrap_value (value));
+      return GDB_PRINTER_SUCCESS;
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return GDB_PRINTER_FAIL;
+}
+
+static enum gdb_printer_status
+native_printer_value_address (struct gdb_printer_callbacks *cb,
+			      struct gdb_printer_value *value,
+			      GDB_PRINTER_ADDR *result)
+{
+  struct value *val = unwrap_value (value);
+
+  if (val->lval () != lval_memory)
+    return GDB_PRINTER_FAIL;
+
+  *result = val->address ();
+  return GDB_PRINTER_SUCCESS;
+}
+
+static enum gdb_printer_status
+native_printer_read_memory (struct gdb_printer_callbacks *cb,
+			    GDB_PRINTER_ADDR addr, void *buf,
+			    unsigned long long len)
+{
+  try
+    {
+      read_memory (addr, (gdb_byte *) buf, len);
+      return GDB_PRINTER_SUCCESS;
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return GDB_PRINTER_FAIL;
+}
+
+static void
+native_printer_print_text (struct gdb_printer_callbacks *cb,
+			   const char *text)
+{
+  try
+    {
+      gdb_puts (text, get_print_state (cb)->stream);
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+}
+
+static enum gdb_printer_status
+native_printer_print_value (struct gdb_printer_callbacks *cb,
+			    struct gdb_printer_value *value)
+{
+  native_print_state *state = get_print_state (cb);
+
+  try
+    {
+      common_val_print (unwrap_value (value), state->stream,
+			state->recurse + 1, state->options, state->language);
+      return GDB_PRINTER_SUCCESS;
+    }
+  catch (const gdb_exception &ex)
+    {
+      record_callback_error (cb, ex);
+    }
+
+  return GDB_PRINTER_FAIL;
+}
+
+static unsigned int
+native_printer_print_elements (struct gdb_printer_callbacks *cb)
+{
+  unsigned int print_max = get_print_state (cb)->options->print_max;
+
+  return print_max == UINT_MAX ? 0 : print_max;
+}
+
+static enum gdb_printer_status
+native_printer_add_child (struct gdb_printer_callbacks *cb,
+			  const char *name, struct gdb_printer_value *value)
+{
+  native_print_state *state = get_print_state (cb);
+
+  if (state->children == nullptr || name == nullptr || value == nullptr)
+    return GDB_PRINTER_FAIL;
+
+  std::unique_ptr<varobj_item> item (new varobj_item ());
+  item->name = name;
+  item->value = release_value (unwrap_value (value));
+  state->children->push_back (std::move (item));
+  return GDB_PRINTER_SUCCESS;
+}
+
+/* One call into a plugin: the state the callbacks work on, and the
+   callbacks themselves.  */
+
+struct native_printer_call
+{
+  native_printer_call (struct ui_file *stream, int recurse,
+		       const struct value_print_options *options,
+		       const struct language_defn *language)
+  {
+    state.stream = stream;
+    state.recurse = recurse;
+    state.options = options;
+    state.language = language;
+
+    cb.value_type = native_printer_value_type;
+    cb.type_name = native_printer_type_name;
+    cb.type_sizeof = native_printer_type_sizeof;
+    cb.value_field = native_printer_value_field;
+    cb.value_dereference = native_printer_value_dereference;
+    cb.value_subscript = native_printer_value_subscript;
+    cb.value_as_long = native_printer_value_as_long;
+    cb.value_address = native_printer_value_address;
+    cb.read_memory = native_printer_read_memory;
+    cb.print_text = native_printer_print_text;
+    cb.print_value = native_printer_print_value;
+    cb.print_elements = native_printer_print_elements;
+    cb.add_child = native_printer_add_child;
+    cb.priv_data = &state;
+  }
+
+  DISABLE_COPY_AND_ASSIGN (native_printer_call);
+
+  /* Don't let the plugin swallow a Ctrl-C.  Call this once the plugin
+     has returned.  */
+
+  void check_quit ()
+  {
+    if (state.error.reason == RETURN_QUIT
+	|| state.error.reason == RETURN_FORCED_QUIT)
+      throw_exception (std::move (state.error));
+  }
+
+  /* The reason the call failed, for a call that returned
+     GDB_PRINTER_ERROR.  */
+
+  const char *error_message () const
+  {
+    if (state.error.reason == 0)
+      return _("unknown error");
+    return state.error.what ();
+  }
+
+  native_print_state state;
+  struct gdb_printer_callbacks cb;
+};
+
+/* See native-printer.h.  */
+
+enum ext_lang_rc
+apply_native_val_pretty_printer (struct value *val,
+				 struct ui_file *stream, int recurse,
+				 const struct value_print_options *options,
+				 const struct language_defn *language)
+{
+  for (native_printer &printer : native_printers)
+    {
+      native_printer_call call (stream, recurse, options, language);
+
+      enum gdb_printer_result result
+	= printer.functions->print (printer.functions, &call.cb,
+				    (struct gdb_printer_value *) val);
+      call.check_quit ();
+
+      switch (result)
+	{
+	case GDB_PRINTER_HANDLED:
+	  return EXT_LANG_RC_OK;
+
+	case GDB_PRINTER_ERROR:
+	  if (call.state.error.reason == 0)
+	    fprintf_styled (stream, metadata_style.style (),
+			    _("<error printing value>"));
+	  else
+	    fprintf_styled (stream, metadata_style.style (),
+			    _("<error printing value: %s>"),
+			    call.state.error.what ());
+	  return EXT_LANG_RC_OK;
+
+	default:
+	  break;
+	}
+    }
+
+  return EXT_LANG_RC_NOP;
+}
+
+/* Ask the plugins, in order, for the number of children of VAL.
+   Return the first plugin providing them and store their number in
+   *COUNT, or return NULL if no plugin provides them.  A plugin failing
+   to count the children still provides them: *COUNT is then set to 0
+   and the reason of the failure stored in *REASON, which is otherwise
+   left empty.  */
+
+static native_printer *
+native_printer_num_children (struct value *val,
+			     const struct value_print_options *options,
+			     unsigned long long *count, std::string *reason)
+{
+  for (native_printer &printer : native_printers)
+    {
+      native_printer_call call (&null_stream, 0, options, current_language);
+
+      *count = 0;
+      enum gdb_printer_result result
+	= printer.functions->num_children (printer.functions, &call.cb,
+					   (struct gdb_printer_value *) val,
+					   count);
+      call.check_quit ();
+
+      if (result == GDB_PRINTER_NOT_HANDLED)
+	continue;
+
+      reason->clear ();
+      if (result == GDB_PRINTER_ERROR)
+	{
+	  *count = 0;
+	  *reason = call.error_message ();
+	}
+      return &printer;
+    }
+
+  return nullptr;
+}
+
+/* See native-printer.h.  */
+
+bool
+native_printer_has_children (struct value *val,
+			     const struct value_print_options *options)
+{
+  unsigned long long count;
+  std::string reason;
+
+  return (native_printer_num_children (val, options, &count, &reason)
+	  != nullptr);
+}
+
+/* How many children native_varobj_iter requests from the plugin at a
+   time.  Asking for one child at a time would make printers of linked
+   structures walk them from the start for every child.  */
+
+static const unsigned long long native_children_batch = 64;
+
+/* A dynamic varobj iterator over the children a native pretty-printer
+   provides.  The plugin is looked up again for every batch, so that
+   the iterator ends if the plugin is unloaded.  Like the Python one, it
+   ends with a warning if the plugin fails.  */
+
+struct native_varobj_iter : public varobj_iter
+{
+  native_varobj_iter (struct value *val,
+		      const struct value_print_options *options)
+    : m_value (value_ref_ptr::new_reference (val)),
+      m_options (*options)
+  {
+  }
+
+  std::unique_ptr<varobj_item> next () override;
+
+private:
+
+  /* The value whose children are listed.  */
+  value_ref_ptr m_value;
+
+  /* The print options to use.  */
+  value_print_options m_options;
+
+  /* The number of the first child of the next batch.  */
+  unsigned long long m_next_child = 0;
+
+  /* The current batch, and the index in it of the next item.  */
+  std::vector<std::unique_ptr<varobj_item>> m_batch;
+  size_t m_next_item = 0;
+};
+
+std::unique_ptr<varobj_item>
+native_varobj_iter::next ()
+{
+  if (m_next_item == m_batch.size ())
+    {
+      m_batch.clear ();
+      m_next_item = 0;
+
+      unsigned long long count;
+      std::string count_error;
+      native_printer *printer
+	= native_printer_num_children (m_value.get (), &m_options, &count,
+				       &count_error);
+      if (!count_error.empty ())
+	{
+	  warning (_("Native printer failed to count children: %s"),
+		   count_error.c_str ());
+	  return nullptr;
+	}
+      if (printer == nullptr || m_next_child >= count)
+	return nullptr;
+
+      native_printer_call call (&null_stream, 0, &m_options,
+				current_language);
+      call.state.children = &m_batch;
+
+      struct gdb_printer_value *val
+	= (struct gdb_printer_value *) m_value.get ();
+      enum gdb_printer_result result
+	= printer->functions->children (printer->functions, &call.cb, val,
+					m_next_child,
+					std::min (count - m_next_child,
+						  native_children_batch));
+      call.check_quit ();
+
+      if (result == GDB_PRINTER_ERROR)
+	{
+	  warning (_("Native printer failed to list children: %s"),
+		   call.error_message ());
+	  m_batch.clear ();
+	  return nullptr;
+	}
+
+      if (m_batch.empty ())
+	return nullptr;
+      m_next_child += m_batch.size ();
+    }
+
+  return std::move (m_batch[m_next_item++]);
+}
+
+/* See native-printer.h.  */
+
+std::unique_ptr<varobj_iter>
+native_printer_get_children_iterator (struct value *val,
+				      const struct value_print_options *options)
+{
+  if (val == nullptr)
+    return nullptr;
+
+  return gdb::make_unique<native_varobj_iter> (val, options);
+}
+
+/* Try to load FILE_NAME as a native pretty-printer.  */
+
+static void
+native_printer_load (std::string &&file_name)
+{
+  gdb_dlhandle_up so = gdb_dlopen (file_name.c_str ());
+
+  printer_init_fn_type *init_fn
+    = (printer_init_fn_type *) gdb_dlsym (so, printer_init_fn_sym);
+  if (init_fn == nullptr)
+    error (_("Could not locate initialization function: %s."),
+	   printer_init_fn_sym);
+
+  if (gdb_dlsym (so, "plugin_is_GPL_compatible") == nullptr)
+    error (_("Printer not GPL compatible."));
+
+  struct gdb_printer_funcs *funcs = init_fn ();
+  if (funcs == nullptr)
+    error (_("Printer initialization failed."));
+  if (funcs->printer_version != GDB_PRINTER_INTERFACE_VERSION)
+    {
+      funcs->destroy (funcs);
+      error (_("Printer version does not match GDB version."));
+    }
+
+  native_printers.emplace_back (std::move (file_name), funcs, std::move (so));
+}
+
+/* Provides the native-printer-load command.  */
+
+static void
+native_printer_load_command (const char *args, int from_tty)
+{
+  if (args == nullptr)
+    error (_("No printer name provided."));
+  gdb::unique_xmalloc_ptr<char> file (tilde_expand (args));
+
+  for (const native_printer &printer : native_printers)
+    if (printer.file_name == file.get ())
+      error (_("Native printer %s is already loaded."), file.get ());
+
+  native_printer_load (file.get ());
+}
+
+/* Provides the native-printer-unload command.  */
+
+static void
+native_printer_unload_command (const char *args, int from_tty)
+{
+  if (args == nullptr)
+    error (_("No printer name provided."));
+  gdb::unique_xmalloc_ptr<char> file (tilde_expand (args));
+
+  for (auto iter = native_printers.begin ();
+       iter != native_printers.end ();
+       ++iter)
+    if (iter->file_name == file.get ())
+      {
+	native_printers.erase (iter);
+	return;
+      }
+
+  error (_("No native printer %s loaded."), file.get ());
+}
+
+/* Provides the "info native-printers" command.  */
+
+static void
+info_native_printers_command (const char *args, int from_tty)
+{
+  if (native_printers.empty ())
+    {
+      gdb_printf (_("No native printers loaded.\n"));
+      return;
+    }
+
+  int index = 1;
+  for (const native_printer &printer : native_printers)
+    gdb_printf ("%d: %ps\n", index++,
+		styled_string (file_name_style.style (),
+			       printer.file_name.c_str ()));
+}
+
+void _initialize_native_printer ();
+void
+_initialize_native_printer ()
+{
+  if (is_dl_available ())
+    {
+      struct cmd_list_element *c;
+
+      c = add_com ("native-printer-load", no_class,
+		   native_printer_load_command, _("\
+Load FILE as a native pretty-printer.\n\
+Usage: native-printer-load FILE\n\
+Load the shared object FILE, which implements the interface of\n\
+native-printer-plugin.h.  Native pretty-printers are tried in the order\n\
+they were loaded, before any Python or Guile pretty-printer."));
+      set_cmd_completer (c, filename_completer);
+
+      c = add_com ("native-printer-unload", no_class,
+		   native_printer_unload_command, _("\
+Unload a native pretty-printer.\n\
+Usage: native-printer-unload FILE\n\n\
+Do \"help native-printer-load\" for info on loading native printers."));
+      set_cmd_completer (c, filename_completer);
+
+      add_info ("native-printers", info_native_printers_command, _("\
+List the loaded native pretty-printers.\n\
+Usage: info native-printers"));
+    }
+}
@@ -0,0 +1,51 @@
+/* Native pretty-printer plugins for GDB, the GNU debugger.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef NATIVE_PRINTER_H
+#define NATIVE_PRINTER_H
+
+#include "extension.h"
+
+struct varobj_iter;
+
+/* Try the native pretty-printer plugins loaded with
+   "native-printer-load" on VAL, in the order they were loaded.  This
+   has the same contract as the apply_val_pretty_printer method of
+   extension_language_ops: return EXT_LANG_RC_OK if VAL was printed,
+   EXT_LANG_RC_NOP if no plugin handles it.  */
+
+extern enum ext_lang_rc apply_native_val_pretty_printer
+  (struct value *val, struct ui_file *stream, int recurse,
+   const struct value_print_options *options,
+   const struct language_defn *language);
+
+/* Return true if one of the native pretty-printer plugins provides the
+   children of VAL.  OPTIONS are the print options in effect.  */
+
+extern bool native_printer_has_children
+  (struct value *val, const struct value_print_options *options);
+
+/* Return an iterator over the children of VAL, as listed by the first
+   native pretty-printer plugin providing them, for a dynamic varobj.
+   The children are requested from the plugin in batches.  */
+
+extern std::unique_ptr<varobj_iter> native_printer_get_children_iterator
+  (struct value *val, const struct value_print_options *options);
+
+#endif /* NATIVE_PRINTER_H */
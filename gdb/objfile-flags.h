@@ -60,6 +60,12 @@ enum objfile_flag : unsigned
     /* User requested that we do not read this objfile's symbolic
        information.  */
     OBJF_READNEVER = 1 << 6,
+
+    /* Set if the partial symtabs of this objfile are read in the
+       background (see "set solib-background-read").  Until they have
+       been read, lookups made while DEFER_BACKGROUND_SYMBOL_READS is
+       set only see the minimal symbols of this objfile.  */
+    OBJF_PSYMTABS_DEFERRED = 1 << 7,
   };
 
 DEF_ENUM_FLAGS_TYPE (enum objfile_flag, objfile_flags);
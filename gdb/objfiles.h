@@ -404,6 +404,12 @@ struct obj_section
   int ovly_mapped;
 };
 
+/* While true, objfiles marked with OBJF_PSYMTABS_DEFERRED whose
+   partial symtabs have not been read yet are treated as having no
+   debug information, rather than being read on demand.  */
+
+extern bool defer_background_symbol_reads;
+
 /* Master structure for keeping track of each file from which
    gdb reads symbols.  There are several ways these get allocated: 1.
    The main symbol file, symfile_objfile, set by the symbol-file command,
@@ -703,6 +709,14 @@ struct objfile
   const std::forward_list<quick_symbol_functions_up> &
   qf_require_partial_symbols ()
   {
+    if (defer_background_symbol_reads
+	&& ((flags & (OBJF_PSYMTABS_DEFERRED | OBJF_PSYMTABS_READ))
+	    == OBJF_PSYMTABS_DEFERRED))
+      {
+	static const std::forward_list<quick_symbol_functions_up> none;
+	return none;
+      }
+
     this->require_partial_symbols (true);
     return qf;
   }
@@ -1251,6 +1251,12 @@ print_value (value *val, const value_print_options &opts)
 
   int histindex = val->record_latest ();
 
+  /* A large value may have been recorded without being read, see
+     value::record_latest.  Print from a copy then, so that reading its
+     contents while printing does not fill the value of the history.  */
+  if (val->lazy ())
+    val = val->copy ();
+
   annotate_value_history_begin (histindex, val->type ());
 
   gdb_printf ("$%d = ", histindex);
@@ -138,7 +138,7 @@ def check_stack_frame(
     }
 
 
-@request("stackTrace")
+@request("stackTrace", read_only=True)
 @capability("supportsDelayedStackTraceLoading")
 def stacktrace(
     *, levels: int = 0, startFrame: int = 0, threadId: int, format=None, **extra
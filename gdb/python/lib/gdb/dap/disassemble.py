@@ -43,7 +43,7 @@ def _disassemble(pc, skip_insns, count):
     }
 
 
-@request("disassemble")
+@request("disassemble", read_only=True)
 @capability("supportsDisassembleRequest")
 def disassemble(
     *,
@@ -114,7 +114,7 @@ def _variables(ref, start, count, value_format):
         return [x.to_object() for x in children]
 
 
-@request("variables")
+@request("variables", read_only=True)
 # Note that we ignore the 'filter' field.  That seems to be
 # specific to javascript.
 def variables(
@@ -20,11 +20,13 @@ from .startup import start_thread, send_gdb, log
 
 def read_json(stream):
     """Read a JSON-RPC message from STREAM.
-    The decoded object is returned."""
+    The decoded object is returned, or None at end of file."""
     # First read and parse the header.
     content_length = None
     while True:
         line = stream.readline()
+        if line == b"":
+            return None
         line = line.strip()
         if line == b"":
             break
@@ -41,7 +41,7 @@ def _find_lines(source, start_line, end_line):
 # This points out that fixing this would be an incompatibility but
 # goes on to propose "if arguments property is missing, debug adapters
 # should return an error".
-@request("breakpointLocations")
+@request("breakpointLocations", read_only=True)
 @capability("supportsBreakpointLocationsRequest")
 def breakpoint_locations(*, source, line: int, endLine: Optional[int] = None, **extra):
     if endLine is None:
@@ -19,7 +19,7 @@ import gdb
 from .server import request, capability
 
 
-@request("readMemory")
+@request("readMemory", read_only=True)
 @capability("supportsReadMemoryRequest")
 def read_memory(*, memoryReference: str, offset: int = 0, count: int, **extra):
     addr = int(memoryReference, 0) + offset
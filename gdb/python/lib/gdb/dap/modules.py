@@ -61,6 +61,6 @@ def _modules(start, count):
 
 
 @capability("supportsModulesRequest")
-@request("modules")
+@request("modules", read_only=True)
 def modules(*, startModule: int = 0, moduleCount: int = 0, **args):
     return _modules(startModule, moduleCount)
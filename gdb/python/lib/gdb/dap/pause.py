@@ -17,6 +17,6 @@ from .events import StopKinds, exec_and_expect_stop
 from .server import request
 
 
-@request("pause", response=False, expect_stopped=False)
+@request("pause", response=False, expect_stopped=False, control=True)
 def pause(**args):
     exec_and_expect_stop("interrupt -a", StopKinds.PAUSE)
@@ -131,6 +131,6 @@ def _get_scope(id):
     return [x.to_object() for x in scopes]
 
 
-@request("scopes")
+@request("scopes", read_only=True)
 def scopes(*, frameId: int, **extra):
     return {"scopes": _get_scope(frameId)}
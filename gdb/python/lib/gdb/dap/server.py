@@ -13,11 +13,14 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+import collections
 import functools
+import gdb
 import inspect
 import json
 import queue
 import sys
+import threading
 
 from .io import start_json_writer, read_json
 from .startup import (
@@ -39,10 +42,156 @@ _capabilities = {}
 # Map command names to callables.
 _commands = {}
 
+# Map the names of read-only commands to the callables to invoke in
+# the gdb thread.  See the READ_ONLY parameter of 'request'.
+_read_only_commands = {}
+
+# The names of the control commands.  See the CONTROL parameter of
+# 'request'.
+_control_commands = set()
+
 # The global server.
 _server = None
 
 
+class _Canceller:
+    """Keep track of the requests the client asked to cancel.
+
+    A request that was not started yet is simply not run.  A request
+    that is running in the gdb thread is interrupted, as if the user
+    had typed Ctrl-C."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        # The sequence numbers of the requests that were read and not
+        # answered yet.
+        self.known = set()
+        # The sequence numbers of the requests to cancel that were not
+        # started yet.
+        self.pending = set()
+        # The sequence number of the request running in the gdb
+        # thread, if any.
+        self.in_flight = None
+        # Whether the request running in the gdb thread was
+        # interrupted because it was cancelled.
+        self.interrupted = False
+
+    def add(self, seq):
+        """Note that the request whose sequence number is SEQ was read.
+        This may be called from any thread."""
+        with self.lock:
+            self.known.add(seq)
+
+    def remove(self, seq):
+        """Note that the request whose sequence number is SEQ was
+        answered.  This may be called from any thread."""
+        with self.lock:
+            self.known.discard(seq)
+            self.pending.discard(seq)
+
+    def cancel(self, seq):
+        """Cancel the request whose sequence number is SEQ.  Requests
+        that were already answered, or never sent, are ignored.
+        This may be called from any thread."""
+        with self.lock:
+            if self.in_flight == seq:
+                self.interrupted = True
+                gdb.interrupt()
+            elif seq in self.known:
+                self.pending.add(seq)
+
+    def is_cancelled(self, seq):
+        """Return True, and forget about SEQ, if the request whose
+        sequence number is SEQ was cancelled before being started."""
+        with self.lock:
+            if seq in self.pending:
+                self.pending.remove(seq)
+                return True
+            return False
+
+    @in_gdb_thread
+    def start(self, seq):
+        """Note that the request whose sequence number is SEQ is about
+        to run in the gdb thread.  Return False if it was cancelled
+        already."""
+        with self.lock:
+            if seq in self.pending:
+                self.pending.remove(seq)
+                return False
+            self.in_flight = seq
+            self.interrupted = False
+            return True
+
+    @in_gdb_thread
+    def done(self):
+        """Note that the request running in the gdb thread is done.
+        Return True if it was interrupted because it was cancelled."""
+        with self.lock:
+            self.in_flight = None
+            interrupted = self.interrupted
+            self.interrupted = False
+        if interrupted:
+            # The request may have completed before noticing the
+            # interrupt, don't let it hit whatever runs next.
+            gdb._clear_interrupt()
+        return interrupted
+
+
+class _RequestQueue:
+    """The requests read from the client and not yet handled.
+
+    Requests are handled in the order they are read, except that a
+    control request overtakes the read-only requests queued before
+    it.  Since these do not change any state, the client cannot tell
+    the difference, other than by getting the answer to the control
+    request sooner."""
+
+    def __init__(self):
+        self.cond = threading.Condition()
+        self.requests = collections.deque()
+        # Whether no more requests will be put in the queue.
+        self.closed = False
+
+    def close(self):
+        """Note that no more requests will be put in the queue."""
+        with self.cond:
+            self.closed = True
+            self.cond.notify()
+
+    def put(self, request):
+        with self.cond:
+            if request["command"] in _control_commands:
+                index = len(self.requests)
+                while (
+                    index > 0
+                    and self.requests[index - 1]["command"] in _read_only_commands
+                ):
+                    index -= 1
+                self.requests.insert(index, request)
+            else:
+                self.requests.append(request)
+            self.cond.notify()
+
+    def get_batch(self):
+        """Wait for a request and return it.  If it is read-only,
+        return all the read-only requests that immediately follow it
+        in the queue as well.  The result is a list, which is empty
+        if the queue is closed and there are no more requests."""
+        with self.cond:
+            while len(self.requests) == 0:
+                if self.closed:
+                    return []
+                self.cond.wait()
+            result = [self.requests.popleft()]
+            if result[0]["command"] in _read_only_commands:
+                while (
+                    len(self.requests) > 0
+                    and self.requests[0]["command"] in _read_only_commands
+                ):
+                    result.append(self.requests.popleft())
+            return result
+
+
 class Server:
     """The DAP server class."""
 
@@ -58,15 +207,19 @@ class Server:
             self.write_queue = queue.Queue()
         else:
             self.write_queue = queue.SimpleQueue()
+        # Requests are read in a separate thread as well, so that a
+        # request can be cancelled while an earlier one is running.
+        self.read_queue = _RequestQueue()
+        self.canceller = _Canceller()
         self.done = False
         global _server
         _server = self
 
-    # Treat PARAMS as a JSON-RPC request and perform its action.
-    # PARAMS is just a dictionary from the JSON.
-    @in_dap_thread
-    def _handle_command(self, params):
-        # We don't handle 'cancel' for now.
+    # Treat PARAMS as a JSON-RPC request and perform its action,
+    # calling FUNC with the request's arguments.  PARAMS is just a
+    # dictionary from the JSON.  This is called in the thread FUNC
+    # must run in.
+    def _run_command(self, params, func):
         result = {
             "request_seq": params["seq"],
             "type": "response",
@@ -77,8 +230,7 @@ class Server:
                 args = params["arguments"]
             else:
                 args = {}
-            global _commands
-            body = _commands[params["command"]](**args)
+            body = func(**args)
             if body is not None:
                 result["body"] = body
             result["success"] = True
@@ -88,6 +240,81 @@ class Server:
             result["message"] = str(e)
         return result
 
+    # Return the response to the request PARAMS, which was cancelled.
+    def _cancelled_response(self, params):
+        return {
+            "request_seq": params["seq"],
+            "type": "response",
+            "command": params["command"],
+            "success": False,
+            "message": "cancelled",
+        }
+
+    # Treat PARAMS as a JSON-RPC request and perform its action.
+    # PARAMS is just a dictionary from the JSON.
+    @in_dap_thread
+    def _handle_command(self, params):
+        if self.canceller.is_cancelled(params["seq"]):
+            return self._cancelled_response(params)
+        global _commands
+        return self._run_command(params, _commands[params["command"]])
+
+    # Run the read-only requests in BATCH, a list, in the gdb thread
+    # and return the list of their responses.
+    @in_gdb_thread
+    def _run_read_only_batch(self, batch):
+        global _read_only_commands
+        results = []
+        for params in batch:
+            if not self.canceller.start(params["seq"]):
+                results.append(self._cancelled_response(params))
+                continue
+            result = self._run_command(
+                params, _read_only_commands[params["command"]]
+            )
+            if self.canceller.done():
+                result = self._cancelled_response(params)
+            results.append(result)
+        return results
+
+    # Handle the requests in BATCH, a list returned by
+    # _RequestQueue.get_batch, and return the list of their
+    # responses.  Read-only requests are all run in the gdb thread in
+    # one go, instead of each waiting for the gdb thread in turn.
+    @in_dap_thread
+    def _handle_batch(self, batch):
+        global _read_only_commands
+        if batch[0]["command"] not in _read_only_commands:
+            return [self._handle_command(batch[0])]
+        return send_gdb_with_response(lambda: self._run_read_only_batch(batch))
+
+    # Read requests from the client and queue them.  It is run in its
+    # own thread.  When the client goes away, or a request cannot be
+    # read, the queue is closed so that the main loop stops.
+    def _read_requests(self):
+        try:
+            self._read_requests_1()
+        except BaseException:
+            log_stack()
+        finally:
+            self.read_queue.close()
+
+    def _read_requests_1(self):
+        while True:
+            cmd = read_json(self.in_stream)
+            if cmd is None:
+                break
+            log("READ: <<<" + json.dumps(cmd) + ">>>")
+            # Cancelling must be done right away, the point is to not
+            # wait for the request being cancelled.  The 'cancel'
+            # request itself is queued so that it gets its response.
+            if cmd["command"] == "cancel":
+                args = cmd.get("arguments", {})
+                if "requestId" in args:
+                    self.canceller.cancel(args["requestId"])
+            self.canceller.add(cmd["seq"])
+            self.read_queue.put(cmd)
+
     # Read inferior output and sends OutputEvents to the client.  It
     # is run in its own thread.
     def _read_inferior_output(self):
@@ -110,21 +337,25 @@ class Server:
     def main_loop(self):
         """The main loop of the DAP server."""
         # Before looping, start the thread that writes JSON to the
-        # client, and the thread that reads output from the inferior.
+        # client, the thread that reads requests from the client, and
+        # the thread that reads output from the inferior.
         start_thread("output reader", self._read_inferior_output)
         start_json_writer(self.out_stream, self.write_queue)
+        start_thread("JSON reader", self._read_requests)
         while not self.done:
-            cmd = read_json(self.in_stream)
-            log("READ: <<<" + json.dumps(cmd) + ">>>")
-            result = self._handle_command(cmd)
-            self._send_json(result)
+            batch = self.read_queue.get_batch()
+            if len(batch) == 0:
+                break
+            for result in self._handle_batch(batch):
+                self.canceller.remove(result["request_seq"])
+                self._send_json(result)
             events = self.delayed_events
             self.delayed_events = []
             for event, body in events:
                 self.send_event(event, body)
-        # Got the terminate request.  This is handled by the
-        # JSON-writing thread, so that we can ensure that all
-        # responses are flushed to the client before exiting.
+        # Got the terminate request, or the client went away.  This is
+        # handled by the JSON-writing thread, so that we can ensure
+        # that all responses are flushed to the client before exiting.
         self.write_queue.put(None)
 
     @in_dap_thread
@@ -184,7 +415,9 @@ def request(
     *,
     response: bool = True,
     on_dap_thread: bool = False,
-    expect_stopped: bool = True
+    expect_stopped: bool = True,
+    read_only: bool = False,
+    control: bool = False
 ):
     """A decorator for DAP requests.
 
@@ -205,10 +438,20 @@ def request(
     fail with the 'notStopped' reason if it is processed while the
     inferior is running.  When EXPECT_STOPPED is False, the request
     will proceed regardless of the inferior's state.
+
+    If READ_ONLY is True, the request changes neither the state of gdb
+    nor that of the inferior.  Read-only requests queued one after
+    the other are run together in the gdb thread, and may be
+    overtaken by control requests.  READ_ONLY requires that the
+    function be invoked in the gdb thread and that RESPONSE be True.
+
+    If CONTROL is True, the request is handled before any read-only
+    request that was received before it and is still waiting.
     """
 
     # Validate the parameters.
     assert not on_dap_thread or response
+    assert not read_only or (response and not on_dap_thread)
 
     def wrap(func):
         code = func.__code__
@@ -252,6 +495,15 @@ def request(
 
         global _commands
         _commands[name] = cmd
+        if read_only:
+            global _read_only_commands
+            if expect_stopped:
+                _read_only_commands[name] = _check_not_running(func)
+            else:
+                _read_only_commands[name] = func
+        if control:
+            global _control_commands
+            _control_commands.add(name)
         return cmd
 
     return wrap
@@ -288,6 +540,14 @@ def initialize(**args):
     return _capabilities.copy()
 
 
+# The work is done by the thread reading requests, see
+# Server._read_requests.
+@request("cancel", on_dap_thread=True, expect_stopped=False, control=True)
+@capability("supportsCancelRequest")
+def cancel(**args):
+    pass
+
+
 @request("terminate", expect_stopped=False)
 @capability("supportsTerminateRequest")
 def terminate(**args):
@@ -76,7 +76,7 @@ def decode_source(source):
     return _id_map[ref]["path"]
 
 
-@request("loadedSources")
+@request("loadedSources", read_only=True)
 @capability("supportsLoadedSourcesRequest")
 def loaded_sources(**extra):
     result = []
@@ -87,7 +87,7 @@ def loaded_sources(**extra):
     }
 
 
-@request("source")
+@request("source", read_only=True)
 def source(*, source=None, sourceReference: int, **extra):
     # The 'sourceReference' parameter is required by the spec, but is
     # for backward compatibility, which I take to mean that the
@@ -26,7 +26,7 @@ def _thread_name(thr):
     return None
 
 
-@request("threads")
+@request("threads", read_only=True)
 def threads(**args):
     result = []
     for thr in gdb.selected_inferior().threads():
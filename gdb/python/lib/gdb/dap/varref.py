@@ -17,10 +17,15 @@ import gdb
 from .startup import in_gdb_thread
 from .server import client_bool_capability
 from abc import ABC, abstractmethod
-from collections import defaultdict
+from collections import defaultdict, OrderedDict
 from contextlib import contextmanager
 
 
+# The number of child names a reference remembers, beyond those that
+# had to be made unique.  See BaseReference.reset_children.
+NAME_CACHE_SIZE = 1000
+
+
 # A list of all the variable references created during this pause.
 all_variables = []
 
@@ -69,12 +74,24 @@ class BaseReference(ABC):
         NAME is a string or None.  None means this does not have a
         name, e.g., the result of expression evaluation."""
 
-        global all_variables
-        all_variables.append(self)
-        self.ref = len(all_variables)
+        self._ref = None
         self.name = name
         self.reset_children()
 
+    @property
+    def ref(self):
+        """The variablesReference of this object.
+
+        A reference is only allocated when this is first requested,
+        which is normally only done for objects that have children.
+        So, the leaves of a huge array do not each take a slot in the
+        list of references."""
+        if self._ref is None:
+            global all_variables
+            all_variables.append(self)
+            self._ref = len(all_variables)
+        return self._ref
+
     @in_gdb_thread
     def to_object(self):
         """Return a dictionary that describes this object for DAP.
@@ -93,10 +110,25 @@ class BaseReference(ABC):
 
     def reset_children(self):
         """Reset any cached information about the children of this object."""
-        # A list of all the children.  Each child is a BaseReference
-        # of some kind.
-        self.children = None
-        # Map from the name of a child to a BaseReference.
+        # Map from the index of a child to the child, a BaseReference
+        # of some kind.  Only children that themselves have children
+        # are kept here, because the client may refer to them later;
+        # other children are cheap to recreate and are dropped once
+        # they have been returned.
+        self.children = {}
+        # Map from the index of a child to its name, for the
+        # NAME_CACHE_SIZE children returned most recently, so that the
+        # memory used does not grow with the number of children the
+        # client looks at.  An evicted child is simply named again;
+        # the cost is that a later child with the same name as an
+        # evicted one is not renamed.
+        self.names = OrderedDict()
+        # Map from the index of a child to its name, for the children
+        # whose name had to be made unique.  These are never evicted,
+        # so that such a child keeps its name.
+        self.unique_names = {}
+        # Map from the name of a child to its index, for the children
+        # in the two maps above.
         self.by_name = {}
         # Keep track of how many duplicates there are of a given name,
         # so that unique names can be generated.  Map from base name
@@ -135,6 +167,37 @@ class BaseReference(ABC):
             name = name + " #" + str(self.name_counts[name])
         return name
 
+    # Helper method to return the name of the child at index IDX,
+    # whose base name is given, and remember it.
+    def _child_name(self, idx, name):
+        if idx in self.unique_names:
+            return self.unique_names[idx]
+        if idx in self.names:
+            self.names.move_to_end(idx)
+            return self.names[idx]
+        unique = self._compute_name(name)
+        if unique != name:
+            self.unique_names[idx] = unique
+        else:
+            self.names[idx] = unique
+            if len(self.names) > NAME_CACHE_SIZE:
+                (_, evicted) = self.names.popitem(last=False)
+                del self.by_name[evicted]
+        self.by_name[unique] = idx
+        return unique
+
+    # Helper method to return the child at index IDX, creating it if
+    # needed.
+    def _child(self, idx):
+        if idx in self.children:
+            return self.children[idx]
+        (name, value) = self.fetch_one_child(idx)
+        name = self._child_name(idx, name)
+        var = VariableReference(name, value)
+        if var.has_children():
+            self.children[idx] = var
+        return var
+
     @in_gdb_thread
     def fetch_children(self, start, count):
         """Fetch children of this variable.
@@ -142,18 +205,11 @@ class BaseReference(ABC):
         START is the starting index.
         COUNT is the number to return, with 0 meaning return all.
         Returns an iterable of some kind."""
-        if count == 0:
-            count = self.child_count()
-        if self.children is None:
-            self.children = [None] * self.child_count()
+        num_children = self.child_count()
+        if count == 0 or start + count > num_children:
+            count = num_children - start
         for idx in range(start, start + count):
-            if self.children[idx] is None:
-                (name, value) = self.fetch_one_child(idx)
-                name = self._compute_name(name)
-                var = VariableReference(name, value)
-                self.children[idx] = var
-                self.by_name[name] = var
-            yield self.children[idx]
+            yield self._child(idx)
 
     @in_gdb_thread
     def find_child_by_name(self, name):
@@ -161,10 +217,14 @@ class BaseReference(ABC):
 
         Returns the value of the child, or throws if not found."""
         # A lookup by name can only be done using names previously
-        # provided to the client, so we can simply rely on the by-name
-        # map here.
+        # provided to the client, so the by-name map has the name
+        # unless it was evicted.  An evicted name is the child's own,
+        # so look for it among the children.
         if name in self.by_name:
-            return self.by_name[name]
+            return self._child(self.by_name[name])
+        for idx in range(self.child_count()):
+            if idx not in self.unique_names and self.fetch_one_child(idx)[0] == name:
+                return self._child(idx)
         raise Exception("no variable named '" + name + "'")
 
 
@@ -31,6 +31,7 @@
 #include "py-event.h"
 #include "py-stopevent.h"
 #include "progspace-and-thread.h"
+#include "target-dcache.h"
 #include <unordered_map>
 
 using thread_map_t
@@ -569,6 +570,97 @@ infpy_read_memory (PyObject *self, PyObject *args, PyObject *kw)
   return gdbpy_buffer_to_membuf (std::move (buffer), addr, length);
 }
 
+/* Implementation of Inferior.read_memory_into (address, buffer [, length]).
+   Reads LENGTH bytes, or as many bytes as fit in BUFFER if LENGTH is
+   not given, from ADDRESS in the inferior's memory directly into
+   BUFFER, a writable Python object supporting the buffer protocol.
+   Returns None, or NULL on error, with a python exception set.  */
+static PyObject *
+infpy_read_memory_into (PyObject *self, PyObject *args, PyObject *kw)
+{
+  inferior_object *inf = (inferior_object *) self;
+  CORE_ADDR addr, length;
+  PyObject *addr_obj, *length_obj = NULL;
+  static const char *keywords[] = { "address", "buffer", "length", NULL };
+  Py_buffer pybuf;
+
+  INFPY_REQUIRE_VALID (inf);
+
+  if (!gdb_PyArg_ParseTupleAndKeywords (args, kw, "Ow*|O", keywords,
+					&addr_obj, &pybuf, &length_obj))
+    return NULL;
+
+  Py_buffer_up buffer_up (&pybuf);
+
+  if (get_addr_from_python (addr_obj, &addr) < 0)
+    return nullptr;
+
+  if (!length_obj)
+    length = pybuf.len;
+  else if (get_addr_from_python (length_obj, &length) < 0)
+    return nullptr;
+
+  if (length > (CORE_ADDR) pybuf.len)
+    {
+      PyErr_SetString (PyExc_ValueError,
+		       _("Length is larger than the buffer."));
+      return nullptr;
+    }
+
+  try
+    {
+      scoped_restore_current_inferior_for_memory restore_inferior
+	(inf->inferior);
+
+      read_memory (addr, (gdb_byte *) pybuf.buf, length);
+    }
+  catch (const gdb_exception &except)
+    {
+      GDB_PY_HANDLE_EXCEPTION (except);
+    }
+
+  Py_RETURN_NONE;
+}
+
+/* Implementation of Inferior.prefetch_memory (address, length).
+   Reads LENGTH bytes at ADDRESS in the inferior's memory in as few
+   target transfers as possible, so that later reads of values in that
+   range, for instance the children of a pretty-printed container, do
+   not go to the target again.  Returns None, or NULL on error, with a
+   python exception set.  */
+static PyObject *
+infpy_prefetch_memory (PyObject *self, PyObject *args, PyObject *kw)
+{
+  inferior_object *inf = (inferior_object *) self;
+  CORE_ADDR addr, length;
+  PyObject *addr_obj, *length_obj;
+  static const char *keywords[] = { "address", "length", NULL };
+
+  INFPY_REQUIRE_VALID (inf);
+
+  if (!gdb_PyArg_ParseTupleAndKeywords (args, kw, "OO", keywords,
+					&addr_obj, &length_obj))
+    return NULL;
+
+  if (get_addr_from_python (addr_obj, &addr) < 0
+      || get_addr_from_python (length_obj, &length) < 0)
+    return NULL;
+
+  try
+    {
+      scoped_restore_current_inferior_for_memory restore_inferior
+	(inf->inferior);
+
+      target_prefetch_memory (addr, length);
+    }
+  catch (const gdb_exception &except)
+    {
+      GDB_PY_HANDLE_EXCEPTION (except);
+    }
+
+  Py_RETURN_NONE;
+}
+
 /* Implementation of Inferior.write_memory (address, buffer [, length]).
    Writes the contents of BUFFER (a Python object supporting the read
    buffer protocol) at ADDRESS in the inferior's memory.  Write LENGTH
@@ -1066,6 +1158,15 @@ Return true if this inferior is valid, false if not." },
     METH_VARARGS | METH_KEYWORDS,
     "read_memory (address, length) -> buffer\n\
 Return a buffer object for reading from the inferior's memory." },
+  { "read_memory_into", (PyCFunction) infpy_read_memory_into,
+    METH_VARARGS | METH_KEYWORDS,
+    "read_memory_into (address, buffer [, length]) -> None\n\
+Read the inferior's memory into the given writable buffer object." },
+  { "prefetch_memory", (PyCFunction) infpy_prefetch_memory,
+    METH_VARARGS | METH_KEYWORDS,
+    "prefetch_memory (address, length) -> None\n\
+Read the given range of the inferior's memory in one go, so that later\n\
+reads in that range do not access the target again." },
   { "write_memory", (PyCFunction) infpy_write_memory,
     METH_VARARGS | METH_KEYWORDS,
     "write_memory (address, buffer [, length])\n\
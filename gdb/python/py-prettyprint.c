@@ -26,6 +26,7 @@
 #include "python.h"
 #include "python-internal.h"
 #include "cli/cli-style.h"
+#include <unordered_map>
 
 extern PyTypeObject printer_object_type;
 
@@ -49,10 +50,12 @@ const struct value_print_options *gdbpy_current_print_options;
    calls each function and inspects output.  This will return a
    printer object if one recognizes VALUE.  If no printer is found, it
    will return None.  On error, it will set the Python error and
-   return NULL.  */
+   return NULL.  If a printer is found and FUNCTION_OUT is not NULL,
+   it is set to the lookup function that returned the printer.  */
 
 static gdbpy_ref<>
-search_pp_list (PyObject *list, PyObject *value)
+search_pp_list (PyObject *list, PyObject *value,
+		gdbpy_ref<> *function_out)
 {
   Py_ssize_t pp_list_size, list_index;
 
@@ -84,7 +87,11 @@ search_pp_list (PyObject *list, PyObject *value)
       if (printer == NULL)
 	return NULL;
       else if (printer != Py_None)
-	return printer;
+	{
+	  if (function_out != nullptr)
+	    *function_out = gdbpy_ref<>::new_reference (function);
+	  return printer;
+	}
     }
 
   return gdbpy_ref<>::new_reference (Py_None);
@@ -97,7 +104,8 @@ search_pp_list (PyObject *list, PyObject *value)
    Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
 
 static PyObject *
-find_pretty_printer_from_objfiles (PyObject *value)
+find_pretty_printer_from_objfiles (PyObject *value,
+				   gdbpy_ref<> *function_out)
 {
   for (objfile *obj : current_program_space->objfiles ())
     {
@@ -110,7 +118,8 @@ find_pretty_printer_from_objfiles (PyObject *value)
 	}
 
       gdbpy_ref<> pp_list (objfpy_get_printers (objf.get (), NULL));
-      gdbpy_ref<> function (search_pp_list (pp_list.get (), value));
+      gdbpy_ref<> function (search_pp_list (pp_list.get (), value,
+					    function_out));
 
       /* If there is an error in any objfile list, abort the search and exit.  */
       if (function == NULL)
@@ -130,14 +139,15 @@ find_pretty_printer_from_objfiles (PyObject *value)
    Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
 
 static gdbpy_ref<>
-find_pretty_printer_from_progspace (PyObject *value)
+find_pretty_printer_from_progspace (PyObject *value,
+				    gdbpy_ref<> *function_out)
 {
   gdbpy_ref<> obj = pspace_to_pspace_object (current_program_space);
 
   if (obj == NULL)
     return NULL;
   gdbpy_ref<> pp_list (pspy_get_printers (obj.get (), NULL));
-  return search_pp_list (pp_list.get (), value);
+  return search_pp_list (pp_list.get (), value, function_out);
 }
 
 /* Subroutine of find_pretty_printer to simplify it.
@@ -147,7 +157,7 @@ find_pretty_printer_from_progspace (PyObject *value)
    Otherwise the result is the pretty-printer function, suitably inc-ref'd.  */
 
 static gdbpy_ref<>
-find_pretty_printer_from_gdb (PyObject *value)
+find_pretty_printer_from_gdb (PyObject *value, gdbpy_ref<> *function_out)
 {
   /* Fetch the global pretty printer list.  */
   if (gdb_python_module == NULL
@@ -158,29 +168,101 @@ find_pretty_printer_from_gdb (PyObject *value)
   if (pp_list == NULL || ! PyList_Check (pp_list.get ()))
     return gdbpy_ref<>::new_reference (Py_None);
 
-  return search_pp_list (pp_list.get (), value);
+  return search_pp_list (pp_list.get (), value, function_out);
 }
 
 /* Find the pretty-printing constructor function for VALUE.  If no
    pretty-printer exists, return None.  If one exists, return a new
-   reference.  On error, set the Python error and return NULL.  */
+   reference.  On error, set the Python error and return NULL.  If a
+   printer is found and FUNCTION_OUT is not NULL, it is set to the
+   lookup function that returned it.  */
 
 static gdbpy_ref<>
-find_pretty_printer (PyObject *value)
+find_pretty_printer (PyObject *value, gdbpy_ref<> *function_out = nullptr)
 {
   /* Look at the pretty-printer list for each objfile
      in the current program-space.  */
-  gdbpy_ref<> function (find_pretty_printer_from_objfiles (value));
+  gdbpy_ref<> function (find_pretty_printer_from_objfiles (value,
+							   function_out));
   if (function == NULL || function != Py_None)
     return function;
 
   /* Look at the pretty-printer list for the current program-space.  */
-  function = find_pretty_printer_from_progspace (value);
+  function = find_pretty_printer_from_progspace (value, function_out);
   if (function == NULL || function != Py_None)
     return function;
 
   /* Look at the pretty-printer list in the gdb module.  */
-  return find_pretty_printer_from_gdb (value);
+  return find_pretty_printer_from_gdb (value, function_out);
+}
+
+/* While a pretty-printed value is being printed, the result of the
+   printer lookup for each type is remembered here, so that printing a
+   container with many elements of the same type searches the
+   pretty-printer lists once per type rather than once per element.
+   The value is the lookup function that recognized a value of the
+   type.  Only such positive results are remembered: a lookup function
+   may decline a value because of its contents rather than its type,
+   and the printer lists may change while printing, so not finding a
+   printer for one value says nothing about the next.  The cache only
+   lives as long as the outermost gdbpy_apply_val_pretty_printer
+   call.  */
+
+static std::unordered_map<struct type *, gdbpy_ref<>> pp_lookup_cache;
+
+/* Number of gdbpy_apply_val_pretty_printer calls currently active.
+   PP_LOOKUP_CACHE is only used when this is non-zero.  */
+
+static int pp_lookup_cache_depth;
+
+/* RAII class that enables PP_LOOKUP_CACHE and clears it when the
+   outermost instance is destroyed.  It must be created and destroyed
+   while holding the GIL.  */
+
+class scoped_pp_lookup_cache
+{
+public:
+  scoped_pp_lookup_cache ()
+  {
+    ++pp_lookup_cache_depth;
+  }
+
+  ~scoped_pp_lookup_cache ()
+  {
+    if (--pp_lookup_cache_depth == 0)
+      pp_lookup_cache.clear ();
+  }
+
+  DISABLE_COPY_AND_ASSIGN (scoped_pp_lookup_cache);
+};
+
+/* Like find_pretty_printer, but use PP_LOOKUP_CACHE to avoid searching
+   the pretty-printer lists again for a value of type TYPE.  */
+
+static gdbpy_ref<>
+find_pretty_printer_cached (struct type *type, PyObject *value)
+{
+  if (pp_lookup_cache_depth == 0)
+    return find_pretty_printer (value);
+
+  auto iter = pp_lookup_cache.find (type);
+  if (iter != pp_lookup_cache.end ())
+    {
+      gdbpy_ref<> printer (PyObject_CallFunctionObjArgs (iter->second.get (),
+							 value, NULL));
+      if (printer == NULL || printer != Py_None)
+	return printer;
+
+      /* The lookup function looks at more than the type and declined
+	 this particular value, so do a full search.  */
+    }
+
+  gdbpy_ref<> function;
+  gdbpy_ref<> printer = find_pretty_printer (value, &function);
+  if (printer != NULL && printer != Py_None)
+    pp_lookup_cache[type] = std::move (function);
+
+  return printer;
 }
 
 /* Pretty-print a single value, via the printer object PRINTER.
@@ -605,6 +687,9 @@ gdbpy_apply_val_pretty_printer (const struct extension_language_defn *extlang,
 
   gdbpy_enter enter_py (gdbarch, language);
 
+  /* Remember the printer lookups done for this value's children.  */
+  scoped_pp_lookup_cache lookup_cache;
+
   gdbpy_ref<> val_obj (value_to_value_object (value));
   if (val_obj == NULL)
     {
@@ -613,7 +698,7 @@ gdbpy_apply_val_pretty_printer (const struct extension_language_defn *extlang,
     }
 
   /* Find the constructor.  */
-  gdbpy_ref<> printer (find_pretty_printer (val_obj.get ()));
+  gdbpy_ref<> printer (find_pretty_printer_cached (type, val_obj.get ()));
   if (printer == NULL)
     {
       print_stack_unless_memory_error (stream);
@@ -27,6 +27,7 @@
 #include "record-btrace.h"
 #include "disasm.h"
 #include "gdbarch.h"
+#include "source.h"
 
 /* Python object for btrace record lists.  */
 
@@ -359,7 +360,7 @@ recpy_bt_func_instructions (PyObject *self, void *closure)
   if (func == NULL)
     return NULL;
 
-  len = func->insn.size ();
+  len = func->ninsns;
 
   /* Gaps count as one instruction.  */
   if (len == 0)
@@ -790,6 +791,121 @@ recpy_bt_goto (PyObject *self, PyObject *args)
   Py_RETURN_NONE;
 }
 
+/* Implementation of BtraceRecord.profile (self) -> dict.  */
+
+PyObject *
+recpy_bt_profile (PyObject *self, PyObject *args)
+{
+  const recpy_record_object * const record = (recpy_record_object *) self;
+  thread_info *const tinfo = record->thread;
+  btrace_profile profile;
+
+  if (tinfo == NULL)
+    return PyErr_Format (gdbpy_gdb_error, _("Empty branch trace."));
+
+  try
+    {
+      btrace_fetch (tinfo, record_btrace_get_cpu ());
+
+      if (btrace_is_empty (tinfo))
+	return PyErr_Format (gdbpy_gdb_error, _("Empty branch trace."));
+
+      profile = btrace_compute_profile (&tinfo->btrace);
+    }
+  catch (const gdb_exception &except)
+    {
+      GDB_PY_HANDLE_EXCEPTION (except);
+    }
+
+  gdbpy_ref<> functions (PyList_New (profile.functions.size ()));
+  if (functions == NULL)
+    return NULL;
+
+  for (size_t i = 0; i < profile.functions.size (); ++i)
+    {
+      const btrace_profile_function &fun = profile.functions[i];
+      PyObject *item = Py_BuildValue ("(sKKK)",
+				      btrace_profile_function_name (fun),
+				      fun.self, fun.total, fun.calls);
+      if (item == NULL)
+	return NULL;
+
+      PyList_SET_ITEM (functions.get (), i, item);
+    }
+
+  gdbpy_ref<> lines (PyList_New (profile.lines.size ()));
+  if (lines == NULL)
+    return NULL;
+
+  for (size_t i = 0; i < profile.lines.size (); ++i)
+    {
+      const btrace_profile_line &line = profile.lines[i];
+      PyObject *item = Py_BuildValue ("(siK)",
+				      symtab_to_filename_for_display
+					(line.symtab),
+				      line.line, line.insns);
+      if (item == NULL)
+	return NULL;
+
+      PyList_SET_ITEM (lines.get (), i, item);
+    }
+
+  gdbpy_ref<> blocks (PyList_New (profile.blocks.size ()));
+  if (blocks == NULL)
+    return NULL;
+
+  for (size_t i = 0; i < profile.blocks.size (); ++i)
+    {
+      const btrace_profile_block &block = profile.blocks[i];
+      PyObject *item = Py_BuildValue ("(KKIK)",
+				      (unsigned long long) block.begin,
+				      (unsigned long long) block.end,
+				      block.ninsns, block.count);
+      if (item == NULL)
+	return NULL;
+
+      PyList_SET_ITEM (blocks.get (), i, item);
+    }
+
+  gdbpy_ref<> calls (PyList_New (profile.calls.size ()));
+  if (calls == NULL)
+    return NULL;
+
+  for (size_t i = 0; i < profile.calls.size (); ++i)
+    {
+      const btrace_profile_call &call = profile.calls[i];
+      PyObject *item
+	= Py_BuildValue ("(ssK)",
+			 btrace_profile_function_name
+			   (profile.functions[call.caller]),
+			 btrace_profile_function_name
+			   (profile.functions[call.callee]),
+			 call.count);
+      if (item == NULL)
+	return NULL;
+
+      PyList_SET_ITEM (calls.get (), i, item);
+    }
+
+  gdbpy_ref<> result (PyDict_New ());
+  if (result == NULL)
+    return NULL;
+
+  gdbpy_ref<> insns (PyLong_FromUnsignedLongLong (profile.insns));
+  if (insns == NULL)
+    return NULL;
+
+  if (PyDict_SetItemString (result.get (), "insns", insns.get ()) < 0
+      || PyDict_SetItemString (result.get (), "functions",
+			       functions.get ()) < 0
+      || PyDict_SetItemString (result.get (), "lines", lines.get ()) < 0
+      || PyDict_SetItemString (result.get (), "blocks", blocks.get ()) < 0
+      || PyDict_SetItemString (result.get (), "calls", calls.get ()) < 0)
+    return NULL;
+
+  return result.release ();
+}
+
 /* BtraceList methods.  */
 
 static PyMethodDef btpy_list_methods[] =
@@ -2345,6 +2345,51 @@ static PyMappingMethods value_object_as_mapping = {
   valpy_setitem
 };
 
+/* Implement the buffer protocol for gdb.Value.  The contents of the
+   value are exposed read-only, without copying them.  A reference to
+   the underlying value is held until the buffer is released, so the
+   view stays valid even if the gdb.Value is assigned to meanwhile.  */
+
+static int
+valpy_get_buffer (PyObject *self, Py_buffer *buf, int flags)
+{
+  struct value *value = ((value_object *) self)->value;
+  gdb::array_view<const gdb_byte> contents;
+
+  try
+    {
+      contents = value->contents ();
+    }
+  catch (const gdb_exception &except)
+    {
+      buf->obj = nullptr;
+      gdbpy_convert_exception (except);
+      return -1;
+    }
+
+  if (PyBuffer_FillInfo (buf, self, (void *) contents.data (),
+			 contents.size (), 1, flags) < 0)
+    return -1;
+
+  value->incref ();
+  buf->internal = value;
+  return 0;
+}
+
+/* Release a buffer obtained from valpy_get_buffer.  */
+
+static void
+valpy_release_buffer (PyObject *self, Py_buffer *buf)
+{
+  ((struct value *) buf->internal)->decref ();
+}
+
+static PyBufferProcs value_object_as_buffer =
+{
+  valpy_get_buffer,
+  valpy_release_buffer
+};
+
 PyTypeObject value_object_type = {
   PyVarObject_HEAD_INIT (NULL, 0)
   "gdb.Value",			  /*tp_name*/
@@ -2364,7 +2409,7 @@ PyTypeObject value_object_type = {
   valpy_str,			  /*tp_str*/
   0,				  /*tp_getattro*/
   0,				  /*tp_setattro*/
-  0,				  /*tp_as_buffer*/
+  &value_object_as_buffer,	  /*tp_as_buffer*/
   Py_TPFLAGS_DEFAULT | Py_TPFLAGS_CHECKTYPES
   | Py_TPFLAGS_BASETYPE,	  /*tp_flags*/
   "GDB value object",		  /* tp_doc */
@@ -1148,6 +1148,43 @@ gdbpy_post_event (PyObject *self, PyObject *args)
   Py_RETURN_NONE;
 }
 
+/* Interrupt the current operation, as if the user had typed
+   Ctrl-C.  */
+static PyObject *
+gdbpy_interrupt (PyObject *self, PyObject *args)
+{
+  if (!is_main_thread ())
+    {
+      /* The extension language state belongs to the main thread, only
+	 set GDB's own quit flag.  A Python command running in the main
+	 thread sees it the next time it calls into GDB.  */
+      set_quit_flag_from_thread ();
+      Py_RETURN_NONE;
+    }
+
+  {
+    /* Make sure the interrupt is not delivered immediately, while
+       this thread still holds the GIL.  */
+    gdbpy_allow_threads temporarily_exit_python;
+    scoped_disable_cooperative_sigint_handling no_python_sigint;
+
+    set_quit_flag ();
+  }
+
+  Py_RETURN_NONE;
+}
+
+/* Implementation of gdb._clear_interrupt.  Clear an interrupt that
+   gdb.interrupt requested from another thread and that was not needed
+   after all.  A Ctrl-C typed meanwhile stays pending.  */
+
+static PyObject *
+gdbpy_clear_interrupt (PyObject *self, PyObject *args)
+{
+  clear_quit_flag_from_thread ();
+  Py_RETURN_NONE;
+}
+
 
 
 /* This is the extension_language_ops.before_prompt "method".  */
@@ -2631,6 +2668,13 @@ Parse String as an expression, evaluate it, and return the result as a Value."
 
   { "post_event", gdbpy_post_event, METH_VARARGS,
     "Post an event into gdb's event loop." },
+  { "interrupt", gdbpy_interrupt, METH_NOARGS,
+    "interrupt () -> None\n\
+Interrupt gdb's current operation, as if Ctrl-C had been typed." },
+  { "_clear_interrupt", gdbpy_clear_interrupt, METH_NOARGS,
+    "_clear_interrupt () -> None\n\
+Clear a pending interrupt requested by gdb.interrupt from another thread.\n\
+For internal use." },
 
   { "target_charset", gdbpy_target_charset, METH_NOARGS,
     "target_charset () -> string.\n\
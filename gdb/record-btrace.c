@@ -43,9 +43,16 @@
 #include "gdbarch.h"
 #include "cli/cli-style.h"
 #include "async-event.h"
+#include <deque>
 #include <forward_list>
 #include "objfiles.h"
 #include "interps.h"
+#include "gdbcore.h"
+#include "gcore.h"
+#include "completer.h"
+#include "gdb_bfd.h"
+#include "gdbsupport/gdb_unlinker.h"
+#include "gdbsupport/byte-vector.h"
 
 static const target_info record_btrace_target_info = {
   "record-btrace",
@@ -81,6 +88,7 @@ class record_btrace_target final : public target_ops
 
   void stop_recording () override;
   void info_record () override;
+  void save_record (const char *filename) override;
 
   void insn_history (int size, gdb_disassembly_flags flags) override;
   void insn_history_from (ULONGEST from, int size,
@@ -331,15 +339,11 @@ record_btrace_handle_async_inferior_event (gdb_client_data data)
   inferior_event_handler (INF_REG_EVENT);
 }
 
-/* See record-btrace.h.  */
+/* Push the record-btrace target for a trace in FORMAT.  */
 
-void
-record_btrace_push_target (void)
+static void
+record_btrace_push (enum btrace_format format)
 {
-  const char *format;
-
-  record_btrace_auto_enable ();
-
   current_inferior ()->push_target (&record_btrace_ops);
 
   record_btrace_async_inferior_event_handler
@@ -347,8 +351,17 @@ record_btrace_push_target (void)
 				  NULL, "record-btrace");
   record_btrace_generating_corefile = 0;
 
-  format = btrace_format_short_string (record_btrace_conf.format);
-  interps_notify_record_changed (current_inferior (), 1, "btrace", format);
+  interps_notify_record_changed (current_inferior (), 1, "btrace",
+				 btrace_format_short_string (format));
+}
+
+/* See record-btrace.h.  */
+
+void
+record_btrace_push_target (void)
+{
+  record_btrace_auto_enable ();
+  record_btrace_push (record_btrace_conf.format);
 }
 
 /* Disable btrace on a set of threads on scope exit.  */
@@ -379,6 +392,25 @@ struct scoped_btrace_disable
   std::forward_list<thread_info *> m_threads;
 };
 
+/* Return the spill size that CONF sets for branch tracing in FORMAT.  */
+
+static unsigned int
+record_btrace_spill_size (const struct btrace_config *conf,
+			  enum btrace_format format)
+{
+  switch (format)
+    {
+    case BTRACE_FORMAT_BTS:
+      return conf->bts.spill_size;
+
+    case BTRACE_FORMAT_PT:
+      return conf->pt.spill_size;
+
+    default:
+      return 0;
+    }
+}
+
 /* Open target record-btrace.  */
 
 static void
@@ -395,14 +427,28 @@ record_btrace_target_open (const char *args, int from_tty)
   if (!target_has_execution ())
     error (_("The program is not being run."));
 
+  bool spill_ignored = false;
   for (thread_info *tp : current_inferior ()->non_exited_threads ())
     if (args == NULL || *args == 0 || number_is_in_list (args, tp->global_num))
       {
 	btrace_enable (tp, &record_btrace_conf);
 
 	btrace_disable.add_thread (tp);
+
+	/* Targets that cannot spill the trace report a zero spill
+	   size.  */
+	const struct btrace_config *conf = ::btrace_conf (&tp->btrace);
+	if (conf != nullptr
+	    && record_btrace_spill_size (&record_btrace_conf,
+					 conf->format) != 0
+	    && record_btrace_spill_size (conf, conf->format) == 0)
+	  spill_ignored = true;
       }
 
+  if (spill_ignored)
+    warning (_("The target does not support spilling the branch trace; "
+	       "the spill size is ignored."));
+
   record_btrace_push_target ();
 
   btrace_disable.discard ();
@@ -418,7 +464,7 @@ record_btrace_target::stop_recording ()
   record_btrace_auto_disable ();
 
   for (thread_info *tp : current_inferior ()->non_exited_threads ())
-    if (tp->btrace.target != NULL)
+    if (::btrace_conf (&tp->btrace) != NULL)
       btrace_disable (tp);
 }
 
@@ -510,6 +556,12 @@ record_btrace_print_bts_conf (const struct btrace_config_bts *conf)
       suffix = record_btrace_adjust_size (&size);
       gdb_printf (_("Buffer size: %u%s.\n"), size, suffix);
     }
+  size = conf->spill_size;
+  if (size > 0)
+    {
+      suffix = record_btrace_adjust_size (&size);
+      gdb_printf (_("Spill size: %u%s.\n"), size, suffix);
+    }
 }
 
 /* Print an Intel Processor Trace configuration.  */
@@ -526,6 +578,12 @@ record_btrace_print_pt_conf (const struct btrace_config_pt *conf)
       suffix = record_btrace_adjust_size (&size);
       gdb_printf (_("Buffer size: %u%s.\n"), size, suffix);
     }
+  size = conf->spill_size;
+  if (size > 0)
+    {
+      suffix = record_btrace_adjust_size (&size);
+      gdb_printf (_("Spill size: %u%s.\n"), size, suffix);
+    }
 }
 
 /* Print a branch tracing configuration.  */
@@ -1042,7 +1100,7 @@ btrace_call_history_insn_range (struct ui_out *uiout,
 {
   unsigned int begin, end, size;
 
-  size = bfun->insn.size ();
+  size = bfun->ninsns;
   gdb_assert (size > 0);
 
   begin = bfun->insn_offset;
@@ -1053,13 +1111,14 @@ btrace_call_history_insn_range (struct ui_out *uiout,
   uiout->field_unsigned ("insn end", end);
 }
 
-/* Compute the lowest and highest source line for the instructions in BFUN
-   and return them in PBEGIN and PEND.
+/* Compute the lowest and highest source line for the instructions in BFUN,
+   a function segment in BTINFO, and return them in PBEGIN and PEND.
    Ignore instructions that can't be mapped to BFUN, e.g. instructions that
    result from inlining or macro expansion.  */
 
 static void
-btrace_compute_src_line_range (const struct btrace_function *bfun,
+btrace_compute_src_line_range (const struct btrace_thread_info *btinfo,
+			       const struct btrace_function *bfun,
 			       int *pbegin, int *pend)
 {
   struct symtab *symtab;
@@ -1075,7 +1134,7 @@ btrace_compute_src_line_range (const struct btrace_function *bfun,
 
   symtab = sym->symtab ();
 
-  for (const btrace_insn &insn : bfun->insn)
+  for (const btrace_insn &insn : btrace_function_insns (btinfo, bfun))
     {
       struct symtab_and_line sal;
 
@@ -1096,6 +1155,7 @@ btrace_compute_src_line_range (const struct btrace_function *bfun,
 
 static void
 btrace_call_history_src_line (struct ui_out *uiout,
+			      const struct btrace_thread_info *btinfo,
 			      const struct btrace_function *bfun)
 {
   struct symbol *sym;
@@ -1109,7 +1169,7 @@ btrace_call_history_src_line (struct ui_out *uiout,
 		       symtab_to_filename_for_display (sym->symtab ()),
 		       file_name_style.style ());
 
-  btrace_compute_src_line_range (bfun, &begin, &end);
+  btrace_compute_src_line_range (btinfo, bfun, &begin, &end);
   if (end < begin)
     return;
 
@@ -1216,7 +1276,7 @@ btrace_call_history (struct ui_out *uiout,
       if ((flags & RECORD_PRINT_SRC_LINE) != 0)
 	{
 	  uiout->text (_("\tat "));
-	  btrace_call_history_src_line (uiout, bfun);
+	  btrace_call_history_src_line (uiout, btinfo, bfun);
 	}
 
       uiout->text ("\n");
@@ -1402,7 +1462,7 @@ record_btrace_target::record_method (ptid_t ptid)
   if (tp == NULL)
     error (_("No thread."));
 
-  if (tp->btrace.target == NULL)
+  if (::btrace_conf (&tp->btrace) == NULL)
     return RECORD_METHOD_NONE;
 
   return RECORD_METHOD_BTRACE;
@@ -1761,12 +1821,14 @@ record_btrace_frame_prev_register (frame_info_ptr this_frame,
 		 _("No caller in btrace record history"));
 
   caller = btrace_call_get (&it);
+  const std::vector<btrace_insn> &insns
+    = btrace_function_insns (&cache->tp->btrace, caller);
 
   if ((bfun->flags & BFUN_UP_LINKS_TO_RET) != 0)
-    pc = caller->insn.front ().pc;
+    pc = insns.front ().pc;
   else
     {
-      pc = caller->insn.back ().pc;
+      pc = insns.back ().pc;
       pc += gdb_insn_length (gdbarch, pc);
     }
 
@@ -2883,6 +2945,632 @@ record_btrace_target::done_generating_core ()
   record_btrace_generating_corefile = 0;
 }
 
+/* The name of the core file section holding the branch trace.  */
+
+#define RECORD_BTRACE_SECTION_NAME "btrace"
+
+/* The magic number at the start of the branch trace section and the
+   version of its layout.  */
+
+#define RECORD_BTRACE_FILE_MAGIC 0x62747263
+#define RECORD_BTRACE_FILE_VERSION 1
+
+/* The branch trace section of a file written by "record save" holds,
+   in big-endian byte order:
+
+     4 bytes: magic number RECORD_BTRACE_FILE_MAGIC.
+     4 bytes: version RECORD_BTRACE_FILE_VERSION.
+     4 bytes: number of threads.
+
+   followed by, for each thread:
+
+     8 bytes: lwp of the thread, or its pid if it has no lwp.
+     4 bytes: trace format, enum btrace_format.
+     4 bytes: the size of the trace buffer the trace was recorded with.
+
+   followed by the raw trace, in BTS format:
+
+     8 bytes: number of blocks.
+     16 bytes for each block, most recent first: begin and end address.
+
+   or in Intel PT format:
+
+     4 bytes each: cpu vendor, family, model and stepping.
+     8 bytes: size of the trace in bytes.
+     the trace.
+
+   The rest of the file is a core file of the inferior, which provides
+   the memory mappings and the registers at the end of the trace.  */
+
+/* Append VAL as a LEN bytes big-endian number to BUF.  */
+
+static void
+record_btrace_put (gdb::byte_vector &buf, int len, ULONGEST val)
+{
+  size_t offset = buf.size ();
+
+  buf.resize (offset + len);
+  store_unsigned_integer (buf.data () + offset, len, BFD_ENDIAN_BIG, val);
+}
+
+/* Read a LEN bytes big-endian number at *OFFSET in BUF and advance
+   *OFFSET.  */
+
+static ULONGEST
+record_btrace_get (const gdb::byte_vector &buf, size_t *offset, int len)
+{
+  if (buf.size () - *offset < len)
+    error (_("Bad branch trace data in the core file."));
+
+  ULONGEST val
+    = extract_unsigned_integer (buf.data () + *offset, len, BFD_ENDIAN_BIG);
+  *offset += len;
+
+  return val;
+}
+
+/* Append the branch trace of TP, recorded with configuration CONF, to
+   BUF.  */
+
+static void
+record_btrace_put_thread (gdb::byte_vector &buf, thread_info *tp,
+			  const struct btrace_config *conf)
+{
+  const struct btrace_data *data = &tp->btrace.data;
+  ULONGEST lwp = tp->ptid.lwp () != 0 ? tp->ptid.lwp () : tp->ptid.pid ();
+
+  record_btrace_put (buf, 8, lwp);
+  record_btrace_put (buf, 4, data->format);
+
+  switch (data->format)
+    {
+    case BTRACE_FORMAT_BTS:
+      record_btrace_put (buf, 4, conf->bts.size);
+      record_btrace_put (buf, 8, data->variant.bts.blocks->size ());
+      for (const btrace_block &block : *data->variant.bts.blocks)
+	{
+	  record_btrace_put (buf, 8, block.begin);
+	  record_btrace_put (buf, 8, block.end);
+	}
+      return;
+
+    case BTRACE_FORMAT_PT:
+      {
+	const struct btrace_data_pt *pt = &data->variant.pt;
+
+	record_btrace_put (buf, 4, conf->pt.size);
+	record_btrace_put (buf, 4, pt->config.cpu.vendor);
+	record_btrace_put (buf, 4, pt->config.cpu.family);
+	record_btrace_put (buf, 4, pt->config.cpu.model);
+	record_btrace_put (buf, 4, pt->config.cpu.stepping);
+	record_btrace_put (buf, 8, pt->size);
+	buf.insert (buf.end (), pt->data, pt->data + pt->size);
+      }
+      return;
+
+    case BTRACE_FORMAT_NONE:
+      break;
+    }
+
+  internal_error (_("Unknown branch trace format."));
+}
+
+/* The save_record method of target record-btrace.  We write a core
+   file with an extra section for the raw branch trace of each thread,
+   like record full does for its execution log.
+
+   The raw trace and the memory mappings alone are not enough.  The
+   trace can only be decoded with the code that was executed, and code
+   generated at run time, e.g. by a JIT compiler, only exists in the
+   inferior's memory.  The end of the trace is also where replay starts
+   and stops, and there the registers and memory of all threads are
+   shown as for the live process.  The core file provides both; like
+   with gcore, read-only mappings of files on disk are not copied into
+   it.  */
+
+void
+record_btrace_target::save_record (const char *filename)
+{
+  gdb::byte_vector buf;
+  unsigned int nthreads = 0;
+
+  DEBUG ("save %s", filename);
+
+  record_btrace_put (buf, 4, RECORD_BTRACE_FILE_MAGIC);
+  record_btrace_put (buf, 4, RECORD_BTRACE_FILE_VERSION);
+  record_btrace_put (buf, 4, 0);
+
+  for (thread_info *tp : current_inferior ()->non_exited_threads ())
+    {
+      const struct btrace_config *conf = ::btrace_conf (&tp->btrace);
+      if (conf == NULL)
+	continue;
+
+      if (!btrace_is_replaying (tp))
+	btrace_fetch (tp, record_btrace_get_cpu ());
+
+      if (tp->btrace.data.empty ())
+	continue;
+
+      record_btrace_put_thread (buf, tp, conf);
+      nthreads += 1;
+    }
+
+  if (nthreads == 0)
+    error (_("No trace."));
+
+  store_unsigned_integer (buf.data () + 8, 4, BFD_ENDIAN_BIG, nthreads);
+
+  gdb_bfd_ref_ptr obfd (create_gcore_bfd (filename));
+
+  /* Arrange to remove the output file on failure.  */
+  gdb::unlinker unlink_file (filename);
+
+  asection *osec
+    = bfd_make_section_anyway_with_flags (obfd.get (),
+					  RECORD_BTRACE_SECTION_NAME,
+					  SEC_HAS_CONTENTS | SEC_READONLY);
+  if (osec == NULL)
+    error (_("Failed to create '%s' section for corefile %s: %s"),
+	   RECORD_BTRACE_SECTION_NAME, filename,
+	   bfd_errmsg (bfd_get_error ()));
+  bfd_set_section_size (osec, buf.size ());
+  bfd_set_section_vma (osec, 0);
+  bfd_set_section_alignment (osec, 0);
+
+  /* Write the registers and memory of the inferior at the end of the
+     trace, even if we are replaying.  */
+  {
+    scoped_restore restore_generating_corefile
+      = make_scoped_restore (&record_btrace_generating_corefile, 1);
+
+    write_gcore_file (obfd.get ());
+  }
+
+  if (!bfd_set_section_contents (obfd.get (), osec, buf.data (), 0,
+				 buf.size ()))
+    error (_("Failed to write branch trace to corefile %s: %s"),
+	   filename, bfd_errmsg (bfd_get_error ()));
+
+  unlink_file.keep ();
+
+  gdb_printf (_("Saved core file %s with branch trace.\n"), filename);
+}
+
+/* Restore the branch trace from the "btrace" section of the core file
+   and start replaying it.  */
+
+static void
+record_btrace_restore (void)
+{
+  if (core_bfd == NULL)
+    error (_("No core file."));
+
+  asection *sec = bfd_get_section_by_name (core_bfd,
+					   RECORD_BTRACE_SECTION_NAME);
+  if (sec == NULL)
+    error (_("No branch trace in %s."), bfd_get_filename (core_bfd));
+
+  gdb::byte_vector buf (bfd_section_size (sec));
+  if (!bfd_get_section_contents (core_bfd, sec, buf.data (), 0, buf.size ()))
+    error (_("Failed to read branch trace from %s: %s"),
+	   bfd_get_filename (core_bfd), bfd_errmsg (bfd_get_error ()));
+
+  size_t offset = 0;
+  if (record_btrace_get (buf, &offset, 4) != RECORD_BTRACE_FILE_MAGIC)
+    error (_("Bad branch trace data in the core file."));
+
+  ULONGEST version = record_btrace_get (buf, &offset, 4);
+  if (version != RECORD_BTRACE_FILE_VERSION)
+    error (_("Unsupported branch trace data version %s in the core file."),
+	   pulongest (version));
+
+  ULONGEST nthreads = record_btrace_get (buf, &offset, 4);
+
+  record_preopen ();
+
+  /* The trace of a thread, read from the section.  */
+  struct restored_thread
+  {
+    thread_info *tp = nullptr;
+    struct btrace_config conf {};
+    struct btrace_data data;
+  };
+
+  /* Read the whole section before restoring any thread, so that bad
+     data does not leave some threads restored.  */
+  std::deque<restored_thread> threads;
+  inferior *inf = current_inferior ();
+  for (ULONGEST i = 0; i < nthreads; ++i)
+    {
+      restored_thread &thread = threads.emplace_back ();
+      struct btrace_config &conf = thread.conf;
+      struct btrace_data &data = thread.data;
+
+      ULONGEST lwp = record_btrace_get (buf, &offset, 8);
+      conf.format = (enum btrace_format) record_btrace_get (buf, &offset, 4);
+      switch (conf.format)
+	{
+	case BTRACE_FORMAT_BTS:
+	  {
+	    conf.bts.size = record_btrace_get (buf, &offset, 4);
+
+	    ULONGEST nblocks = record_btrace_get (buf, &offset, 8);
+	    if (nblocks > (buf.size () - offset) / 16)
+	      error (_("Bad branch trace data in the core file."));
+
+	    data.format = BTRACE_FORMAT_BTS;
+	    data.variant.bts.blocks = new std::vector<btrace_block>;
+	    data.variant.bts.blocks->reserve (nblocks);
+	    for (ULONGEST block = 0; block < nblocks; ++block)
+	      {
+		CORE_ADDR begin = record_btrace_get (buf, &offset, 8);
+		CORE_ADDR end = record_btrace_get (buf, &offset, 8);
+
+		data.variant.bts.blocks->emplace_back (begin, end);
+	      }
+	  }
+	  break;
+
+	case BTRACE_FORMAT_PT:
+	  {
+	    struct btrace_data_pt *pt = &data.variant.pt;
+
+	    conf.pt.size = record_btrace_get (buf, &offset, 4);
+
+	    data.format = BTRACE_FORMAT_PT;
+	    pt->data = NULL;
+	    pt->size = 0;
+	    pt->config.cpu.vendor
+	      = (enum btrace_cpu_vendor) record_btrace_get (buf, &offset, 4);
+	    pt->config.cpu.family = record_btrace_get (buf, &offset, 4);
+	    pt->config.cpu.model = record_btrace_get (buf, &offset, 4);
+	    pt->config.cpu.stepping = record_btrace_get (buf, &offset, 4);
+
+	    ULONGEST size = record_btrace_get (buf, &offset, 8);
+	    if (size > buf.size () - offset)
+	      error (_("Bad branch trace data in the core file."));
+
+	    pt->data = (gdb_byte *) xmalloc (size);
+	    pt->size = size;
+	    memcpy (pt->data, buf.data () + offset, size);
+	    offset += size;
+	  }
+	  break;
+
+	default:
+	  error (_("Bad branch trace data in the core file."));
+	}
+
+      /* Threads in the core file are identified by their lwp.  If there
+	 is only one thread, we do not insist.  */
+      thread_info *tp = nullptr, *only = nullptr;
+      unsigned int count = 0;
+      for (thread_info *thr : inf->non_exited_threads ())
+	{
+	  if ((thr->ptid.lwp () != 0 ? thr->ptid.lwp () : thr->ptid.pid ())
+	      == lwp)
+	    tp = thr;
+
+	  only = thr;
+	  count += 1;
+	}
+
+      if (tp == nullptr && nthreads == 1 && count == 1)
+	tp = only;
+
+      if (tp == nullptr)
+	{
+	  warning (_("No thread for the branch trace of lwp %s."),
+		   pulongest (lwp));
+	  threads.pop_back ();
+	  continue;
+	}
+
+      thread.tp = tp;
+    }
+
+  /* Undo the threads restored so far if one of them, or starting to
+     replay, fails.  */
+  try
+    {
+      enum btrace_format format = BTRACE_FORMAT_NONE;
+      for (restored_thread &thread : threads)
+	{
+	  btrace_restore (thread.tp, &thread.conf, &thread.data,
+			  record_btrace_get_cpu ());
+	  format = thread.conf.format;
+	}
+
+      if (format == BTRACE_FORMAT_NONE)
+	error (_("No trace."));
+
+      record_btrace_push (format);
+    }
+  catch (const gdb_exception &ex)
+    {
+      for (restored_thread &thread : threads)
+	if (thread.tp->btrace.target == nullptr)
+	  btrace_teardown (thread.tp);
+
+      throw;
+    }
+
+  gdb_printf (_("Restored branch trace from core file %s.\n"),
+	      bfd_get_filename (core_bfd));
+}
+
+/* The "record btrace restore" command.  */
+
+static void
+cmd_record_btrace_restore (const char *args, int from_tty)
+{
+  if (args == NULL || *args == 0)
+    error (_("Argument required (file name)."));
+
+  core_file_command (args, from_tty);
+  record_btrace_restore ();
+}
+
+/* Print the percentage of COUNT in TOTAL into the field called FLDNAME
+   of UIOUT.  */
+
+static void
+record_btrace_profile_percent (struct ui_out *uiout, const char *fldname,
+			       unsigned long long count,
+			       unsigned long long total)
+{
+  double percent = (total != 0) ? (100.0 * count) / total : 0.0;
+
+  uiout->field_fmt (fldname, "%.1f", percent);
+}
+
+/* Print the functions of the execution profile PROFILE.  Print at most
+   LIMIT rows unless LIMIT is zero.  */
+
+static void
+record_btrace_print_profile_functions (struct ui_out *uiout,
+				       const btrace_profile &profile,
+				       size_t limit)
+{
+  size_t nrows = profile.functions.size ();
+  if (limit != 0)
+    nrows = std::min (nrows, limit);
+
+  ui_out_emit_table table_emitter (uiout, 5, nrows, "functions");
+
+  uiout->table_header (10, ui_right, "self", "Self");
+  uiout->table_header (5, ui_right, "percent", "%");
+  uiout->table_header (10, ui_right, "total", "Total");
+  uiout->table_header (7, ui_right, "calls", "Calls");
+  uiout->table_header (1, ui_noalign, "function", "Function");
+  uiout->table_body ();
+
+  for (size_t i = 0; i < nrows; ++i)
+    {
+      const btrace_profile_function &fun = profile.functions[i];
+      ui_out_emit_tuple tuple_emitter (uiout, NULL);
+
+      uiout->field_unsigned ("self", fun.self);
+      record_btrace_profile_percent (uiout, "percent", fun.self,
+				     profile.insns);
+      uiout->field_unsigned ("total", fun.total);
+      uiout->field_unsigned ("calls", fun.calls);
+      uiout->field_string ("function", btrace_profile_function_name (fun),
+			   function_name_style.style ());
+      uiout->text ("\n");
+    }
+}
+
+/* Print the source lines of the execution profile PROFILE.  Print at
+   most LIMIT rows unless LIMIT is zero.  */
+
+static void
+record_btrace_print_profile_lines (struct ui_out *uiout,
+				   const btrace_profile &profile,
+				   size_t limit)
+{
+  size_t nrows = profile.lines.size ();
+  if (limit != 0)
+    nrows = std::min (nrows, limit);
+
+  ui_out_emit_table table_emitter (uiout, 3, nrows, "lines");
+
+  uiout->table_header (10, ui_right, "insns", "Insns");
+  uiout->table_header (5, ui_right, "percent", "%");
+  uiout->table_header (1, ui_noalign, "line", "Line");
+  uiout->table_body ();
+
+  for (size_t i = 0; i < nrows; ++i)
+    {
+      const btrace_profile_line &line = profile.lines[i];
+      ui_out_emit_tuple tuple_emitter (uiout, NULL);
+
+      uiout->field_unsigned ("insns", line.insns);
+      record_btrace_profile_percent (uiout, "percent", line.insns,
+				     profile.insns);
+      uiout->field_fmt ("line", "%s:%d",
+			symtab_to_filename_for_display (line.symtab),
+			line.line);
+      uiout->text ("\n");
+    }
+}
+
+/* Print the basic blocks of the execution profile PROFILE.  Print at
+   most LIMIT rows unless LIMIT is zero.  */
+
+static void
+record_btrace_print_profile_blocks (struct ui_out *uiout,
+				    const btrace_profile &profile,
+				    size_t limit)
+{
+  struct gdbarch *gdbarch = target_gdbarch ();
+
+  size_t nrows = profile.blocks.size ();
+  if (limit != 0)
+    nrows = std::min (nrows, limit);
+
+  ui_out_emit_table table_emitter (uiout, 6, nrows, "blocks");
+
+  uiout->table_header (10, ui_right, "count", "Count");
+  uiout->table_header (6, ui_right, "insns", "Insns");
+  uiout->table_header (5, ui_right, "percent", "%");
+  uiout->table_header (18, ui_left, "begin", "Begin");
+  uiout->table_header (18, ui_left, "end", "End");
+  uiout->table_header (1, ui_noalign, "function", "Function");
+  uiout->table_body ();
+
+  for (size_t i = 0; i < nrows; ++i)
+    {
+      const btrace_profile_block &block = profile.blocks[i];
+      ui_out_emit_tuple tuple_emitter (uiout, NULL);
+
+      uiout->field_unsigned ("count", block.count);
+      uiout->field_unsigned ("insns", block.ninsns);
+      record_btrace_profile_percent (uiout, "percent",
+				     block.count * block.ninsns,
+				     profile.insns);
+      uiout->field_core_addr ("begin", gdbarch, block.begin);
+      uiout->field_core_addr ("end", gdbarch, block.end);
+
+      bound_minimal_symbol msym = lookup_minimal_symbol_by_pc (block.begin);
+      if (msym.minsym != NULL)
+	uiout->field_string ("function", msym.minsym->print_name (),
+			     function_name_style.style ());
+      else
+	uiout->field_skip ("function");
+      uiout->text ("\n");
+    }
+}
+
+/* Print the call graph of the execution profile PROFILE.  Print at most
+   LIMIT rows unless LIMIT is zero.  */
+
+static void
+record_btrace_print_profile_calls (struct ui_out *uiout,
+				   const btrace_profile &profile,
+				   size_t limit)
+{
+  size_t nrows = profile.calls.size ();
+  if (limit != 0)
+    nrows = std::min (nrows, limit);
+
+  ui_out_emit_table table_emitter (uiout, 3, nrows, "calls");
+
+  uiout->table_header (7, ui_right, "calls", "Calls");
+  uiout->table_header (24, ui_left, "caller", "Caller");
+  uiout->table_header (1, ui_noalign, "callee", "Callee");
+  uiout->table_body ();
+
+  for (size_t i = 0; i < nrows; ++i)
+    {
+      const btrace_profile_call &call = profile.calls[i];
+      ui_out_emit_tuple tuple_emitter (uiout, NULL);
+
+      uiout->field_unsigned ("calls", call.count);
+      uiout->field_string
+	("caller",
+	 btrace_profile_function_name (profile.functions[call.caller]),
+	 function_name_style.style ());
+      uiout->field_string
+	("callee",
+	 btrace_profile_function_name (profile.functions[call.callee]),
+	 function_name_style.style ());
+      uiout->text ("\n");
+    }
+}
+
+/* Flags for the "record profile" command.  */
+
+enum record_profile_flag
+  {
+    RECORD_PROFILE_FUNCTIONS = (1 << 0),
+    RECORD_PROFILE_LINES = (1 << 1),
+    RECORD_PROFILE_BLOCKS = (1 << 2),
+    RECORD_PROFILE_CALLS = (1 << 3)
+  };
+
+/* The "record profile" command.  */
+
+static void
+cmd_record_profile (const char *args, int from_tty)
+{
+  unsigned int flags = 0;
+
+  args = skip_spaces (args);
+  while (args != NULL && *args == '/')
+    {
+      ++args;
+
+      if (*args == '\0')
+	error (_("Missing modifier."));
+
+      for (; *args != '\0' && !isspace (*args); ++args)
+	switch (*args)
+	  {
+	  case 'f':
+	    flags |= RECORD_PROFILE_FUNCTIONS;
+	    break;
+	  case 'l':
+	    flags |= RECORD_PROFILE_LINES;
+	    break;
+	  case 'b':
+	    flags |= RECORD_PROFILE_BLOCKS;
+	    break;
+	  case 'c':
+	    flags |= RECORD_PROFILE_CALLS;
+	    break;
+	  case '/':
+	    break;
+	  default:
+	    error (_("Invalid modifier: %c."), *args);
+	  }
+
+      args = skip_spaces (args);
+    }
+
+  if (flags == 0)
+    flags = RECORD_PROFILE_FUNCTIONS;
+
+  /* By default, print the ten hottest entries of each table.  */
+  size_t limit = 10;
+  if (args != NULL && *args != '\0')
+    {
+      limit = get_ulongest (&args);
+
+      args = skip_spaces (args);
+      if (*args != '\0')
+	error (_("Junk after argument: %s."), args);
+    }
+
+  if (target_record_method (inferior_ptid) != RECORD_METHOD_BTRACE)
+    error (_("The current record target does not support this operation."));
+
+  thread_info *tp = require_btrace_thread ();
+  btrace_profile profile = btrace_compute_profile (&tp->btrace);
+
+  struct ui_out *uiout = current_uiout;
+  ui_out_emit_tuple tuple_emitter (uiout, "profile");
+
+  uiout->text (_("Recorded "));
+  uiout->field_unsigned ("insns", profile.insns);
+  uiout->text (_(" instructions in "));
+  uiout->field_unsigned ("functions", profile.functions.size ());
+  uiout->text (_(" functions.\n"));
+
+  if ((flags & RECORD_PROFILE_FUNCTIONS) != 0)
+    record_btrace_print_profile_functions (uiout, profile, limit);
+
+  if ((flags & RECORD_PROFILE_LINES) != 0)
+    record_btrace_print_profile_lines (uiout, profile, limit);
+
+  if ((flags & RECORD_PROFILE_BLOCKS) != 0)
+    record_btrace_print_profile_blocks (uiout, profile, limit);
+
+  if ((flags & RECORD_PROFILE_CALLS) != 0)
+    record_btrace_print_profile_calls (uiout, profile, limit);
+}
+
 /* Start recording in BTS format.  */
 
 static void
@@ -3091,6 +3779,39 @@ show_record_pt_buffer_size_value (struct ui_file *file, int from_tty,
 	      value);
 }
 
+/* The "record bts spill-size" show value function.  */
+
+static void
+show_record_bts_spill_size_value (struct ui_file *file, int from_tty,
+				  struct cmd_list_element *c,
+				  const char *value)
+{
+  gdb_printf (file, _("The record/replay bts spill size is %s.\n"),
+	      value);
+}
+
+/* The "record pt spill-size" show value function.  */
+
+static void
+show_record_pt_spill_size_value (struct ui_file *file, int from_tty,
+				 struct cmd_list_element *c,
+				 const char *value)
+{
+  gdb_printf (file, _("The record/replay pt spill size is %s.\n"),
+	      value);
+}
+
+/* The "record pt max-decoded-insns" show value function.  */
+
+static void
+show_record_pt_max_decoded_insns_value (struct ui_file *file, int from_tty,
+					struct cmd_list_element *c,
+					const char *value)
+{
+  gdb_printf (file, _("The maximum number of decoded pt instructions "
+		      "kept in memory is %s.\n"), value);
+}
+
 /* Initialize btrace commands.  */
 
 void _initialize_record_btrace ();
@@ -3121,6 +3842,29 @@ This format may not be available on all processors."),
 	     &record_btrace_cmdlist);
   add_alias_cmd ("pt", record_btrace_pt_cmd, class_obscure, 1, &record_cmdlist);
 
+  cmd_list_element *record_btrace_restore_cmd
+    = add_cmd ("restore", class_obscure, cmd_record_btrace_restore,
+	       _("\
+Restore the branch trace from a file.\n\
+Argument is filename.  File must be created with 'record save' while\n\
+recording with the btrace method.  The file is loaded as a core file and\n\
+its branch trace can be browsed and replayed, but not extended."),
+	       &record_btrace_cmdlist);
+  set_cmd_completer (record_btrace_restore_cmd, filename_completer);
+
+  add_cmd ("profile", class_obscure, cmd_record_profile, _("\
+Print an execution profile of the branch trace of the current thread.\n\
+Usage: record profile [/MODIFIERS] [COUNT]\n\
+The profile counts the instructions executed in each function, source\n\
+line and basic block, as well as the calls between functions.\n\
+With a /f modifier, print the functions (the default).\n\
+With a /l modifier, print the source lines.\n\
+With a /b modifier, print the basic blocks.\n\
+With a /c modifier, print the call graph.\n\
+Modifiers can be combined.  Each table lists the COUNT most frequently\n\
+executed entries, 10 by default; a COUNT of 0 lists all entries."),
+	   &record_cmdlist);
+
   add_setshow_prefix_cmd ("btrace", class_support,
 			  _("Set record options."),
 			  _("Show record options."),
@@ -3191,6 +3935,24 @@ The trace buffer size may not be changed while recording."), NULL,
 			    &set_record_btrace_bts_cmdlist,
 			    &show_record_btrace_bts_cmdlist);
 
+  add_setshow_zuinteger_cmd ("spill-size", no_class,
+			     &record_btrace_conf.bts.spill_size,
+			     _("Set the record/replay bts spill size."),
+			     _("Show the record/replay bts spill size."), _("\
+When non-zero, a background thread keeps copying the trace from the trace \
+buffer into a ring of this size in a temporary file while the inferior \
+runs.  The trace is then read from that ring, which allows recording \
+much longer than the trace buffer size.\n\
+The trace buffer must be big enough to hold the trace that is produced \
+between two copies.\n\
+GDB reads the whole ring into memory when reading the trace.\n\
+This is only supported for native GNU/Linux targets.  Zero, the default, \
+disables spilling.\n\
+The spill size may not be changed while recording."), NULL,
+			     show_record_bts_spill_size_value,
+			     &set_record_btrace_bts_cmdlist,
+			     &show_record_btrace_bts_cmdlist);
+
   add_setshow_prefix_cmd ("pt", class_support,
 			  _("Set record btrace pt options."),
 			  _("Show record btrace pt options."),
@@ -3210,6 +3972,39 @@ to see the actual buffer size."), NULL, show_record_pt_buffer_size_value,
 			    &set_record_btrace_pt_cmdlist,
 			    &show_record_btrace_pt_cmdlist);
 
+  add_setshow_zuinteger_cmd ("spill-size", no_class,
+			     &record_btrace_conf.pt.spill_size,
+			     _("Set the record/replay pt spill size."),
+			     _("Show the record/replay pt spill size."), _("\
+When non-zero, a background thread keeps copying the trace from the trace \
+buffer into a ring of this size in a temporary file while the inferior \
+runs.  The trace is then read from that ring, which allows recording \
+much longer than the trace buffer size.\n\
+Tracing stops while the trace buffer is full and resumes once the trace \
+has been copied, which shows as a gap in the trace.\n\
+GDB reads the whole ring into memory when reading the trace.\n\
+This is only supported for native GNU/Linux targets.  Zero, the default, \
+disables spilling."), NULL,
+			     show_record_pt_spill_size_value,
+			     &set_record_btrace_pt_cmdlist,
+			     &show_record_btrace_pt_cmdlist);
+
+  add_setshow_uinteger_cmd ("max-decoded-insns", no_class,
+			    &btrace_pt_max_decoded_insns,
+			    _("Set the maximum number of decoded pt "
+			      "instructions kept in memory."),
+			    _("Show the maximum number of decoded pt "
+			      "instructions kept in memory."), _("\
+When the trace is decoded, the instructions of the least recently used \
+parts of the trace are dropped to stay within this limit.  They are \
+decoded again when they are needed.\n\
+This saves memory for big traces at the expense of decode time.  The \
+limit is approximate and applies the next time the trace is decoded.\n\
+Use \"unlimited\" to keep all decoded instructions."), NULL,
+			    show_record_pt_max_decoded_insns_value,
+			    &set_record_btrace_pt_cmdlist,
+			    &show_record_btrace_pt_cmdlist);
+
   add_target (record_btrace_target_info, record_btrace_target_open);
 
   bfcache = htab_create_alloc (50, bfcache_hash, bfcache_eq, NULL,
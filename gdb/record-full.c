@@ -43,6 +43,10 @@
 #include "interps.h"
 
 #include <signal.h>
+#include <bitset>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 /* This module implements "target record-full", also known as "process
    record and replay".  This target sits on top of a "normal" target
@@ -67,7 +71,8 @@
 #define DEFAULT_RECORD_FULL_INSN_MAX_NUM	200000
 
 #define RECORD_FULL_IS_REPLAY \
-  (record_full_list->next || ::execution_direction == EXEC_REVERSE)
+  (record_full_next (record_full_list) != NULL \
+   || ::execution_direction == EXEC_REVERSE)
 
 #define RECORD_FULL_FILE_MAGIC	netorder32(0x20091016)
 
@@ -79,8 +84,39 @@
    that indicates that this is the last struct record_full_entry of this
    instruction.
 
-   Each struct record_full_entry is linked to "record_full_list" by "prev"
-   and "next" pointers.  */
+   Entries are stored in order in the chunks of the execution log, see
+   struct record_full_chunk.  */
+
+/* The size of the pages memory entries store large contents in, see
+   struct record_full_page.  record_full_replay_state also groups its
+   copy of the inferior's memory by pages of this size.  */
+
+#define RECORD_FULL_PAGE_SIZE 4096
+
+/* A page of the contents of a memory entry.  Pages are immutable and
+   shared by all memory entries with the same contents at the same
+   offset from a page boundary, which is common when the same buffer is
+   recorded over and over, or when large, mostly zero buffers are.
+   Changing the contents of an entry replaces its pages, so this is
+   copy-on-write.  */
+
+struct record_full_page
+{
+  /* The number of references to this page from memory entries.  */
+  unsigned int refcount;
+
+  /* The hash of DATA, see record_full_pages.  */
+  hashval_t hash;
+
+  /* The number of bytes in DATA.  This is less than a page for the
+     first and last pages of a memory entry that does not start or end
+     at a page boundary.  */
+  unsigned int len;
+
+  /* The contents.  Pages are allocated with room for LEN bytes only,
+     see record_full_page_get.  */
+  gdb_byte data[1];
+};
 
 struct record_full_mem_entry
 {
@@ -88,11 +124,18 @@ struct record_full_mem_entry
   int len;
   /* Set this flag if target memory for this entry
      can no longer be accessed.  */
-  int mem_entry_not_accessible;
+  unsigned int mem_entry_not_accessible : 1;
+  /* Set this flag if the contents of this entry were not read yet, see
+     record_full_arch_list_add_mem.  */
+  unsigned int pending : 1;
   union
   {
     gdb_byte *ptr;
     gdb_byte buf[sizeof (gdb_byte *)];
+    /* The pages holding the contents, if the entry is at least a page
+       long.  The first page holds the part up to the first page
+       boundary after ADDR.  */
+    struct record_full_page **pages;
   } u;
 };
 
@@ -122,33 +165,35 @@ enum record_full_type
 
 /* This is the data structure that makes up the execution log.
 
-   The execution log consists of a single linked list of entries
-   of type "struct record_full_entry".  It is doubly linked so that it
-   can be traversed in either direction.
+   The execution log is a sequence of entries of type "struct
+   record_full_entry", which can be traversed in either direction with
+   record_full_next and record_full_prev.
 
-   The start of the list is anchored by a struct called
-   "record_full_first".  The pointer "record_full_list" either points
-   to the last entry that was added to the list (in record mode), or to
-   the next entry in the list that will be executed (in replay mode).
+   The start of the log is anchored by an entry called
+   "record_full_first", which is not part of any chunk.  The pointer
+   "record_full_list" either points to the last entry that was added to
+   the log (in record mode), or to the next entry in the log that will
+   be executed (in replay mode).
 
-   Each list element (struct record_full_entry), in addition to next
-   and prev pointers, consists of a union of three entry types: mem,
-   reg, and end.  A field called "type" determines which entry type is
-   represented by a given list element.
+   Each entry consists of a union of three entry types: mem, reg, and
+   end.  A field called "type" determines which entry type is
+   represented by a given entry.
 
    Each instruction that is added to the execution log is represented
-   by a variable number of list elements ('entries').  The instruction
-   will have one "reg" entry for each register that is changed by 
-   executing the instruction (including the PC in every case).  It 
-   will also have one "mem" entry for each memory change.  Finally,
-   each instruction will have an "end" entry that separates it from
-   the changes associated with the next instruction.  */
+   by a variable number of entries.  The instruction will have one
+   "reg" entry for each register that is changed by executing the
+   instruction (including the PC in every case).  It will also have
+   one "mem" entry for each memory change.  Finally, each instruction
+   will have an "end" entry that separates it from the changes
+   associated with the next instruction.  */
 
 struct record_full_entry
 {
-  struct record_full_entry *prev;
-  struct record_full_entry *next;
-  enum record_full_type type;
+  ENUM_BITFIELD (record_full_type) type : 8;
+
+  /* The position of this entry in the entries of its chunk.  */
+  unsigned short index;
+
   union
   {
     /* reg */
@@ -160,6 +205,241 @@ struct record_full_entry
   } u;
 };
 
+/* Number of entries in each chunk of the execution log.  */
+
+#define RECORD_FULL_CHUNK_ENTRIES 4096
+
+/* The entries of the execution log are allocated in chunks, which
+   hold a contiguous run of entries each and are chained in log order.
+   New entries are appended to the last chunk, and entries released
+   from the start of the log are dropped from the first chunk.  A chunk
+   is freed as soon as it no longer holds any entry, so that the chunks
+   in the chain are never empty.  */
+
+struct record_full_chunk
+{
+  struct record_full_chunk *prev;
+  struct record_full_chunk *next;
+
+  /* The entries of this chunk in the log are those in [BEGIN, END).  */
+  unsigned int begin;
+  unsigned int end;
+
+  /* The instruction number of the last "end" entry of this chunk, or 0
+     if it has none.  This indexes the log by instruction number.  */
+  ULONGEST last_insn_num;
+
+  struct record_full_entry entries[RECORD_FULL_CHUNK_ENTRIES];
+};
+
+/* The chain of chunks of the execution log.  */
+
+static struct record_full_chunk *record_full_chunk_first;
+static struct record_full_chunk *record_full_chunk_last;
+
+/* The size of the granules of memory record_full_write_index indexes
+   writes shorter than a page by.  */
+
+#define RECORD_FULL_WRITE_GRANULE 64
+
+/* An index of the memory written by the instructions in the execution
+   log, by address.  For each granule of memory, and for each page for
+   writes longer than a page, it keeps the sorted instruction numbers
+   of the instructions that have a memory entry overlapping it.  This
+   finds the last or next instruction that may have written a range of
+   memory without walking the log.  The result may be an instruction
+   that wrote nearby memory in the same granule, but never misses one
+   that wrote the range.  */
+
+class record_full_write_index
+{
+public:
+  record_full_write_index () = default;
+
+  DISABLE_COPY_AND_ASSIGN (record_full_write_index);
+
+  /* Record that instruction INSN_NUM, which must not be lower than
+     any instruction added before, writes LEN bytes at ADDR.  */
+  void add (CORE_ADDR addr, ULONGEST len, ULONGEST insn_num);
+
+  /* Return the number of the last instruction not after INSN_NUM that
+     may have written LEN bytes at ADDR, or 0 if there is none.  */
+  ULONGEST last_write (CORE_ADDR addr, ULONGEST len,
+		       ULONGEST insn_num) const;
+
+  /* Return the number of the first instruction not before INSN_NUM
+     that may write LEN bytes at ADDR, or ULONGEST_MAX if there is
+     none.  */
+  ULONGEST next_write (CORE_ADDR addr, ULONGEST len,
+		       ULONGEST insn_num) const;
+
+  /* Forget the instructions after INSN_NUM.  */
+  void truncate (ULONGEST insn_num);
+
+  /* Forget the instructions before INSN_NUM.  */
+  void forget_before (ULONGEST insn_num);
+
+  /* Forget all instructions.  */
+  void clear ();
+
+private:
+
+  /* The instructions writing each granule or page, by address.  */
+  using writers_map = std::unordered_map<CORE_ADDR, std::vector<ULONGEST>>;
+
+  template<typename Callback>
+  void for_each_writers (CORE_ADDR addr, ULONGEST len,
+			 Callback callback) const;
+
+  writers_map m_granules;
+  writers_map m_pages;
+};
+
+void
+record_full_write_index::add (CORE_ADDR addr, ULONGEST len,
+			      ULONGEST insn_num)
+{
+  if (len == 0)
+    return;
+
+  writers_map &map = (len > RECORD_FULL_PAGE_SIZE ? m_pages : m_granules);
+  CORE_ADDR size = (len > RECORD_FULL_PAGE_SIZE
+		    ? RECORD_FULL_PAGE_SIZE : RECORD_FULL_WRITE_GRANULE);
+
+  CORE_ADDR last = (addr + len - 1) & ~(size - 1);
+  for (CORE_ADDR key = addr & ~(size - 1); ; key += size)
+    {
+      std::vector<ULONGEST> &writers = map[key];
+      if (writers.empty () || writers.back () < insn_num)
+	writers.push_back (insn_num);
+
+      if (key == last)
+	break;
+    }
+}
+
+/* Call CALLBACK with the writers of each granule and page overlapping
+   LEN bytes at ADDR.  */
+
+template<typename Callback>
+void
+record_full_write_index::for_each_writers (CORE_ADDR addr, ULONGEST len,
+					   Callback callback) const
+{
+  if (len == 0)
+    return;
+
+  for (CORE_ADDR size : { RECORD_FULL_WRITE_GRANULE, RECORD_FULL_PAGE_SIZE })
+    {
+      const writers_map &map = (size == RECORD_FULL_PAGE_SIZE
+				? m_pages : m_granules);
+      if (map.empty ())
+	continue;
+
+      CORE_ADDR last = (addr + len - 1) & ~(size - 1);
+      for (CORE_ADDR key = addr & ~(size - 1); ; key += size)
+	{
+	  auto iter = map.find (key);
+	  if (iter != map.end ())
+	    callback (iter->second);
+
+	  if (key == last)
+	    break;
+	}
+    }
+}
+
+ULONGEST
+record_full_write_index::last_write (CORE_ADDR addr, ULONGEST len,
+				     ULONGEST insn_num) const
+{
+  ULONGEST result = 0;
+
+  for_each_writers (addr, len, [&] (const std::vector<ULONGEST> &writers)
+    {
+      auto iter = std::upper_bound (writers.begin (), writers.end (),
+				    insn_num);
+      if (iter != writers.begin ())
+	result = std::max (result, *(iter - 1));
+    });
+
+  return result;
+}
+
+ULONGEST
+record_full_write_index::next_write (CORE_ADDR addr, ULONGEST len,
+				     ULONGEST insn_num) const
+{
+  ULONGEST result = ULONGEST_MAX;
+
+  for_each_writers (addr, len, [&] (const std::vector<ULONGEST> &writers)
+    {
+      auto iter = std::lower_bound (writers.begin (), writers.end (),
+				    insn_num);
+      if (iter != writers.end ())
+	result = std::min (result, *iter);
+    });
+
+  return result;
+}
+
+void
+record_full_write_index::truncate (ULONGEST insn_num)
+{
+  for (writers_map *map : { &m_granules, &m_pages })
+    for (auto iter = map->begin (); iter != map->end (); )
+      {
+	std::vector<ULONGEST> &writers = iter->second;
+	while (!writers.empty () && writers.back () > insn_num)
+	  writers.pop_back ();
+
+	if (writers.empty ())
+	  iter = map->erase (iter);
+	else
+	  ++iter;
+      }
+}
+
+void
+record_full_write_index::forget_before (ULONGEST insn_num)
+{
+  for (writers_map *map : { &m_granules, &m_pages })
+    for (auto iter = map->begin (); iter != map->end (); )
+      {
+	std::vector<ULONGEST> &writers = iter->second;
+	writers.erase (writers.begin (),
+		       std::lower_bound (writers.begin (), writers.end (),
+					 insn_num));
+
+	if (writers.empty ())
+	  iter = map->erase (iter);
+	else
+	  ++iter;
+      }
+}
+
+void
+record_full_write_index::clear ()
+{
+  m_granules.clear ();
+  m_pages.clear ();
+}
+
+/* The memory written by the instructions of the execution log.  It is
+   only needed to go backward to a hardware watchpoint, and is brought
+   up to date by record_full_update_writes then.  */
+
+static record_full_write_index record_full_writes;
+
+/* The instructions up to this one are in record_full_writes.  */
+
+static ULONGEST record_full_writes_through;
+
+/* The number of instructions released from the start of the log since
+   record_full_writes last forgot them.  */
+
+static unsigned int record_full_writes_released;
+
 /* If true, query if PREC cannot record memory
    change of next instruction.  */
 bool record_full_memory_query = false;
@@ -176,28 +456,34 @@ static detached_regcache *record_full_core_regbuf = NULL;
 static target_section_table record_full_core_sections;
 static struct record_full_core_buf_entry *record_full_core_buf_list = NULL;
 
-/* The following variables are used for managing the linked list that
-   represents the execution log.
+/* The following variables are used for managing the execution log.
 
    record_full_first is the anchor that holds down the beginning of
-   the list.
+   the log.
 
    record_full_list serves two functions:
-     1) In record mode, it anchors the end of the list.
-     2) In replay mode, it traverses the list and points to
+     1) In record mode, it anchors the end of the log.
+     2) In replay mode, it traverses the log and points to
 	the next instruction that must be emulated.
 
-   record_full_arch_list_head and record_full_arch_list_tail are used
-   to manage a separate list, which is used to build up the change
-   elements of the currently executing instruction during record mode.
-   When this instruction has been completely annotated in the "arch
-   list", it will be appended to the main execution log.  */
+   record_full_arch_list_head and record_full_arch_list_tail delimit
+   the change elements of the currently executing instruction during
+   record mode (the "arch list").  They are appended to the chunks of
+   the log as they are recorded, right after record_full_list, and
+   become part of the execution log once the instruction has been
+   completely annotated and record_full_list moves to its end.  Until
+   then they can be discarded with record_full_arch_list_release.  */
 
 static struct record_full_entry record_full_first;
 static struct record_full_entry *record_full_list = &record_full_first;
 static struct record_full_entry *record_full_arch_list_head = NULL;
 static struct record_full_entry *record_full_arch_list_tail = NULL;
 
+/* The pending memory entries of record_full_arch_list, by address, see
+   record_full_arch_list_add_mem.  */
+static std::multimap<CORE_ADDR, struct record_full_entry *>
+  record_full_arch_list_mems;
+
 /* true ask user. false auto delete the last struct record_full_entry.  */
 static bool record_full_stop_at_limit = true;
 /* Maximum allowed number of insns in execution log.  */
@@ -379,10 +665,94 @@ static struct cmd_list_element *record_full_cmdlist;
 static void record_full_goto_insn (struct record_full_entry *entry,
 				   enum exec_direction_kind dir);
 
-/* Alloc and free functions for record_full_reg, record_full_mem, and
-   record_full_end entries.  */
+/* Return the chunk holding REC, which must not be record_full_first.  */
+
+static inline struct record_full_chunk *
+record_full_chunk_of (struct record_full_entry *rec)
+{
+  gdb_assert (rec != &record_full_first);
+
+  return (struct record_full_chunk *)
+    ((char *) (rec - rec->index) - offsetof (struct record_full_chunk,
+					     entries));
+}
+
+/* Return the entry following REC in the execution log, or NULL if REC
+   is the last one.  */
+
+static inline struct record_full_entry *
+record_full_next (struct record_full_entry *rec)
+{
+  struct record_full_chunk *chunk;
+
+  if (rec == &record_full_first)
+    chunk = record_full_chunk_first;
+  else
+    {
+      chunk = record_full_chunk_of (rec);
+      if (rec->index + 1 < chunk->end)
+	return rec + 1;
+      chunk = chunk->next;
+    }
+
+  if (chunk == NULL)
+    return NULL;
+  return &chunk->entries[chunk->begin];
+}
+
+/* Return the entry preceding REC in the execution log, or NULL if REC
+   is record_full_first.  */
+
+static inline struct record_full_entry *
+record_full_prev (struct record_full_entry *rec)
+{
+  if (rec == &record_full_first)
+    return NULL;
+
+  struct record_full_chunk *chunk = record_full_chunk_of (rec);
+  if (rec->index > chunk->begin)
+    return rec - 1;
+
+  chunk = chunk->prev;
+  if (chunk == NULL)
+    return &record_full_first;
+  return &chunk->entries[chunk->end - 1];
+}
+
+/* Append a new, zeroed entry of type TYPE to the end of the execution
+   log and return it.  */
+
+static struct record_full_entry *
+record_full_entry_alloc (enum record_full_type type)
+{
+  struct record_full_chunk *chunk = record_full_chunk_last;
+
+  if (chunk == NULL || chunk->end == RECORD_FULL_CHUNK_ENTRIES)
+    {
+      chunk = XNEW (struct record_full_chunk);
+      chunk->prev = record_full_chunk_last;
+      chunk->next = NULL;
+      chunk->begin = 0;
+      chunk->end = 0;
+      chunk->last_insn_num = 0;
+
+      if (record_full_chunk_last != NULL)
+	record_full_chunk_last->next = chunk;
+      else
+	record_full_chunk_first = chunk;
+      record_full_chunk_last = chunk;
+    }
+
+  struct record_full_entry *rec = &chunk->entries[chunk->end];
+  memset (rec, 0, sizeof (*rec));
+  rec->type = type;
+  rec->index = chunk->end;
+  chunk->end++;
 
-/* Alloc a record_full_reg record entry.  */
+  return rec;
+}
+
+/* Alloc a record_full_reg record entry at the end of the log.  */
 
 static inline struct record_full_entry *
 record_full_reg_alloc (struct regcache *regcache, int regnum)
@@ -390,8 +760,7 @@ record_full_reg_alloc (struct regcache *regcache, int regnum)
   struct record_full_entry *rec;
   struct gdbarch *gdbarch = regcache->arch ();
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_reg;
+  rec = record_full_entry_alloc (record_full_reg);
   rec->u.reg.num = regnum;
   rec->u.reg.len = register_size (gdbarch, regnum);
   if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
@@ -400,68 +769,190 @@ record_full_reg_alloc (struct regcache *regcache, int regnum)
   return rec;
 }
 
-/* Free a record_full_reg record entry.  */
+/* Hash and compare the pages in record_full_pages by contents.  */
 
-static inline void
-record_full_reg_release (struct record_full_entry *rec)
+struct record_full_page_hash
 {
-  gdb_assert (rec->type == record_full_reg);
-  if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
-    xfree (rec->u.reg.u.ptr);
-  xfree (rec);
+  size_t operator() (const struct record_full_page *page) const
+  {
+    return page->hash;
+  }
+};
+
+struct record_full_page_eq
+{
+  bool operator() (const struct record_full_page *lhs,
+		   const struct record_full_page *rhs) const
+  {
+    return (lhs->hash == rhs->hash && lhs->len == rhs->len
+	    && memcmp (lhs->data, rhs->data, lhs->len) == 0);
+  }
+};
+
+/* All pages of memory entries, see struct record_full_page.  */
+
+static std::unordered_set<struct record_full_page *,
+			  record_full_page_hash,
+			  record_full_page_eq> record_full_pages;
+
+/* Return a reference to a page holding the LEN bytes at DATA.  */
+
+static struct record_full_page *
+record_full_page_get (const gdb_byte *data, unsigned int len)
+{
+  struct record_full_page *page
+    = (struct record_full_page *) xmalloc (offsetof (struct record_full_page,
+						     data) + len);
+
+  page->refcount = 1;
+  page->len = len;
+  memcpy (page->data, data, len);
+  page->hash = fast_hash (page->data, len);
+
+  auto inserted = record_full_pages.insert (page);
+  if (!inserted.second)
+    {
+      xfree (page);
+      page = *inserted.first;
+      page->refcount++;
+    }
+
+  return page;
 }
 
-/* Alloc a record_full_mem record entry.  */
+/* Drop a reference to PAGE, which may be NULL.  */
 
-static inline struct record_full_entry *
-record_full_mem_alloc (CORE_ADDR addr, int len)
+static void
+record_full_page_put (struct record_full_page *page)
 {
-  struct record_full_entry *rec;
+  if (page == NULL || --page->refcount > 0)
+    return;
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_mem;
-  rec->u.mem.addr = addr;
-  rec->u.mem.len = len;
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
-    rec->u.mem.u.ptr = (gdb_byte *) xmalloc (len);
+  record_full_pages.erase (page);
+  xfree (page);
+}
 
-  return rec;
+/* Return true if the memory entry REC stores its contents in pages.  */
+
+static inline bool
+record_full_mem_paged (const struct record_full_entry *rec)
+{
+  return rec->u.mem.len >= RECORD_FULL_PAGE_SIZE;
 }
 
-/* Free a record_full_mem record entry.  */
+/* Return the number of pages of the paged memory entry REC.  */
 
-static inline void
-record_full_mem_release (struct record_full_entry *rec)
+static unsigned int
+record_full_mem_npages (const struct record_full_entry *rec)
+{
+  CORE_ADDR first = rec->u.mem.addr / RECORD_FULL_PAGE_SIZE;
+  CORE_ADDR last = (rec->u.mem.addr + rec->u.mem.len - 1)
+		   / RECORD_FULL_PAGE_SIZE;
+
+  return last - first + 1;
+}
+
+/* Allocate the storage for the contents of the memory entry REC.  */
+
+static void
+record_full_mem_alloc_contents (struct record_full_entry *rec)
 {
-  gdb_assert (rec->type == record_full_mem);
-  if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
+  if (record_full_mem_paged (rec))
+    rec->u.mem.u.pages = XCNEWVEC (struct record_full_page *,
+				   record_full_mem_npages (rec));
+  else if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
+    rec->u.mem.u.ptr = (gdb_byte *) xmalloc (rec->u.mem.len);
+}
+
+/* Free the storage for the contents of the memory entry REC.  */
+
+static void
+record_full_mem_free_contents (struct record_full_entry *rec)
+{
+  if (record_full_mem_paged (rec))
+    {
+      if (rec->u.mem.u.pages == NULL)
+	return;
+
+      unsigned int npages = record_full_mem_npages (rec);
+      for (unsigned int i = 0; i < npages; i++)
+	record_full_page_put (rec->u.mem.u.pages[i]);
+      xfree (rec->u.mem.u.pages);
+    }
+  else if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
     xfree (rec->u.mem.u.ptr);
-  xfree (rec);
 }
 
-/* Alloc a record_full_end record entry.  */
+/* Copy the contents of the paged memory entry REC into BUF.  */
+
+static void
+record_full_mem_get (struct record_full_entry *rec, gdb_byte *buf)
+{
+  unsigned int npages = record_full_mem_npages (rec);
+
+  for (unsigned int i = 0; i < npages; i++)
+    {
+      const struct record_full_page *page = rec->u.mem.u.pages[i];
+
+      memcpy (buf, page->data, page->len);
+      buf += page->len;
+    }
+}
+
+/* Set the contents of the paged memory entry REC to those in BUF.
+   Pages whose contents do not change are kept.  */
+
+static void
+record_full_mem_set (struct record_full_entry *rec, const gdb_byte *buf)
+{
+  unsigned int npages = record_full_mem_npages (rec);
+  CORE_ADDR addr = rec->u.mem.addr;
+  CORE_ADDR end = addr + rec->u.mem.len;
+
+  for (unsigned int i = 0; i < npages; i++)
+    {
+      struct record_full_page **pagep = &rec->u.mem.u.pages[i];
+      CORE_ADDR next = std::min (end, (addr / RECORD_FULL_PAGE_SIZE + 1)
+					 * RECORD_FULL_PAGE_SIZE);
+      unsigned int len = next - addr;
+
+      if (*pagep == NULL || memcmp ((*pagep)->data, buf, len) != 0)
+	{
+	  record_full_page_put (*pagep);
+	  *pagep = record_full_page_get (buf, len);
+	}
+
+      buf += len;
+      addr = next;
+    }
+}
+
+/* Alloc a record_full_mem record entry at the end of the log.  */
 
 static inline struct record_full_entry *
-record_full_end_alloc (void)
+record_full_mem_alloc (CORE_ADDR addr, int len)
 {
   struct record_full_entry *rec;
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_end;
+  rec = record_full_entry_alloc (record_full_mem);
+  rec->u.mem.addr = addr;
+  rec->u.mem.len = len;
+  record_full_mem_alloc_contents (rec);
 
   return rec;
 }
 
-/* Free a record_full_end record entry.  */
+/* Alloc a record_full_end record entry at the end of the log.  */
 
-static inline void
-record_full_end_release (struct record_full_entry *rec)
+static inline struct record_full_entry *
+record_full_end_alloc (void)
 {
-  xfree (rec);
+  return record_full_entry_alloc (record_full_end);
 }
 
-/* Free one record entry, any type.
-   Return entry->type, in case caller wants to know.  */
+/* Free the data of one record entry, any type, which is about to be
+   dropped from its chunk.  Return entry->type, in case caller wants to
+   know.  */
 
 static inline enum record_full_type
 record_full_entry_release (struct record_full_entry *rec)
@@ -470,42 +961,118 @@ record_full_entry_release (struct record_full_entry *rec)
 
   switch (type) {
   case record_full_reg:
-    record_full_reg_release (rec);
+    if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
+      xfree (rec->u.reg.u.ptr);
     break;
   case record_full_mem:
-    record_full_mem_release (rec);
+    record_full_mem_free_contents (rec);
     break;
   case record_full_end:
-    record_full_end_release (rec);
     break;
   }
   return type;
 }
 
-/* Free all record entries in list pointed to by REC.  */
+/* Free all record entries following REC in the execution log.  Return
+   the number of record_full_end entries freed.  */
 
-static void
-record_full_list_release (struct record_full_entry *rec)
+static unsigned int
+record_full_log_truncate (struct record_full_entry *rec)
 {
-  if (!rec)
-    return;
+  struct record_full_chunk *keep = NULL;
+  unsigned int ends = 0;
 
-  while (rec->next)
-    rec = rec->next;
+  if (rec != &record_full_first)
+    keep = record_full_chunk_of (rec);
 
-  while (rec->prev)
+  /* Free the chunks after KEEP.  */
+  while (record_full_chunk_last != keep)
     {
-      rec = rec->prev;
-      record_full_entry_release (rec->next);
+      struct record_full_chunk *chunk = record_full_chunk_last;
+
+      for (unsigned int i = chunk->begin; i < chunk->end; i++)
+	if (record_full_entry_release (&chunk->entries[i]) == record_full_end)
+	  ends++;
+
+      record_full_chunk_last = chunk->prev;
+      if (record_full_chunk_last != NULL)
+	record_full_chunk_last->next = NULL;
+      else
+	record_full_chunk_first = NULL;
+      xfree (chunk);
     }
 
-  if (rec == &record_full_first)
+  if (keep == NULL)
+    return ends;
+
+  /* Free the entries of KEEP after REC.  */
+  for (unsigned int i = rec->index + 1; i < keep->end; i++)
+    if (record_full_entry_release (&keep->entries[i]) == record_full_end)
+      ends++;
+  keep->end = rec->index + 1;
+
+  keep->last_insn_num = 0;
+  for (unsigned int i = keep->end; i > keep->begin; i--)
+    if (keep->entries[i - 1].type == record_full_end)
+      {
+	keep->last_insn_num = keep->entries[i - 1].u.end.insn_num;
+	break;
+      }
+
+  return ends;
+}
+
+/* Free the first entry of the execution log, which must not be empty.
+   Return its type.  */
+
+static enum record_full_type
+record_full_log_release_first_entry (void)
+{
+  struct record_full_chunk *chunk = record_full_chunk_first;
+
+  gdb_assert (chunk != NULL);
+
+  enum record_full_type type
+    = record_full_entry_release (&chunk->entries[chunk->begin]);
+  chunk->begin++;
+
+  if (chunk->begin == chunk->end)
     {
-      record_full_insn_num = 0;
-      record_full_first.next = NULL;
+      record_full_chunk_first = chunk->next;
+      if (record_full_chunk_first != NULL)
+	record_full_chunk_first->prev = NULL;
+      else
+	record_full_chunk_last = NULL;
+      xfree (chunk);
     }
-  else
-    record_full_entry_release (rec);
+
+  return type;
+}
+
+/* Free the whole execution log.  */
+
+static void
+record_full_list_release (void)
+{
+  record_full_log_truncate (&record_full_first);
+  record_full_insn_num = 0;
+  record_full_writes.clear ();
+  record_full_writes_through = 0;
+  record_full_writes_released = 0;
+}
+
+/* Free the entries of the arch list, and any entry allocated for it but
+   not added to it yet.  These are all the entries after
+   record_full_list.  */
+
+static void
+record_full_arch_list_release (void)
+{
+  record_full_log_truncate (record_full_list);
+
+  record_full_arch_list_head = NULL;
+  record_full_arch_list_tail = NULL;
+  record_full_arch_list_mems.clear ();
 }
 
 /* Free all record entries forward of the given list position.  */
@@ -513,19 +1080,13 @@ record_full_list_release (struct record_full_entry *rec)
 static void
 record_full_list_release_following (struct record_full_entry *rec)
 {
-  struct record_full_entry *tmp = rec->next;
+  unsigned int ends = record_full_log_truncate (rec);
 
-  rec->next = NULL;
-  while (tmp)
-    {
-      rec = tmp->next;
-      if (record_full_entry_release (tmp) == record_full_end)
-	{
-	  record_full_insn_num--;
-	  record_full_insn_count--;
-	}
-      tmp = rec;
-    }
+  record_full_insn_num -= ends;
+  record_full_insn_count -= ends;
+  record_full_writes.truncate (record_full_insn_count);
+  record_full_writes_through = std::min (record_full_writes_through,
+					 record_full_insn_count);
 }
 
 /* Delete the first instruction from the beginning of the log, to make
@@ -536,24 +1097,28 @@ record_full_list_release_following (struct record_full_entry *rec)
 static void
 record_full_list_release_first (void)
 {
-  struct record_full_entry *tmp;
-
-  if (!record_full_first.next)
+  if (record_full_chunk_first == NULL)
     return;
 
   /* Loop until a record_full_end.  */
   while (1)
     {
-      /* Cut record_full_first.next out of the linked list.  */
-      tmp = record_full_first.next;
-      record_full_first.next = tmp->next;
-      tmp->next->prev = &record_full_first;
+      struct record_full_chunk *chunk = record_full_chunk_first;
+      ULONGEST insn_num = chunk->entries[chunk->begin].u.end.insn_num;
 
-      /* tmp is now isolated, and can be deleted.  */
-      if (record_full_entry_release (tmp) == record_full_end)
-	break;	/* End loop at first record_full_end.  */
+      if (record_full_log_release_first_entry () == record_full_end)
+	{
+	  /* Forget the released instructions in record_full_writes
+	     once in a while, which walks the whole index.  */
+	  if (++record_full_writes_released >= record_full_insn_max_num)
+	    {
+	      record_full_writes.forget_before (insn_num + 1);
+	      record_full_writes_released = 0;
+	    }
+	  break;	/* End loop at first record_full_end.  */
+	}
 
-      if (!record_full_first.next)
+      if (record_full_chunk_first == NULL)
 	{
 	  gdb_assert (record_full_insn_num == 1);
 	  break;	/* End loop when list is empty.  */
@@ -561,7 +1126,8 @@ record_full_list_release_first (void)
     }
 }
 
-/* Add a struct record_full_entry to record_full_arch_list.  */
+/* Add a struct record_full_entry, just appended to the end of the log,
+   to record_full_arch_list.  */
 
 static void
 record_full_arch_list_add (struct record_full_entry *rec)
@@ -571,17 +1137,62 @@ record_full_arch_list_add (struct record_full_entry *rec)
 		"Process record: record_full_arch_list_add %s.\n",
 		host_address_to_string (rec));
 
-  if (record_full_arch_list_tail)
-    {
-      record_full_arch_list_tail->next = rec;
-      rec->prev = record_full_arch_list_tail;
-      record_full_arch_list_tail = rec;
-    }
-  else
+  if (record_full_arch_list_head == NULL)
     {
       record_full_arch_list_head = rec;
-      record_full_arch_list_tail = rec;
+      record_full_arch_list_mems.clear ();
     }
+  record_full_arch_list_tail = rec;
+
+  if (rec->type == record_full_end)
+    record_full_chunk_of (rec)->last_insn_num = rec->u.end.insn_num;
+}
+
+/* Add the memory entries of the instructions recorded since the last
+   call to record_full_writes.  */
+
+static void
+record_full_update_writes (void)
+{
+  struct record_full_chunk *chunk = record_full_chunk_first;
+  struct record_full_entry *rec = &record_full_first;
+
+  /* Start after the last instruction already indexed, if it is still
+     in the log.  Skip the chunks that end before it.  */
+  while (chunk != NULL && chunk->last_insn_num < record_full_writes_through)
+    chunk = chunk->next;
+
+  if (chunk != NULL)
+    for (struct record_full_entry *p = &chunk->entries[chunk->begin];
+	 p != NULL;
+	 p = record_full_next (p))
+      if (p->type == record_full_end
+	  && p->u.end.insn_num >= record_full_writes_through)
+	{
+	  if (p->u.end.insn_num == record_full_writes_through)
+	    rec = p;
+	  break;
+	}
+
+  /* The memory entries of an instruction come before its end entry.  */
+  std::vector<struct record_full_entry *> mems;
+  for (rec = record_full_next (rec); rec != NULL; rec = record_full_next (rec))
+    if (rec->type == record_full_mem)
+      mems.push_back (rec);
+    else if (rec->type == record_full_end)
+      {
+	ULONGEST insn_num = rec->u.end.insn_num;
+
+	if (insn_num > record_full_writes_through)
+	  {
+	    for (struct record_full_entry *mem : mems)
+	      record_full_writes.add (mem->u.mem.addr, mem->u.mem.len,
+				      insn_num);
+	    record_full_writes_through = insn_num;
+	  }
+
+	mems.clear ();
+      }
 }
 
 /* Return the value storage location of a record entry.  */
@@ -590,6 +1201,7 @@ record_full_get_loc (struct record_full_entry *rec)
 {
   switch (rec->type) {
   case record_full_mem:
+    gdb_assert (!record_full_mem_paged (rec));
     if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
       return rec->u.mem.u.ptr;
     else
@@ -629,7 +1241,14 @@ record_full_arch_list_add_reg (struct regcache *regcache, int regnum)
 }
 
 /* Record the value of a region of memory whose address is ADDR and
-   length is LEN to record_full_arch_list.  */
+   length is LEN to record_full_arch_list.
+
+   The memory is not read right away.  Instructions that store to
+   several places, or a syscall filling in a structure, would otherwise
+   cost one memory transfer each.  A region that overlaps or touches the
+   region starting last before its end, among those already recorded for
+   the same instruction, is merged with it, and all regions are read by
+   record_full_arch_list_read_mem when the instruction is complete.  */
 
 int
 record_full_arch_list_add_mem (CORE_ADDR addr, int len)
@@ -645,16 +1264,130 @@ record_full_arch_list_add_mem (CORE_ADDR addr, int len)
   if (!addr)	/* FIXME: Why?  Some arch must permit it...  */
     return 0;
 
-  rec = record_full_mem_alloc (addr, len);
-
-  if (record_read_memory (target_gdbarch (), addr,
-			  record_full_get_loc (rec), len))
+  if (record_full_arch_list_head != NULL)
     {
-      record_full_mem_release (rec);
-      return -1;
+      auto iter = record_full_arch_list_mems.upper_bound (addr + len);
+
+      if (iter != record_full_arch_list_mems.begin ())
+	{
+	  --iter;
+	  rec = iter->second;
+
+	  CORE_ADDR begin = std::min (rec->u.mem.addr, addr);
+	  CORE_ADDR end = std::max (rec->u.mem.addr + rec->u.mem.len,
+				    addr + len);
+
+	  if (rec->u.mem.pending
+	      && addr <= rec->u.mem.addr + rec->u.mem.len
+	      && begin < end && end - begin <= INT_MAX)
+	    {
+	      if (begin != rec->u.mem.addr)
+		{
+		  record_full_arch_list_mems.erase (iter);
+		  record_full_arch_list_mems.emplace (begin, rec);
+		}
+
+	      rec->u.mem.addr = begin;
+	      rec->u.mem.len = end - begin;
+	      return 0;
+	    }
+	}
     }
 
+  rec = record_full_entry_alloc (record_full_mem);
+  rec->u.mem.addr = addr;
+  rec->u.mem.len = len;
+  rec->u.mem.pending = 1;
+
   record_full_arch_list_add (rec);
+  record_full_arch_list_mems.emplace (addr, rec);
+
+  return 0;
+}
+
+/* The maximum distance between the memory entries of an instruction
+   that record_full_arch_list_read_mem reads in a single transfer.  */
+
+#define RECORD_FULL_MAX_BATCH_READ (16 * RECORD_FULL_PAGE_SIZE)
+
+/* Set the contents of the pending memory entry REC to the LEN bytes at
+   DATA, and mark it as read.  */
+
+static void
+record_full_mem_fill (struct record_full_entry *rec, const gdb_byte *data)
+{
+  rec->u.mem.pending = 0;
+  record_full_mem_alloc_contents (rec);
+
+  if (record_full_mem_paged (rec))
+    record_full_mem_set (rec, data);
+  else
+    memcpy (record_full_get_loc (rec), data, rec->u.mem.len);
+}
+
+/* Read the contents of the memory entries of record_full_arch_list
+   that record_full_arch_list_add_mem deferred.  If they are close to
+   each other, read them with a single memory transfer.  Return -1 if
+   any of them cannot be read.  */
+
+static int
+record_full_arch_list_read_mem (void)
+{
+  struct gdbarch *gdbarch = target_gdbarch ();
+  std::vector<struct record_full_entry *> pending;
+  CORE_ADDR begin = 0, end = 0;
+
+  if (record_full_arch_list_head == NULL)
+    return 0;
+
+  record_full_arch_list_mems.clear ();
+
+  for (struct record_full_entry *rec = record_full_arch_list_head; ;
+       rec = record_full_next (rec))
+    {
+      if (rec->type == record_full_mem && rec->u.mem.pending)
+	{
+	  CORE_ADDR rec_end = rec->u.mem.addr + rec->u.mem.len;
+
+	  if (pending.empty () || rec->u.mem.addr < begin)
+	    begin = rec->u.mem.addr;
+	  if (pending.empty () || end < rec_end)
+	    end = rec_end;
+	  pending.push_back (rec);
+	}
+
+      if (rec == record_full_arch_list_tail)
+	break;
+    }
+
+  gdb::byte_vector batch;
+  if (pending.size () > 1 && begin < end
+      && end - begin <= RECORD_FULL_MAX_BATCH_READ)
+    {
+      batch.resize (end - begin);
+      if (record_read_memory (gdbarch, begin, batch.data (), batch.size ()))
+	{
+	  /* There may be a hole between the entries.  Read them one by
+	     one instead.  */
+	  batch.clear ();
+	}
+    }
+
+  for (struct record_full_entry *rec : pending)
+    {
+      if (!batch.empty ())
+	{
+	  record_full_mem_fill (rec, batch.data () + (rec->u.mem.addr - begin));
+	  continue;
+	}
+
+      gdb::byte_vector contents (rec->u.mem.len);
+      if (record_read_memory (gdbarch, rec->u.mem.addr, contents.data (),
+			      rec->u.mem.len))
+	return -1;
+
+      record_full_mem_fill (rec, contents.data ());
+    }
 
   return 0;
 }
@@ -671,6 +1404,9 @@ record_full_arch_list_add_end (void)
     gdb_printf (gdb_stdlog,
 		"Process record: add end to arch list.\n");
 
+  if (record_full_arch_list_read_mem ())
+    return -1;
+
   rec = record_full_end_alloc ();
   rec->u.end.sigval = GDB_SIGNAL_0;
   rec->u.end.insn_num = ++record_full_insn_count;
@@ -764,12 +1500,10 @@ record_full_message (struct regcache *regcache, enum gdb_signal signal)
     }
   catch (const gdb_exception &ex)
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_release ();
       throw;
     }
 
-  record_full_list->next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = record_full_list;
   record_full_list = record_full_arch_list_tail;
 
   if (record_full_insn_num == record_full_insn_max_num)
@@ -859,8 +1593,19 @@ record_full_exec_insn (struct regcache *regcache,
 	      entry->u.mem.mem_entry_not_accessible = 1;
 	    else
 	      {
-		if (target_write_memory (entry->u.mem.addr, 
-					 record_full_get_loc (entry),
+		gdb::byte_vector contents;
+		gdb_byte *loc;
+
+		if (record_full_mem_paged (entry))
+		  {
+		    contents.resize (entry->u.mem.len);
+		    record_full_mem_get (entry, contents.data ());
+		    loc = contents.data ();
+		  }
+		else
+		  loc = record_full_get_loc (entry);
+
+		if (target_write_memory (entry->u.mem.addr, loc,
 					 entry->u.mem.len))
 		  {
 		    entry->u.mem.mem_entry_not_accessible = 1;
@@ -872,8 +1617,10 @@ record_full_exec_insn (struct regcache *regcache,
 		  }
 		else
 		  {
-		    memcpy (record_full_get_loc (entry), mem.data (),
-			    entry->u.mem.len);
+		    if (record_full_mem_paged (entry))
+		      record_full_mem_set (entry, mem.data ());
+		    else
+		      memcpy (loc, mem.data (), entry->u.mem.len);
 
 		    /* We've changed memory --- check if a hardware
 		       watchpoint should trap.  Note that this
@@ -895,6 +1642,291 @@ record_full_exec_insn (struct regcache *regcache,
     }
 }
 
+/* The maximum number of pages of the inferior's memory that
+   record_full_replay_state keeps before writing them back.  */
+
+#define RECORD_FULL_MAX_SHADOW_PAGES 4096
+
+/* The inferior's registers and memory as seen while walking many
+   entries of the execution log.  Executing the entries one by one
+   with record_full_exec_insn stores each register and writes each
+   memory entry to the target, which makes going far back or forward
+   in a long recording slow.  This instead swaps the entries with the
+   register cache, without storing the registers, and with a copy of
+   the memory they touch.  The changed registers and memory
+   are written back to the target once, by flush.  */
+
+class record_full_replay_state
+{
+public:
+  explicit record_full_replay_state (struct regcache *regcache)
+    : m_regcache (regcache),
+      m_dirty_regs (gdbarch_num_regs (regcache->arch ()))
+  {
+  }
+
+  ~record_full_replay_state ();
+
+  DISABLE_COPY_AND_ASSIGN (record_full_replay_state);
+
+  /* Execute ENTRY, like record_full_exec_insn does.  Unless
+     CHECK_WATCHPOINTS is true, do not check whether a memory entry
+     hits a watchpoint, which the caller knows it cannot.  */
+  void exec (struct record_full_entry *entry, bool check_watchpoints);
+
+  /* Write the changed registers and memory back to the target.  */
+  void flush ();
+
+private:
+
+  struct page
+  {
+    /* The contents of the page.  Only the bytes set in LOADED were
+       read from the target.  */
+    gdb::byte_vector contents = gdb::byte_vector (RECORD_FULL_PAGE_SIZE);
+
+    /* The bytes of CONTENTS read from the target, and those changed
+       since.  */
+    std::bitset<RECORD_FULL_PAGE_SIZE> loaded;
+    std::bitset<RECORD_FULL_PAGE_SIZE> dirty;
+  };
+
+  bool load_range (CORE_ADDR addr, ULONGEST len);
+  void flush_page (CORE_ADDR page_addr, page &p);
+  void flush_range (CORE_ADDR addr, ULONGEST len);
+
+  struct regcache *m_regcache;
+
+  /* The registers supplied to M_REGCACHE but not stored yet.  */
+  std::vector<bool> m_dirty_regs;
+  bool m_any_dirty_reg = false;
+
+  /* The pages of memory copied so far, by address.  */
+  std::unordered_map<CORE_ADDR, page> m_pages;
+};
+
+record_full_replay_state::~record_full_replay_state ()
+{
+  try
+    {
+      flush ();
+    }
+  catch (const gdb_exception &ex)
+    {
+      exception_print (gdb_stderr, ex);
+    }
+}
+
+/* Read the bytes among LEN bytes at ADDR that are not copied yet.
+   Only the bytes of the entries are read, never the rest of their
+   pages, which may not be safe to read, for instance if they hold
+   memory-mapped device registers.  Return false if any of them cannot
+   be read.  */
+
+bool
+record_full_replay_state::load_range (CORE_ADDR addr, ULONGEST len)
+{
+  ULONGEST done = 0;
+
+  while (done < len)
+    {
+      CORE_ADDR page_addr
+	= (addr + done) & ~(CORE_ADDR) (RECORD_FULL_PAGE_SIZE - 1);
+      ULONGEST offset = addr + done - page_addr;
+      ULONGEST end = std::min (offset + len - done,
+			       (ULONGEST) RECORD_FULL_PAGE_SIZE);
+      page &p = m_pages[page_addr];
+
+      while (offset < end)
+	{
+	  if (p.loaded[offset])
+	    {
+	      ++offset;
+	      continue;
+	    }
+
+	  ULONGEST run_end = offset + 1;
+	  while (run_end < end && !p.loaded[run_end])
+	    ++run_end;
+
+	  if (target_read_memory (page_addr + offset,
+				  p.contents.data () + offset,
+				  run_end - offset) != 0)
+	    return false;
+
+	  for (; offset < run_end; ++offset)
+	    p.loaded.set (offset);
+	}
+
+      done = page_addr + end - addr;
+    }
+
+  return true;
+}
+
+/* Write the changed bytes of P, the page at PAGE_ADDR, back to the
+   target.  */
+
+void
+record_full_replay_state::flush_page (CORE_ADDR page_addr, page &p)
+{
+  if (p.dirty.none ())
+    return;
+
+  ULONGEST offset = 0;
+  while (offset < RECORD_FULL_PAGE_SIZE)
+    {
+      if (!p.dirty[offset])
+	{
+	  ++offset;
+	  continue;
+	}
+
+      ULONGEST end = offset + 1;
+      while (end < RECORD_FULL_PAGE_SIZE && p.dirty[end])
+	++end;
+
+      if (target_write_memory (page_addr + offset,
+			       p.contents.data () + offset, end - offset)
+	  && record_debug)
+	warning (_("Process record: error writing memory at "
+		   "addr = %s len = %s."),
+		 paddress (m_regcache->arch (), page_addr + offset),
+		 pulongest (end - offset));
+
+      offset = end;
+    }
+
+  p.dirty.reset ();
+}
+
+/* Write back and forget the pages covering LEN bytes at ADDR, so that
+   the target can be accessed directly there.  */
+
+void
+record_full_replay_state::flush_range (CORE_ADDR addr, ULONGEST len)
+{
+  CORE_ADDR page_addr = addr & ~(CORE_ADDR) (RECORD_FULL_PAGE_SIZE - 1);
+
+  for (; page_addr < addr + len; page_addr += RECORD_FULL_PAGE_SIZE)
+    {
+      auto iter = m_pages.find (page_addr);
+      if (iter != m_pages.end ())
+	{
+	  flush_page (iter->first, iter->second);
+	  m_pages.erase (iter);
+	}
+    }
+}
+
+void
+record_full_replay_state::exec (struct record_full_entry *entry,
+				bool check_watchpoints)
+{
+  struct gdbarch *gdbarch = m_regcache->arch ();
+
+  switch (entry->type)
+    {
+    case record_full_reg:
+      {
+	int regnum = entry->u.reg.num;
+	gdb::byte_vector reg (entry->u.reg.len);
+
+	m_regcache->cooked_read (regnum, reg.data ());
+	m_regcache->raw_supply (regnum, record_full_get_loc (entry));
+	memcpy (record_full_get_loc (entry), reg.data (), entry->u.reg.len);
+	m_dirty_regs[regnum] = true;
+	m_any_dirty_reg = true;
+      }
+      break;
+
+    case record_full_mem:
+      {
+	if (entry->u.mem.mem_entry_not_accessible)
+	  break;
+
+	CORE_ADDR addr = entry->u.mem.addr;
+	ULONGEST len = entry->u.mem.len;
+
+	if (m_pages.size () >= RECORD_FULL_MAX_SHADOW_PAGES)
+	  flush ();
+
+	if (!load_range (addr, len))
+	  {
+	    /* Part of the entry cannot be copied.  Execute it on the
+	       target, as record_full_exec_insn would.  */
+	    flush_range (addr, len);
+	    record_full_exec_insn (m_regcache, gdbarch, entry);
+	    break;
+	  }
+
+	/* Swap the contents of paged entries through a copy.  */
+	gdb::byte_vector contents;
+	gdb_byte *loc;
+	if (record_full_mem_paged (entry))
+	  {
+	    contents.resize (len);
+	    record_full_mem_get (entry, contents.data ());
+	    loc = contents.data ();
+	  }
+	else
+	  loc = record_full_get_loc (entry);
+
+	for (ULONGEST done = 0; done < len; )
+	  {
+	    CORE_ADDR page_addr
+	      = (addr + done) & ~(CORE_ADDR) (RECORD_FULL_PAGE_SIZE - 1);
+	    page &p = m_pages.at (page_addr);
+	    ULONGEST offset = addr + done - page_addr;
+	    ULONGEST n = std::min (len - done,
+				   RECORD_FULL_PAGE_SIZE - offset);
+
+	    std::swap_ranges (loc + done, loc + done + n,
+			      p.contents.data () + offset);
+	    for (ULONGEST i = offset; i < offset + n; ++i)
+	      p.dirty.set (i);
+	    done += n;
+	  }
+
+	if (record_full_mem_paged (entry))
+	  record_full_mem_set (entry, contents.data ());
+
+	/* See record_full_exec_insn.  */
+	if (check_watchpoints
+	    && hardware_watchpoint_inserted_in_range (m_regcache->aspace (),
+						      addr, len))
+	  record_full_stop_reason = TARGET_STOPPED_BY_WATCHPOINT;
+      }
+      break;
+    }
+}
+
+void
+record_full_replay_state::flush ()
+{
+  if (m_any_dirty_reg)
+    {
+      target_prepare_to_store (m_regcache);
+      for (int regnum = 0; regnum < m_dirty_regs.size (); regnum++)
+	if (m_dirty_regs[regnum])
+	  {
+	    m_dirty_regs[regnum] = false;
+
+	    /* As in regcache::raw_write, do not trust the cached value
+	       if it could not be stored.  */
+	    auto invalidator
+	      = make_scope_exit ([&] { m_regcache->invalidate (regnum); });
+	    target_store_registers (m_regcache, regnum);
+	    invalidator.release ();
+	  }
+      m_any_dirty_reg = false;
+    }
+
+  for (auto &iter : m_pages)
+    flush_page (iter.first, iter.second);
+  m_pages.clear ();
+}
+
 static void record_full_restore (void);
 
 /* Asynchronous signal handle registered as event loop source for when
@@ -968,7 +2000,7 @@ record_full_open (const char *name, int from_tty)
   record_full_insn_num = 0;
   record_full_insn_count = 0;
   record_full_list = &record_full_first;
-  record_full_list->next = NULL;
+  record_full_list_release ();
 
   if (core_bfd)
     record_full_core_open_1 (name, from_tty);
@@ -995,7 +2027,7 @@ record_full_base_target::close ()
   if (record_debug)
     gdb_printf (gdb_stdlog, "Process record: record_full_close\n");
 
-  record_full_list_release (record_full_list);
+  record_full_list_release ();
 
   /* Release record_full_core_regbuf.  */
   if (record_full_core_regbuf)
@@ -1124,6 +2156,24 @@ record_full_sig_handler (int signo)
   record_full_get_sig = 1;
 }
 
+/* Return the number of the last instruction not after INSN_NUM that
+   may have written memory in one of RANGES, or 0 if there is none.  */
+
+static ULONGEST
+record_full_last_write_in
+  (const std::vector<std::pair<CORE_ADDR, ULONGEST>> &ranges,
+   ULONGEST insn_num)
+{
+  ULONGEST result = 0;
+
+  for (const auto &range : ranges)
+    result = std::max (result, record_full_writes.last_write (range.first,
+							      range.second,
+							      insn_num));
+
+  return result;
+}
+
 /* "wait" target method for process record target.
 
    In record mode, the target is always run in singlestep mode
@@ -1292,6 +2342,26 @@ record_full_wait_1 (struct target_ops *ops,
       int continue_flag = 1;
       int first_record_full_end = 1;
 
+      /* Apply the log to a copy of the inferior's state, which is
+	 written back when we stop.  */
+      record_full_replay_state state (regcache);
+
+      /* When going backward, only undoing the last instruction that
+	 wrote the memory watched by the hardware watchpoints can hit
+	 one of them.  WATCH_INSN is that instruction, looked up in
+	 record_full_writes, and the memory entries of the instructions
+	 after it are undone without checking the watchpoints.  */
+      std::vector<std::pair<CORE_ADDR, ULONGEST>> watched;
+      ULONGEST watch_insn = ULONGEST_MAX;
+      bool check_watchpoints = true;
+
+      if (execution_direction == EXEC_REVERSE)
+	{
+	  watched = hardware_watchpoint_inserted_ranges (aspace);
+	  if (!watched.empty ())
+	    record_full_update_writes ();
+	}
+
       try
 	{
 	  CORE_ADDR tmp_pc;
@@ -1323,8 +2393,9 @@ record_full_wait_1 (struct target_ops *ops,
 
 	  /* In EXEC_FORWARD mode, record_full_list points to the tail of prev
 	     instruction.  */
-	  if (execution_direction == EXEC_FORWARD && record_full_list->next)
-	    record_full_list = record_full_list->next;
+	  if (execution_direction == EXEC_FORWARD
+	      && record_full_next (record_full_list))
+	    record_full_list = record_full_next (record_full_list);
 
 	  /* Loop over the record_full_list, looking for the next place to
 	     stop.  */
@@ -1339,14 +2410,26 @@ record_full_wait_1 (struct target_ops *ops,
 		  break;
 		}
 	      if (execution_direction != EXEC_REVERSE
-		  && !record_full_list->next)
+		  && !record_full_next (record_full_list))
 		{
 		  /* Hit end of record log going forward.  */
 		  status->set_no_history ();
 		  break;
 		}
 
-	      record_full_exec_insn (regcache, gdbarch, record_full_list);
+	      /* In EXEC_REVERSE mode, the entries following a
+		 record_full_end are those of its instruction.  */
+	      if (execution_direction == EXEC_REVERSE
+		  && record_full_list->type == record_full_end)
+		{
+		  ULONGEST insn_num = record_full_list->u.end.insn_num;
+
+		  if (insn_num < watch_insn)
+		    watch_insn = record_full_last_write_in (watched, insn_num);
+		  check_watchpoints = (insn_num == watch_insn);
+		}
+
+	      state.exec (record_full_list, check_watchpoints);
 
 	      if (record_full_list->type == record_full_end)
 		{
@@ -1416,19 +2499,21 @@ record_full_wait_1 (struct target_ops *ops,
 		{
 		  if (execution_direction == EXEC_REVERSE)
 		    {
-		      if (record_full_list->prev)
-			record_full_list = record_full_list->prev;
+		      if (record_full_prev (record_full_list))
+			record_full_list = record_full_prev (record_full_list);
 		    }
 		  else
 		    {
-		      if (record_full_list->next)
-			record_full_list = record_full_list->next;
+		      if (record_full_next (record_full_list))
+			record_full_list = record_full_next (record_full_list);
 		    }
 		}
 	    }
 	  while (continue_flag);
 
 	replay_out:
+	  state.flush ();
+
 	  if (status->kind () == TARGET_WAITKIND_STOPPED)
 	    {
 	      if (record_full_get_sig)
@@ -1444,11 +2529,11 @@ record_full_wait_1 (struct target_ops *ops,
 	{
 	  if (execution_direction == EXEC_REVERSE)
 	    {
-	      if (record_full_list->next)
-		record_full_list = record_full_list->next;
+	      if (record_full_next (record_full_list))
+		record_full_list = record_full_next (record_full_list);
 	    }
 	  else
-	    record_full_list = record_full_list->prev;
+	    record_full_list = record_full_prev (record_full_list);
 
 	  throw;
 	}
@@ -1549,7 +2634,7 @@ record_full_registers_change (struct regcache *regcache, int regnum)
 	{
 	  if (record_full_arch_list_add_reg (regcache, i))
 	    {
-	      record_full_list_release (record_full_arch_list_tail);
+	      record_full_arch_list_release ();
 	      error (_("Process record: failed to record execution log."));
 	    }
 	}
@@ -1558,17 +2643,15 @@ record_full_registers_change (struct regcache *regcache, int regnum)
     {
       if (record_full_arch_list_add_reg (regcache, regnum))
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_release ();
 	  error (_("Process record: failed to record execution log."));
 	}
     }
   if (record_full_arch_list_add_end ())
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_release ();
       error (_("Process record: failed to record execution log."));
     }
-  record_full_list->next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = record_full_list;
   record_full_list = record_full_arch_list_tail;
 
   if (record_full_insn_num == record_full_insn_max_num)
@@ -1667,7 +2750,7 @@ record_full_target::xfer_partial (enum target_object object,
       record_full_arch_list_tail = NULL;
       if (record_full_arch_list_add_mem (offset, len))
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_release ();
 	  if (record_debug)
 	    gdb_printf (gdb_stdlog,
 			"Process record: failed to record "
@@ -1676,15 +2759,13 @@ record_full_target::xfer_partial (enum target_object object,
 	}
       if (record_full_arch_list_add_end ())
 	{
-	  record_full_list_release (record_full_arch_list_tail);
+	  record_full_arch_list_release ();
 	  if (record_debug)
 	    gdb_printf (gdb_stdlog,
 			"Process record: failed to record "
 			"execution log.");
 	  return TARGET_XFER_E_IO;
 	}
-      record_full_list->next = record_full_arch_list_head;
-      record_full_arch_list_head->prev = record_full_list;
       record_full_list = record_full_arch_list_tail;
 
       if (record_full_insn_num == record_full_insn_max_num)
@@ -1912,9 +2993,9 @@ record_full_base_target::info_record ()
     gdb_printf (_("Record mode:\n"));
 
   /* Find entry for first actual instruction in the log.  */
-  for (p = record_full_first.next;
+  for (p = record_full_next (&record_full_first);
        p != NULL && p->type != record_full_end;
-       p = p->next)
+       p = record_full_next (p))
     ;
 
   /* Do we have a log at all?  */
@@ -2014,7 +3095,7 @@ record_full_base_target::goto_record_begin ()
 {
   struct record_full_entry *p = NULL;
 
-  for (p = &record_full_first; p != NULL; p = p->next)
+  for (p = &record_full_first; p != NULL; p = record_full_next (p))
     if (p->type == record_full_end)
       break;
 
@@ -2026,11 +3107,11 @@ record_full_base_target::goto_record_begin ()
 void
 record_full_base_target::goto_record_end ()
 {
-  struct record_full_entry *p = NULL;
+  struct record_full_entry *p = &record_full_first;
 
-  for (p = record_full_list; p->next != NULL; p = p->next)
-    ;
-  for (; p!= NULL; p = p->prev)
+  if (record_full_chunk_last != NULL)
+    p = &record_full_chunk_last->entries[record_full_chunk_last->end - 1];
+  for (; p!= NULL; p = record_full_prev (p))
     if (p->type == record_full_end)
       break;
 
@@ -2043,10 +3124,25 @@ void
 record_full_base_target::goto_record (ULONGEST target_insn)
 {
   struct record_full_entry *p = NULL;
-
-  for (p = &record_full_first; p != NULL; p = p->next)
-    if (p->type == record_full_end && p->u.end.insn_num == target_insn)
-      break;
+  struct record_full_chunk *chunk = record_full_chunk_first;
+
+  /* Skip the chunks that end before TARGET_INSN, then look for it in
+     the log from there.  */
+  while (chunk != NULL && chunk->last_insn_num < target_insn)
+    chunk = chunk->next;
+
+  if (target_insn == record_full_first.u.end.insn_num)
+    p = &record_full_first;
+  else if (chunk != NULL)
+    for (p = &chunk->entries[chunk->begin];
+	 p != NULL;
+	 p = record_full_next (p))
+      if (p->type == record_full_end && p->u.end.insn_num >= target_insn)
+	{
+	  if (p->u.end.insn_num != target_insn)
+	    p = NULL;
+	  break;
+	}
 
   record_full_goto_entry (p);
 }
@@ -2333,7 +3429,7 @@ record_full_restore (void)
     return;
 
   /* "record_full_restore" can only be called when record list is empty.  */
-  gdb_assert (record_full_first.next == NULL);
+  gdb_assert (record_full_chunk_first == NULL);
  
   if (record_debug)
     gdb_printf (gdb_stdlog, "Restoring recording from core file.\n");
@@ -2360,8 +3456,7 @@ record_full_restore (void)
 		"RECORD_FULL_FILE_MAGIC (0x%s)\n",
 		phex_nz (netorder32 (magic), 4));
 
-  /* Restore the entries in recfd into record_full_arch_list_head and
-     record_full_arch_list_tail.  */
+  /* Restore the entries in recfd into the arch list.  */
   record_full_arch_list_head = NULL;
   record_full_arch_list_tail = NULL;
   record_full_insn_num = 0;
@@ -2418,8 +3513,17 @@ record_full_restore (void)
 	      rec = record_full_mem_alloc (addr, len);
 
 	      /* Get val.  */
-	      bfdcore_read (core_bfd, osec, record_full_get_loc (rec),
-			    rec->u.mem.len, &bfd_offset);
+	      if (record_full_mem_paged (rec))
+		{
+		  gdb::byte_vector contents (len);
+
+		  bfdcore_read (core_bfd, osec, contents.data (), len,
+				&bfd_offset);
+		  record_full_mem_set (rec, contents.data ());
+		}
+	      else
+		bfdcore_read (core_bfd, osec, record_full_get_loc (rec),
+			      rec->u.mem.len, &bfd_offset);
 
 	      if (record_debug)
 		gdb_printf (gdb_stdlog,
@@ -2470,14 +3574,14 @@ record_full_restore (void)
     }
   catch (const gdb_exception &ex)
     {
-      record_full_list_release (record_full_arch_list_tail);
+      record_full_arch_list_release ();
+      record_full_writes.clear ();
+      record_full_writes_through = 0;
       throw;
     }
 
-  /* Add record_full_arch_list_head to the end of record list.  */
-  record_full_first.next = record_full_arch_list_head;
-  record_full_arch_list_head->prev = &record_full_first;
-  record_full_arch_list_tail->next = NULL;
+  /* The restored entries are already in the log, right after
+     record_full_first.  */
   record_full_list = &record_full_first;
 
   /* Update record_full_insn_max_num.  */
@@ -2557,22 +3661,25 @@ record_full_base_target::save_record (const char *recfilename)
     = record_full_gdb_operation_disable_set ();
 
   /* Reverse execute to the begin of record list.  */
+  record_full_replay_state state (regcache);
   while (1)
     {
       /* Check for beginning and end of log.  */
       if (record_full_list == &record_full_first)
 	break;
 
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+      state.exec (record_full_list, false);
 
-      if (record_full_list->prev)
-	record_full_list = record_full_list->prev;
+      if (record_full_prev (record_full_list))
+	record_full_list = record_full_prev (record_full_list);
     }
+  state.flush ();
 
   /* Compute the size needed for the extra bfd section.  */
   save_size = 4;	/* magic cookie */
-  for (record_full_list = record_full_first.next; record_full_list;
-       record_full_list = record_full_list->next)
+  for (record_full_list = record_full_next (&record_full_first);
+       record_full_list;
+       record_full_list = record_full_next (record_full_list))
     switch (record_full_list->type)
       {
       case record_full_end:
@@ -2670,9 +3777,18 @@ record_full_base_target::save_record (const char *recfilename)
 			     sizeof (addr), &bfd_offset);
 
 	      /* Write memval.  */
-	      bfdcore_write (obfd.get (), osec,
-			     record_full_get_loc (record_full_list),
-			     record_full_list->u.mem.len, &bfd_offset);
+	      if (record_full_mem_paged (record_full_list))
+		{
+		  gdb::byte_vector contents (record_full_list->u.mem.len);
+
+		  record_full_mem_get (record_full_list, contents.data ());
+		  bfdcore_write (obfd.get (), osec, contents.data (),
+				 contents.size (), &bfd_offset);
+		}
+	      else
+		bfdcore_write (obfd.get (), osec,
+			       record_full_get_loc (record_full_list),
+			       record_full_list->u.mem.len, &bfd_offset);
 	      break;
 
 	      case record_full_end:
@@ -2696,10 +3812,10 @@ record_full_base_target::save_record (const char *recfilename)
 	}
 
       /* Execute entry.  */
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+      state.exec (record_full_list, false);
 
-      if (record_full_list->next)
-	record_full_list = record_full_list->next;
+      if (record_full_next (record_full_list))
+	record_full_list = record_full_next (record_full_list);
       else
 	break;
     }
@@ -2711,11 +3827,12 @@ record_full_base_target::save_record (const char *recfilename)
       if (record_full_list == cur_record_full_list)
 	break;
 
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+      state.exec (record_full_list, false);
 
-      if (record_full_list->prev)
-	record_full_list = record_full_list->prev;
+      if (record_full_prev (record_full_list))
+	record_full_list = record_full_prev (record_full_list);
     }
+  state.flush ();
 
   unlink_file.keep ();
 
@@ -2735,22 +3852,23 @@ record_full_goto_insn (struct record_full_entry *entry,
   scoped_restore restore_operation_disable
     = record_full_gdb_operation_disable_set ();
   struct regcache *regcache = get_current_regcache ();
-  struct gdbarch *gdbarch = regcache->arch ();
 
   /* Assume everything is valid: we will hit the entry,
      and we will not hit the end of the recording.  */
 
   if (dir == EXEC_FORWARD)
-    record_full_list = record_full_list->next;
+    record_full_list = record_full_next (record_full_list);
 
+  record_full_replay_state state (regcache);
   do
     {
-      record_full_exec_insn (regcache, gdbarch, record_full_list);
+      state.exec (record_full_list, false);
       if (dir == EXEC_REVERSE)
-	record_full_list = record_full_list->prev;
+	record_full_list = record_full_prev (record_full_list);
       else
-	record_full_list = record_full_list->next;
+	record_full_list = record_full_next (record_full_list);
     } while (record_full_list != entry);
+  state.flush ();
 }
 
 /* Alias for "target record-full".  */
@@ -2790,9 +3908,9 @@ maintenance_print_record_instruction (const char *args, int from_tty)
 	{
 	  /* Move forward OFFSET instructions.  We know we found the
 	     end of an instruction when to_print->type is record_full_end.  */
-	  while (to_print->next != nullptr && offset > 0)
+	  while (record_full_next (to_print) != nullptr && offset > 0)
 	    {
-	      to_print = to_print->next;
+	      to_print = record_full_next (to_print);
 	      if (to_print->type == record_full_end)
 		offset--;
 	    }
@@ -2801,9 +3919,9 @@ maintenance_print_record_instruction (const char *args, int from_tty)
 	}
       else
 	{
-	  while (to_print->prev != nullptr && offset < 0)
+	  while (record_full_prev (to_print) != nullptr && offset < 0)
 	    {
-	      to_print = to_print->prev;
+	      to_print = record_full_prev (to_print);
 	      if (to_print->type == record_full_end)
 		offset++;
 	    }
@@ -2814,8 +3932,9 @@ maintenance_print_record_instruction (const char *args, int from_tty)
   gdb_assert (to_print != nullptr);
 
   /* Go back to the start of the instruction.  */
-  while (to_print->prev != nullptr && to_print->prev->type != record_full_end)
-    to_print = to_print->prev;
+  while (record_full_prev (to_print) != nullptr
+	 && record_full_prev (to_print)->type != record_full_end)
+    to_print = record_full_prev (to_print);
 
   /* if we're in the first record, there are no actual instructions
      recorded.  Warn the user and leave.  */
@@ -2845,7 +3964,16 @@ maintenance_print_record_instruction (const char *args, int from_tty)
 	    }
 	  case record_full_mem:
 	    {
-	      gdb_byte *b = record_full_get_loc (to_print);
+	      gdb::byte_vector contents;
+	      gdb_byte *b;
+	      if (record_full_mem_paged (to_print))
+		{
+		  contents.resize (to_print->u.mem.len);
+		  record_full_mem_get (to_print, contents.data ());
+		  b = contents.data ();
+		}
+	      else
+		b = record_full_get_loc (to_print);
 	      gdb_printf ("%d bytes of memory at address %s changed from:",
 			  to_print->u.mem.len,
 			  print_core_address (target_gdbarch (),
@@ -2856,7 +3984,7 @@ maintenance_print_record_instruction (const char *args, int from_tty)
 	      break;
 	    }
 	}
-      to_print = to_print->next;
+      to_print = record_full_next (to_print);
     }
 }
 
@@ -2867,8 +3995,6 @@ _initialize_record_full ()
   struct cmd_list_element *c;
 
   /* Init record_full_first.  */
-  record_full_first.prev = NULL;
-  record_full_first.next = NULL;
   record_full_first.type = record_full_end;
 
   add_target (record_full_target_info, record_full_open);
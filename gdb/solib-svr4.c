@@ -46,6 +46,7 @@
 #include "probe.h"
 
 #include <map>
+#include <unordered_map>
 
 static struct link_map_offsets *svr4_fetch_link_map_offsets (void);
 static int svr4_have_link_map_offsets (void);
@@ -385,6 +386,12 @@ struct svr4_info
      The special entry zero is reserved for a linear list to support
      gdbstubs that do not support namespaces.  */
   std::map<CORE_ADDR, so_list *> solib_lists;
+
+  /* True if a library was unloaded since SOLIB_LISTS was read.  The
+     dynamic linker may then reuse its link map entry, and the memory
+     holding its name, for a different library, so the next full read
+     does not reuse the names in SOLIB_LISTS.  */
+  bool unloaded_since_read = false;
 };
 
 /* Per-program-space data key.  */
@@ -783,6 +790,37 @@ solib_svr4_r_map (CORE_ADDR debug_base)
   return addr;
 }
 
+/* Values of the r_state member of struct r_debug.  */
+
+enum svr4_r_state
+{
+  SVR4_RT_CONSISTENT,
+  SVR4_RT_ADD,
+  SVR4_RT_DELETE
+};
+
+/* Return the r_state member of the r_debug object at DEBUG_BASE, or
+   -1 if it cannot be read.  r_state follows r_brk.  */
+
+static int
+solib_svr4_r_state (CORE_ADDR debug_base)
+{
+  struct link_map_offsets *lmo = svr4_fetch_link_map_offsets ();
+  struct type *ptr_type = builtin_type (target_gdbarch ())->builtin_data_ptr;
+  bfd_endian byte_order = type_byte_order (ptr_type);
+
+  try
+    {
+      return read_memory_unsigned_integer (debug_base + lmo->r_brk_offset
+					   + ptr_type->length (),
+					   4, byte_order);
+    }
+  catch (const gdb_exception_error &ex)
+    {
+      return -1;
+    }
+}
+
 /* Find r_brk from the inferior's debug base.  */
 
 static CORE_ADDR
@@ -1258,17 +1296,48 @@ svr4_default_sos (svr4_info *info)
   return newobj;
 }
 
+/* Map from the address of a link map entry to the library previously
+   read from it.  */
+
+using svr4_so_by_lm_map = std::unordered_map<CORE_ADDR, const so_list *>;
+
+/* Return the library in KNOWN_SOS that was read from the same link map
+   entry as LI, or NULL if there is none, or if the entry changed since.  */
+
+static const so_list *
+svr4_find_known_so (const svr4_so_by_lm_map *known_sos,
+		    const lm_info_svr4 *li)
+{
+  if (known_sos == nullptr)
+    return nullptr;
+
+  auto it = known_sos->find (li->lm_addr);
+  if (it == known_sos->end ())
+    return nullptr;
+
+  const lm_info_svr4 *known_li = (const lm_info_svr4 *) it->second->lm_info;
+  if (known_li->l_name != li->l_name
+      || known_li->l_addr_inferior != li->l_addr_inferior
+      || known_li->l_ld != li->l_ld)
+    return nullptr;
+
+  return it->second;
+}
+
 /* Read the whole inferior libraries chain starting at address LM.
    Expect the first entry in the chain's previous entry to be PREV_LM.
    Add the entries to the tail referenced by LINK_PTR_PTR.  Ignore the
    first entry if IGNORE_FIRST and set global MAIN_LM_ADDR according
-   to it.  Returns nonzero upon success.  If zero is returned the
-   entries stored to LINK_PTR_PTR are still valid although they may
-   represent only part of the inferior library list.  */
+   to it.  If KNOWN_SOS is not NULL, the names of the entries found in
+   it are not read from the inferior again.  Returns nonzero upon
+   success.  If zero is returned the entries stored to LINK_PTR_PTR are
+   still valid although they may represent only part of the inferior
+   library list.  */
 
 static int
 svr4_read_so_list (svr4_info *info, CORE_ADDR lm, CORE_ADDR prev_lm,
-		   struct so_list ***link_ptr_ptr, int ignore_first)
+		   struct so_list ***link_ptr_ptr, int ignore_first,
+		   const svr4_so_by_lm_map *known_sos = nullptr)
 {
   CORE_ADDR first_l_name = 0;
   CORE_ADDR next_lm;
@@ -1304,23 +1373,34 @@ svr4_read_so_list (svr4_info *info, CORE_ADDR lm, CORE_ADDR prev_lm,
 	  continue;
 	}
 
-      /* Extract this shared object's name.  */
-      gdb::unique_xmalloc_ptr<char> buffer
-	= target_read_string (li->l_name, SO_NAME_MAX_PATH_SIZE - 1);
-      if (buffer == nullptr)
+      const so_list *known = svr4_find_known_so (known_sos, li);
+      if (known != nullptr)
 	{
-	  /* If this entry's l_name address matches that of the
-	     inferior executable, then this is not a normal shared
-	     object, but (most likely) a vDSO.  In this case, silently
-	     skip it; otherwise emit a warning. */
-	  if (first_l_name == 0 || li->l_name != first_l_name)
-	    warning (_("Can't read pathname for load map."));
-	  continue;
+	  /* This library was already loaded the last time we read the
+	     list, which saves reading its name again.  */
+	  strcpy (newobj->so_name, known->so_original_name);
+	  strcpy (newobj->so_original_name, known->so_original_name);
 	}
+      else
+	{
+	  /* Extract this shared object's name.  */
+	  gdb::unique_xmalloc_ptr<char> buffer
+	    = target_read_string (li->l_name, SO_NAME_MAX_PATH_SIZE - 1);
+	  if (buffer == nullptr)
+	    {
+	      /* If this entry's l_name address matches that of the
+		 inferior executable, then this is not a normal shared
+		 object, but (most likely) a vDSO.  In this case, silently
+		 skip it; otherwise emit a warning. */
+	      if (first_l_name == 0 || li->l_name != first_l_name)
+		warning (_("Can't read pathname for load map."));
+	      continue;
+	    }
 
-      strncpy (newobj->so_name, buffer.get (), SO_NAME_MAX_PATH_SIZE - 1);
-      newobj->so_name[SO_NAME_MAX_PATH_SIZE - 1] = '\0';
-      strcpy (newobj->so_original_name, newobj->so_name);
+	  strncpy (newobj->so_name, buffer.get (), SO_NAME_MAX_PATH_SIZE - 1);
+	  newobj->so_name[SO_NAME_MAX_PATH_SIZE - 1] = '\0';
+	  strcpy (newobj->so_original_name, newobj->so_name);
+	}
 
       /* If this entry has no name, or its name matches the name
 	 for the main executable, don't include it in the list.  */
@@ -1348,8 +1428,16 @@ svr4_current_sos_direct (struct svr4_info *info)
   bool ignore_first;
   struct svr4_library_list library_list;
 
-  /* Remove any old libraries.  We're going to read them back in again.  */
-  free_solib_lists (info);
+  /* Remove any old libraries.  We're going to read them back in again,
+     but keep them around until we are done so that we can skip reading
+     the names of those that are still loaded.  */
+  std::map<CORE_ADDR, so_list *> old_solib_lists;
+  std::swap (old_solib_lists, info->solib_lists);
+  SCOPE_EXIT
+    {
+      for (const std::pair<CORE_ADDR, so_list *> tuple : old_solib_lists)
+	svr4_free_library_list (tuple.second);
+    };
 
   /* Fall back to manual examination of the target if the packet is not
      supported or gdbserver failed to find DT_DEBUG.  gdb.server/solib-list.exp
@@ -1388,6 +1476,13 @@ svr4_current_sos_direct (struct svr4_info *info)
   if (info->debug_base == 0)
     return;
 
+  /* Without the probes interface, we are called for each event of the
+     dynamic linker, and r_state tells whether a library is being
+     unloaded.  */
+  if (info->probes_table == nullptr
+      && solib_svr4_r_state (info->debug_base) == SVR4_RT_DELETE)
+    info->unloaded_since_read = true;
+
   /* Assume that everything is a library if the dynamic loader was loaded
      late by a static executable.  */
   if (current_program_space->exec_bfd ()
@@ -1402,6 +1497,13 @@ svr4_current_sos_direct (struct svr4_info *info)
       free_solib_lists (info);
     });
 
+  svr4_so_by_lm_map known_sos;
+  if (!info->unloaded_since_read)
+    for (const std::pair<CORE_ADDR, so_list *> tuple : old_solib_lists)
+      for (const so_list *so = tuple.second; so != nullptr; so = so->next)
+	known_sos[((const lm_info_svr4 *) so->lm_info)->lm_addr] = so;
+  info->unloaded_since_read = false;
+
   /* Collect the sos in each namespace.  */
   CORE_ADDR debug_base = info->debug_base;
   for (; debug_base != 0;
@@ -1414,7 +1516,7 @@ svr4_current_sos_direct (struct svr4_info *info)
 	  so_list **sos = &info->solib_lists[debug_base];
 	  *sos = nullptr;
 
-	  svr4_read_so_list (info, lm, 0, &sos, ignore_first);
+	  svr4_read_so_list (info, lm, 0, &sos, ignore_first, &known_sos);
 	}
     }
 
@@ -1435,7 +1537,7 @@ svr4_current_sos_direct (struct svr4_info *info)
 	{
 	  so_list **sos = &info->solib_lists[debug_base];
 	  *sos = nullptr;
-	  svr4_read_so_list (info, debug_base, 0, &sos, 0);
+	  svr4_read_so_list (info, debug_base, 0, &sos, 0, &known_sos);
 	}
     }
 
@@ -1997,6 +2099,10 @@ svr4_handle_solib_event (void)
   if (action == PROBES_INTERFACE_FAILED)
     return;
 
+  /* The link map entries of unloaded libraries may be reused.  */
+  if (startswith (pa->prob->get_name (), "unmap_"))
+    info->unloaded_since_read = true;
+
   if (action == DO_NOTHING)
     {
       cleanup.release ();
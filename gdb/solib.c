@@ -30,6 +30,7 @@
 #include "target.h"
 #include "frame.h"
 #include "inferior.h"
+#include "gdbthread.h"
 #include "gdbsupport/environ.h"
 #include "cli/cli-cmds.h"
 #include "elf/external.h"
@@ -48,6 +49,8 @@
 #include "debuginfod-support.h"
 #include "source.h"
 #include "cli/cli-style.h"
+#include "async-event.h"
+#include <deque>
 
 /* See solib.h.  */
 
@@ -679,6 +682,119 @@ free_so (struct so_list *so)
 }
 
 
+/* If true, the debug information of newly loaded shared libraries is
+   indexed from the event loop, after the inferior has been resumed,
+   rather than before the library load event is reported.  */
+
+static bool solib_background_read = false;
+
+/* Objfiles of shared libraries whose debug information has not been
+   indexed yet, in the order the libraries were loaded.  */
+
+static std::deque<objfile *> solib_background_read_queue;
+
+/* Event handler that indexes the objfiles in
+   SOLIB_BACKGROUND_READ_QUEUE.  */
+
+static async_event_handler *solib_background_read_event;
+
+/* Objfiles whose debug information was read while the inferior was
+   running on an all-stop target, and whose breakpoints have not been
+   re-set yet.  */
+
+static std::vector<objfile *> solib_background_read_reset_queue;
+
+/* Re-set the breakpoints that may resolve to something in OBJFILE,
+   whose debug information has just been read.  An all-stop target
+   can't have breakpoints inserted while the inferior runs, so in that
+   case this is done at the next stop instead.  */
+
+static void
+solib_background_read_reset (objfile *objfile)
+{
+  process_stratum_target *target = current_inferior ()->process_target ();
+  if (target != nullptr
+      && !target_is_non_stop_p ()
+      && threads_are_executing (target))
+    {
+      solib_background_read_reset_queue.push_back (objfile);
+      return;
+    }
+
+  breakpoint_re_set_new_objfiles ({objfile});
+}
+
+/* Re-set the breakpoints of the objfiles in
+   SOLIB_BACKGROUND_READ_RESET_QUEUE, now that the inferior stopped.  */
+
+static void
+solib_background_read_normal_stop (struct bpstat *, int)
+{
+  std::vector<objfile *> objfiles
+    = std::move (solib_background_read_reset_queue);
+  solib_background_read_reset_queue.clear ();
+
+  for (objfile *objfile : objfiles)
+    {
+      scoped_restore_current_program_space restore_pspace;
+      set_current_program_space (objfile->pspace);
+      breakpoint_re_set_new_objfiles ({objfile});
+    }
+}
+
+/* Index the debug information of the oldest objfile in
+   SOLIB_BACKGROUND_READ_QUEUE.  Only one objfile is read per call, so
+   that user input and target events are serviced in between.  */
+
+static void
+solib_background_read_handler (gdb_client_data)
+{
+  if (solib_background_read_queue.empty ())
+    return;
+
+  objfile *objfile = solib_background_read_queue.front ();
+  solib_background_read_queue.pop_front ();
+  if (!solib_background_read_queue.empty ())
+    mark_async_event_handler (solib_background_read_event);
+
+  scoped_restore_current_program_space restore_pspace;
+  set_current_program_space (objfile->pspace);
+
+  /* The DWARF reader scans the units of OBJFILE on the worker
+     threads; only starting that and waiting for it happens here.  */
+  try
+    {
+      for (struct objfile *iter : objfile->separate_debug_objfiles ())
+	iter->require_partial_symbols (false);
+    }
+  catch (const gdb_exception_error &e)
+    {
+      exception_fprintf (gdb_stderr, e, _("Error while reading shared"
+					  " library symbols for %s:\n"),
+			 objfile_name (objfile));
+    }
+
+  /* Until now, breakpoints could only use the minimal symbols of
+     OBJFILE.  */
+  solib_background_read_reset (objfile);
+}
+
+/* Forget about OBJFILE if it is about to be freed before its debug
+   information was read in the background.  */
+
+static void
+solib_background_read_forget (struct objfile *objfile)
+{
+  auto &queue = solib_background_read_queue;
+  queue.erase (std::remove (queue.begin (), queue.end (), objfile),
+	       queue.end ());
+
+  auto &reset_queue = solib_background_read_reset_queue;
+  reset_queue.erase (std::remove (reset_queue.begin (), reset_queue.end (),
+				  objfile),
+		     reset_queue.end ());
+}
+
 /* Read in symbols for shared object SO.  If SYMFILE_VERBOSE is set in FLAGS,
    be chatty about it.  Return true if any symbols were actually loaded.  */
 
@@ -699,6 +815,14 @@ solib_read_symbols (struct so_list *so, symfile_add_flags flags)
 
       flags |= current_inferior ()->symfile_flags;
 
+      /* Only the minimal symbols are read now; the debug information
+	 is indexed later from the event loop, or as soon as a lookup
+	 needs it.  */
+      bool read_in_background = (solib_background_read
+				 && (flags & SYMFILE_NO_READ) == 0);
+      if (read_in_background)
+	flags |= SYMFILE_NO_READ;
+
       try
 	{
 	  /* Have we already loaded this shared object?  */
@@ -722,6 +846,14 @@ solib_read_symbols (struct so_list *so, symfile_add_flags flags)
 						      flags, &sap,
 						      OBJF_SHARED, NULL);
 	      so->objfile->addr_low = so->addr_low;
+
+	      if (read_in_background)
+		{
+		  for (objfile *iter : so->objfile->separate_debug_objfiles ())
+		    iter->flags |= OBJF_PSYMTABS_DEFERRED;
+		  solib_background_read_queue.push_back (so->objfile);
+		  mark_async_event_handler (solib_background_read_event);
+		}
 	    }
 
 	  so->symbols_loaded = 1;
@@ -1018,6 +1150,8 @@ solib_add (const char *pattern, int from_tty, int readsyms)
   {
     bool any_matches = false;
     bool loaded_any_symbols = false;
+    bool read_all_objfiles = true;
+    std::vector<objfile *> new_objfiles;
     symfile_add_flags add_flags = SYMFILE_DEFER_BP_RESET;
 
     if (from_tty)
@@ -1046,12 +1180,27 @@ solib_add (const char *pattern, int from_tty, int readsyms)
 				gdb->so_name);
 		}
 	      else if (solib_read_symbols (gdb, add_flags))
-		loaded_any_symbols = true;
+		{
+		  loaded_any_symbols = true;
+		  if (gdb->objfile != nullptr)
+		    new_objfiles.push_back (gdb->objfile);
+		  else
+		    read_all_objfiles = false;
+		}
 	    }
 	}
 
+    /* Only the breakpoints that match something in the libraries we
+       just read need new locations.  If reading the symbols of one of
+       them failed before its objfile was created, we can't tell which
+       ones, so re-set them all.  */
     if (loaded_any_symbols)
-      breakpoint_re_set ();
+      {
+	if (read_all_objfiles)
+	  breakpoint_re_set_new_objfiles (new_objfiles);
+	else
+	  breakpoint_re_set ();
+      }
 
     if (from_tty && pattern && ! any_matches)
       gdb_printf
@@ -1538,6 +1687,15 @@ show_auto_solib_add (struct ui_file *file, int from_tty,
 	      value);
 }
 
+static void
+show_solib_background_read (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  gdb_printf (file, _("Background reading of shared library debug "
+		      "information is %s.\n"),
+	      value);
+}
+
 
 /* Lookup the value for a specific symbol from dynamic symbol table.  Look
    up symbol from ABFD.  MATCH_SYM is a callback function to determine
@@ -1811,6 +1969,13 @@ _initialize_solib ()
 {
   gdb::observers::free_objfile.attach (remove_user_added_objfile,
 				       "solib");
+  gdb::observers::free_objfile.attach (solib_background_read_forget,
+				       "solib");
+  solib_background_read_event
+    = create_async_event_handler (solib_background_read_handler, nullptr,
+				  "solib-background-read");
+  gdb::observers::normal_stop.attach (solib_background_read_normal_stop,
+				      "solib");
   gdb::observers::inferior_execd.attach ([] (inferior *exec_inf,
 					     inferior *follow_inf)
     {
@@ -1842,6 +2007,19 @@ inferior.  Otherwise, symbols must be loaded manually, using \
 			   show_auto_solib_add,
 			   &setlist, &showlist);
 
+  add_setshow_boolean_cmd ("solib-background-read", class_support,
+			   &solib_background_read, _("\
+Set background reading of shared library debug information."), _("\
+Show background reading of shared library debug information."), _("\
+If \"on\", only the minimal symbols of a newly loaded shared library are\n\
+read when the dynamic linker reports it; its debug information is indexed\n\
+later, while gdb is idle, or as soon as a command needs it.\n\
+If \"off\" (the default), the debug information is indexed before the\n\
+inferior is resumed."),
+			   NULL,
+			   show_solib_background_read,
+			   &setlist, &showlist);
+
   set_show_commands sysroot_cmds
     = add_setshow_optional_filename_cmd ("sysroot", class_support,
 					 &gdb_sysroot, _("\
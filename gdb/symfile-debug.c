@@ -54,6 +54,10 @@ static const registry<objfile>::key<debug_sym_fns_data>
 /* If true all calls to the symfile functions are logged.  */
 static bool debug_symfile = false;
 
+/* See objfiles.h.  */
+
+bool defer_background_symbol_reads = false;
+
 /* Return non-zero if symfile debug logging is installed.  */
 
 static int
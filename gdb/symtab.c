@@ -633,11 +633,13 @@ iterate_over_some_symtabs (const char *name,
    in the symtab filename will also work.
 
    Calls CALLBACK with each symtab that is found.  If CALLBACK returns
-   true, the search stops.  */
+   true, the search stops.  If OBJFILE_FILTER is not empty, only the
+   objfiles it returns true for are searched.  */
 
 void
 iterate_over_symtabs (const char *name,
-		      gdb::function_view<bool (symtab *)> callback)
+		      gdb::function_view<bool (symtab *)> callback,
+		      gdb::function_view<bool (objfile *)> objfile_filter)
 {
   gdb::unique_xmalloc_ptr<char> real_path;
 
@@ -651,6 +653,9 @@ iterate_over_symtabs (const char *name,
 
   for (objfile *objfile : current_program_space->objfiles ())
     {
+      if (objfile_filter != nullptr && !objfile_filter (objfile))
+	continue;
+
       if (iterate_over_some_symtabs (name, real_path.get (),
 				     objfile->compunit_symtabs, NULL,
 				     callback))
@@ -662,6 +667,9 @@ iterate_over_symtabs (const char *name,
 
   for (objfile *objfile : current_program_space->objfiles ())
     {
+      if (objfile_filter != nullptr && !objfile_filter (objfile))
+	continue;
+
       if (objfile->map_symtabs_matching_filename (name, real_path.get (),
 						  callback))
 	return;
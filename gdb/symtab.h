@@ -2758,8 +2758,9 @@ bool iterate_over_some_symtabs (const char *name,
 				struct compunit_symtab *after_last,
 				gdb::function_view<bool (symtab *)> callback);
 
-void iterate_over_symtabs (const char *name,
-			   gdb::function_view<bool (symtab *)> callback);
+void iterate_over_symtabs
+  (const char *name, gdb::function_view<bool (symtab *)> callback,
+   gdb::function_view<bool (objfile *)> objfile_filter = nullptr);
 
 
 std::vector<std::pair<CORE_ADDR, int>> find_pcs_and_cols_for_symtab_line
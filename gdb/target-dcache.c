@@ -20,6 +20,11 @@
 #include "gdbcmd.h"
 #include "progspace.h"
 #include "cli/cli-cmds.h"
+#include "gdbcore.h"
+#include "gdbsupport/byte-vector.h"
+#include "gdbthread.h"
+#include "inferior.h"
+#include "observable.h"
 
 /* The target dcache is kept per-address-space.  This key lets us
    associate the cache with the address space.  */
@@ -27,6 +32,30 @@
 static const registry<address_space>::key<DCACHE, dcache_deleter>
   target_dcache_aspace_key;
 
+/* A block of memory read by target_prefetch_memory.  */
+
+struct prefetch_block
+{
+  /* Address of the first byte of the block.  */
+  CORE_ADDR addr;
+
+  /* The raw contents of the block.  */
+  gdb::byte_vector contents;
+};
+
+/* The blocks prefetched in an address space, most recent last.  */
+
+using prefetch_blocks = std::vector<prefetch_block>;
+
+static const registry<address_space>::key<prefetch_blocks>
+  target_prefetch_aspace_key;
+
+/* The maximum number of bytes kept prefetched in an address space.
+   Larger requests only prefetch their beginning, and the oldest blocks
+   are dropped to make room for new ones.  */
+
+static const ULONGEST target_prefetch_max = 16 * 1024 * 1024;
+
 /* Target dcache is initialized or not.  */
 
 int
@@ -48,6 +77,8 @@ target_dcache_invalidate (void)
 
   if (dcache != NULL)
     dcache_invalidate (dcache);
+
+  target_prefetch_invalidate ();
 }
 
 /* Return the target dcache.  Return NULL if target dcache is not
@@ -77,6 +108,104 @@ target_dcache_get_or_init (void)
   return dcache;
 }
 
+/* See target-dcache.h.  */
+
+void
+target_prefetch_memory (CORE_ADDR addr, ULONGEST len)
+{
+  if (len == 0)
+    return;
+
+  /* In non-stop mode, running threads may write the memory at any
+     time, and we get no event when they do.  */
+  process_stratum_target *target = current_inferior ()->process_target ();
+  if (target != nullptr && threads_are_executing (target))
+    error (_("Cannot prefetch memory while threads are running."));
+
+  if (len > target_prefetch_max)
+    {
+      warning (_("Only prefetching the first %s of %s bytes."),
+	       pulongest (target_prefetch_max), pulongest (len));
+      len = target_prefetch_max;
+    }
+
+  prefetch_block block;
+  block.addr = addr;
+  block.contents.resize (len);
+
+  /* Read raw memory; breakpoint shadows are applied when the contents
+     are handed out, exactly as for memory read from the target.  */
+  if (target_read_raw_memory (addr, block.contents.data (), len) != 0)
+    memory_error (TARGET_XFER_E_IO, addr);
+
+  address_space *aspace = current_program_space->aspace;
+  prefetch_blocks *blocks = target_prefetch_aspace_key.get (aspace);
+  if (blocks == nullptr)
+    blocks = target_prefetch_aspace_key.emplace (aspace);
+
+  ULONGEST total = len;
+  for (const prefetch_block &iter : *blocks)
+    total += iter.contents.size ();
+  auto first_kept = blocks->begin ();
+  while (total > target_prefetch_max)
+    {
+      total -= first_kept->contents.size ();
+      ++first_kept;
+    }
+  blocks->erase (blocks->begin (), first_kept);
+
+  blocks->push_back (std::move (block));
+}
+
+/* See target-dcache.h.  */
+
+bool
+target_prefetch_read (CORE_ADDR addr, gdb_byte *readbuf, ULONGEST len,
+		      ULONGEST *xfered_len)
+{
+  prefetch_blocks *blocks
+    = target_prefetch_aspace_key.get (current_program_space->aspace);
+  if (blocks == nullptr)
+    return false;
+
+  /* Look at the most recent blocks first, they are the most likely to
+     be read.  */
+  for (auto iter = blocks->rbegin (); iter != blocks->rend (); ++iter)
+    {
+      if (addr < iter->addr || addr - iter->addr >= iter->contents.size ())
+	continue;
+
+      ULONGEST offset = addr - iter->addr;
+      ULONGEST avail = std::min (len, iter->contents.size () - offset);
+      memcpy (readbuf, iter->contents.data () + offset, avail);
+      *xfered_len = avail;
+      return true;
+    }
+
+  return false;
+}
+
+/* See target-dcache.h.  */
+
+void
+target_prefetch_invalidate ()
+{
+  target_prefetch_aspace_key.clear (current_program_space->aspace);
+}
+
+/* Drop all the prefetched memory when any thread is resumed.  Unlike
+   the dcache, which is only flushed when an event is handled, this
+   must not wait for the next stop: in non-stop mode, other threads may
+   still be inspected while the resumed one changes memory.  */
+
+static void
+target_prefetch_target_resumed (ptid_t ptid)
+{
+  for (struct program_space *pspace : program_spaces)
+    if (pspace->aspace != nullptr)
+      target_prefetch_aspace_key.clear (pspace->aspace);
+}
+
 /* The option sets this.  */
 static bool stack_cache_enabled_1 = true;
 /* And set_stack_cache updates this.
@@ -197,4 +326,7 @@ Force gdb to flush its target memory data cache.\n\
 The dcache caches all target memory accesses where possible, this\n\
 includes the stack-cache and the code-cache."),
 	   &maintenanceflushlist);
+
+  gdb::observers::target_resumed.attach (target_prefetch_target_resumed,
+					 "target-dcache");
 }
@@ -32,4 +32,26 @@ extern int stack_cache_enabled_p (void);
 
 extern int code_cache_enabled_p (void);
 
+/* Read LEN bytes of raw memory at ADDR from the current inferior in
+   as few transfers as possible and keep them, so that later memory
+   reads in that range are served locally.  The prefetched memory is
+   dropped by target_dcache_invalidate, when any thread is resumed, and
+   by any memory write.  At most 16 MiB are kept per address space;
+   only the beginning of a larger range is prefetched, with a warning.
+   Throws an error if threads of the inferior are running, and a
+   memory error if the range cannot be read.  */
+
+extern void target_prefetch_memory (CORE_ADDR addr, ULONGEST len);
+
+/* If ADDR was prefetched in the current address space, copy up to LEN
+   bytes of it into READBUF, set *XFERED_LEN to the number of bytes
+   copied and return true.  Otherwise, return false.  */
+
+extern bool target_prefetch_read (CORE_ADDR addr, gdb_byte *readbuf,
+				  ULONGEST len, ULONGEST *xfered_len);
+
+/* Drop all the memory prefetched in the current address space.  */
+
+extern void target_prefetch_invalidate ();
+
 #endif /* TARGET_DCACHE_H */
@@ -1513,6 +1513,11 @@ raw_memory_xfer_partial (struct target_ops *ops, gdb_byte *readbuf,
     }
   while (ops != NULL);
 
+  /* Prefetched memory is only kept for reading a region that does
+     not change; drop it on any write.  */
+  if (writebuf != NULL && inferior_ptid != null_ptid)
+    target_prefetch_invalidate ();
+
   /* The cache works at the raw memory level.  Make sure the cache
      gets updated with raw contents no matter what kind of memory
      object was originally being written.  Note we do write-through
@@ -1596,6 +1601,13 @@ memory_xfer_partial_1 (struct target_ops *ops, enum target_object object,
   else
     inf = NULL;
 
+  /* Try memory prefetched by target_prefetch_memory.  */
+  if (inf != NULL
+      && readbuf != NULL
+      && get_traceframe_number () == -1
+      && target_prefetch_read (memaddr, readbuf, reg_len, xfered_len))
+    return TARGET_XFER_OK;
+
   if (inf != NULL
       && readbuf != NULL
       /* The dcache reads whole cache lines; that doesn't play well
@@ -0,0 +1,153 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* A native pretty-printer for "struct int_vec", see native-printer.c.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "native-printer-plugin.h"
+
+GDB_DECLARE_GPL_COMPATIBLE_PRINTER;
+
+/* If VALUE is an int_vec, store its length and data in *LEN and *DATA.
+   Return GDB_PRINTER_NOT_HANDLED if VALUE is not an int_vec.  */
+
+static enum gdb_printer_result
+get_int_vec (struct gdb_printer_callbacks *cb,
+	     struct gdb_printer_value *value, long long *len,
+	     struct gdb_printer_value **data)
+{
+  const char *name = cb->type_name (cb, cb->value_type (cb, value));
+  struct gdb_printer_value *len_val;
+
+  if (name == NULL || strcmp (name, "int_vec") != 0)
+    return GDB_PRINTER_NOT_HANDLED;
+
+  len_val = cb->value_field (cb, value, "len");
+  *data = cb->value_field (cb, value, "data");
+  if (len_val == NULL || *data == NULL
+      || cb->value_as_long (cb, len_val, len) != GDB_PRINTER_SUCCESS)
+    return GDB_PRINTER_ERROR;
+
+  return GDB_PRINTER_HANDLED;
+}
+
+static enum gdb_printer_result
+print_int_vec (struct gdb_printer_funcs *self,
+	       struct gdb_printer_callbacks *cb,
+	       struct gdb_printer_value *value)
+{
+  struct gdb_printer_value *data_val;
+  long long len, i;
+  unsigned int limit;
+  char buf[64];
+  enum gdb_printer_result result = get_int_vec (cb, value, &len, &data_val);
+
+  if (result != GDB_PRINTER_HANDLED)
+    return result;
+
+  snprintf (buf, sizeof (buf), "int_vec of length %lld = {", len);
+  cb->print_text (cb, buf);
+
+  limit = cb->print_elements (cb);
+  for (i = 0; i < len; ++i)
+    {
+      struct gdb_printer_value *elt;
+
+      if (i > 0)
+	cb->print_text (cb, ", ");
+      if (limit != 0 && i >= limit)
+	{
+	  cb->print_text (cb, "...");
+	  break;
+	}
+
+      elt = cb->value_subscript (cb, data_val, i);
+      if (elt == NULL
+	  || cb->print_value (cb, elt) != GDB_PRINTER_SUCCESS)
+	return GDB_PRINTER_ERROR;
+    }
+
+  cb->print_text (cb, "}");
+  return GDB_PRINTER_HANDLED;
+}
+
+static enum gdb_printer_result
+int_vec_num_children (struct gdb_printer_funcs *self,
+		      struct gdb_printer_callbacks *cb,
+		      struct gdb_printer_value *value,
+		      unsigned long long *result)
+{
+  struct gdb_printer_value *data_val;
+  long long len;
+  enum gdb_printer_result status = get_int_vec (cb, value, &len, &data_val);
+
+  if (status == GDB_PRINTER_HANDLED)
+    *result = len < 0 ? 0 : len;
+  return status;
+}
+
+static enum gdb_printer_result
+int_vec_children (struct gdb_printer_funcs *self,
+		  struct gdb_printer_callbacks *cb,
+		  struct gdb_printer_value *value,
+		  unsigned long long start, unsigned long long count)
+{
+  struct gdb_printer_value *data_val;
+  long long len;
+  unsigned long long i;
+  char name[32];
+  enum gdb_printer_result result = get_int_vec (cb, value, &len, &data_val);
+
+  if (result != GDB_PRINTER_HANDLED)
+    return result;
+
+  for (i = start; i < start + count; ++i)
+    {
+      struct gdb_printer_value *elt = cb->value_subscript (cb, data_val, i);
+
+      if (elt == NULL)
+	return GDB_PRINTER_ERROR;
+      snprintf (name, sizeof (name), "[%llu]", i);
+      if (cb->add_child (cb, name, elt) != GDB_PRINTER_SUCCESS)
+	return GDB_PRINTER_ERROR;
+    }
+
+  return GDB_PRINTER_HANDLED;
+}
+
+static void
+destroy_printer (struct gdb_printer_funcs *self)
+{
+  free (self);
+}
+
+struct gdb_printer_funcs *
+gdb_init_printer (void)
+{
+  struct gdb_printer_funcs *funcs = malloc (sizeof (*funcs));
+
+  funcs->printer_version = GDB_PRINTER_INTERFACE_VERSION;
+  funcs->priv_data = NULL;
+  funcs->print = print_int_vec;
+  funcs->destroy = destroy_printer;
+  funcs->num_children = int_vec_num_children;
+  funcs->children = int_vec_children;
+  return funcs;
+}
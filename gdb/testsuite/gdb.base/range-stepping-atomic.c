@@ -0,0 +1,46 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+static int counter;
+
+#if defined (__aarch64__)
+/* Increment *P with a load-exclusive/store-exclusive loop.  The compiler
+   does not necessarily emit one for __atomic_fetch_add: it may use LSE
+   instructions or call a helper instead.  */
+#define ATOMIC_INCREMENT(p)						\
+  do									\
+    {									\
+      unsigned int tmp_, fail_;						\
+      __asm__ volatile ("1:\tldaxr\t%w0, [%2]\n"			\
+			"\tadd\t%w0, %w0, #1\n"				\
+			"\tstlxr\t%w1, %w0, [%2]\n"			\
+			"\tcbnz\t%w1, 1b"				\
+			: "=&r" (tmp_), "=&r" (fail_)			\
+			: "r" (p)					\
+			: "memory");					\
+    }									\
+  while (0)
+#else
+#define ATOMIC_INCREMENT(p) __atomic_fetch_add ((p), 1, __ATOMIC_SEQ_CST)
+#endif
+
+int
+main (void)
+{
+  ATOMIC_INCREMENT (&counter);	/* atomic line */
+  return counter - 1;	/* after atomic */
+}
@@ -0,0 +1,58 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <dlfcn.h>
+#include <stdlib.h>
+
+volatile int result;
+
+static void __attribute__ ((noinline))
+loaded (int iteration)
+{
+  result += iteration;
+}
+
+int
+main (void)
+{
+  int i;
+
+  /* Load and unload two libraries in turn.  Each one is likely to be
+     loaded where the other one was just unloaded.  */
+  for (i = 0; i < ITERATIONS; ++i)
+    {
+      const char *name = (i % 2 == 0) ? SHLIB_NAME_A : SHLIB_NAME_B;
+      const char *func = (i % 2 == 0) ? "churn_a" : "churn_b";
+      void *handle;
+      int (*churn) (int);
+
+      handle = dlopen (name, RTLD_LAZY);
+      if (handle == NULL)
+	abort ();
+
+      churn = (int (*) (int)) dlsym (handle, func);
+      if (churn == NULL)
+	abort ();
+
+      result = churn (i);
+      loaded (i);
+
+      dlclose (handle);
+    }
+
+  return 0; /* all unloaded */
+}
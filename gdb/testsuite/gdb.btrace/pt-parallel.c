@@ -0,0 +1,45 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+static volatile int sum;
+
+static void
+add_one (int i)
+{
+  sum += 1;
+}
+
+static void
+add_i (int i)
+{
+  sum += i;
+}
+
+/* Called through a pointer so that each call produces a packet, which
+   makes the trace long.  */
+static void (*volatile funcs[2]) (int) = { add_one, add_i };
+
+int
+main (void)
+{
+  int i;
+
+  for (i = 0; i < 400000; i++) /* loop */
+    funcs[i & 1] (i);
+
+  return 0; /* end */
+}
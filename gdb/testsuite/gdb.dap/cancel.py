@@ -0,0 +1,42 @@
+# Copyright (C) 2023 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+import gdb
+
+
+class EndlessPrinter(gdb.ValuePrinter):
+    """A printer that only returns when it is interrupted."""
+
+    def __init__(self, val):
+        self._val = val
+
+    def to_string(self):
+        # Let the test know that the request is running, so that it
+        # can cancel it.  The DAP server is only loaded by now.
+        from gdb.dap.server import send_event
+
+        send_event("output", {"category": "console", "output": "printer started"})
+        while True:
+            # Formatting a value checks for interrupts.
+            str(self._val["x"])
+
+
+def lookup(val):
+    if val.type.strip_typedefs().tag == "dei_struct":
+        return EndlessPrinter(val)
+    return None
+
+
+gdb.pretty_printers.append(lookup)
@@ -0,0 +1,56 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+struct point
+{
+  int x;
+  int y;
+};
+
+struct point first = { 1, 2 };
+struct point second = { 3, 4 };
+struct point same = { 3, 4 };
+struct point *p_point = &first;
+
+struct holder
+{
+  char *name;
+};
+
+char name_buf[] = "abc";
+struct holder holder = { name_buf };
+
+static void
+recurse (int depth)
+{
+  struct point local = { depth, depth };
+
+  if (depth > 0)
+    recurse (depth - 1);	/* recurse call */
+  local.x++;			/* recurse return */
+}
+
+int
+main (void)
+{
+  first.x = 10;			/* first.x changed */
+  p_point = &second;		/* p_point set to second */
+  p_point = &same;		/* p_point set to same */
+  recurse (1);			/* recurse */
+  name_buf[0] = 'x';		/* name_buf changed */
+  return 0;			/* return */
+}
@@ -0,0 +1,45 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <unistd.h>
+
+/* Larger than the 16 MiB GDB keeps prefetched.  */
+char big[17 * 1024 * 1024];
+
+static void *
+thread_func (void *arg)
+{
+  /* Keep running until GDB kills the inferior.  */
+  while (1)
+    usleep (1000);
+  return NULL;
+}
+
+int
+main (void)
+{
+  pthread_t thread;
+
+  alarm (60);
+
+  big[0] = 1;
+  big[sizeof (big) - 1] = 2;
+
+  pthread_create (&thread, NULL, thread_func, NULL);
+  return 0;	/* Break here.  */
+}
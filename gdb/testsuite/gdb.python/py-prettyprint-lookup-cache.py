@@ -0,0 +1,74 @@
+# Copyright (C) 2023 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+import gdb
+
+
+class ContainerPrinter:
+    def __init__(self, val):
+        self.val = val
+
+    def to_string(self):
+        return "container of %d" % int(self.val["len"])
+
+    def children(self):
+        for i in range(int(self.val["len"])):
+            yield "[%d]" % i, self.val["elements"][i]
+
+    def display_hint(self):
+        return "array"
+
+
+class ElementPrinter:
+    def __init__(self, val):
+        self.val = val
+
+    def to_string(self):
+        return "element %d" % int(self.val["x"])
+
+
+# Number of times each lookup function was called.
+unused_lookup_calls = 0
+element_lookup_calls = 0
+
+# When set, element_lookup only accepts elements with this value of x.
+only_x = None
+
+
+def unused_lookup(val):
+    global unused_lookup_calls
+    unused_lookup_calls += 1
+    return None
+
+
+def element_lookup(val):
+    global element_lookup_calls
+    element_lookup_calls += 1
+    if val.type.strip_typedefs().tag != "element":
+        return None
+    if only_x is not None and int(val["x"]) != only_x:
+        return None
+    return ElementPrinter(val)
+
+
+def container_lookup(val):
+    if val.type.strip_typedefs().tag == "container":
+        return ContainerPrinter(val)
+    return None
+
+
+gdb.pretty_printers.append(unused_lookup)
+gdb.pretty_printers.append(container_lookup)
+gdb.pretty_printers.append(element_lookup)
@@ -0,0 +1,49 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+
+#include <string.h>
+#include <unistd.h>
+
+/* More than a page, so that process record stores the old contents of
+   the buffer in shared pages.  */
+#define SIZE (4096 + 100)
+
+static char buf[SIZE];
+static char data[SIZE];
+
+int
+main (void)
+{
+  int fds[2];
+  int i;
+
+  memset (data, 'x', sizeof (data));
+  if (pipe (fds) != 0)
+    return 1;
+
+  for (i = 0; i < 3; i++) /* start loop */
+    {
+      data[0] = 'a' + i;
+      if (write (fds[1], data, sizeof (data)) != sizeof (data))
+	return 1;
+      if (read (fds[0], buf, sizeof (buf)) != sizeof (buf))
+	return 1;
+    }
+
+  return 0; /* end loop */
+}
@@ -0,0 +1,37 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Spans several pages, so that replaying the loop below touches
+   memory on each of them.  */
+volatile char buf[5 * 4096];
+volatile int marker;
+
+int
+main (void)
+{
+  int i;
+
+  marker = 1; /* start loop */
+  for (i = 0; i < sizeof (buf); i += 512)
+    buf[i] = 1 + i / 512;
+  marker = 2; /* after first loop */
+
+  for (i = 0; i < sizeof (buf); i += 512)
+    buf[i] += 100;
+
+  return 0; /* end loop */
+}
@@ -0,0 +1,45 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2023 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* WATCHED and NEIGHBOUR are next to each other in memory, so that
+   writing NEIGHBOUR is a write close to the watched memory.  */
+struct
+{
+  volatile int watched;
+  volatile int neighbour;
+} s;
+
+volatile int counter;
+
+int
+main (void)
+{
+  int i;
+
+  s.watched = 1; /* first write */
+  for (i = 0; i < 1000; i++)
+    {
+      counter++;
+      s.neighbour = i;
+    }
+
+  s.watched = 2; /* second write */
+  for (i = 0; i < 1000; i++)
+    counter++;
+
+  return 0; /* end loop */
+}
@@ -1024,6 +1024,52 @@ generic_value_print (struct value *val, struct ui_file *stream, int recurse,
     }
 }
 
+/* Arrays read from memory that are larger than this many bytes are
+   printed by value_print_array_elements a chunk of this size at a
+   time, instead of being read in full before printing.  */
+
+static const ULONGEST array_print_chunk_size = 65536;
+
+/* Return true if VAL, about to be printed using LANGUAGE, should be left
+   lazy so that its elements are read a chunk at a time while they are
+   printed.  Only the C family printers know how to do that.  */
+
+static bool
+val_print_array_in_chunks_p (struct value *val,
+			     const struct language_defn *language)
+{
+  switch (language->la_language)
+    {
+    case language_c:
+    case language_cplus:
+    case language_objc:
+    case language_asm:
+    case language_minimal:
+      break;
+
+    default:
+      return false;
+    }
+
+  if (!val->lazy ()
+      || val->lval () != lval_memory
+      || val->bitsize () != 0
+      || val->embedded_offset () != 0
+      || val->type () != val->enclosing_type ())
+    return false;
+
+  struct type *type = check_typedef (val->type ());
+  if (type->code () != TYPE_CODE_ARRAY
+      || type->is_vector ()
+      || type->bit_stride () != 0
+      || type->length () <= array_print_chunk_size
+      || exceeds_max_value_size (type->length ()))
+    return false;
+
+  struct type *elttype = check_typedef (type->target_type ());
+  return elttype->length () > 0 && !is_dynamic_type (elttype);
+}
+
 /* Print using the given LANGUAGE the value VAL onto stream STREAM according
    to OPTIONS.
 
@@ -1042,7 +1088,7 @@ common_val_print (struct value *value, struct ui_file *stream, int recurse,
        get a fixed representation of our value.  */
     value = ada_to_fixed_value (value);
 
-  if (value->lazy ())
+  if (value->lazy () && !val_print_array_in_chunks_p (value, language))
     value->fetch_lazy ();
 
   struct value_print_options local_opts = *options;
@@ -1116,13 +1162,14 @@ val_print_check_max_depth (struct ui_file *stream, int recurse,
   return false;
 }
 
-/* Check whether the value VAL is printable.  Return 1 if it is;
-   return 0 and print an appropriate error message to STREAM according to
-   OPTIONS if it is not.  */
+/* Check whether the value VAL is printable using LANGUAGE.  Return 1
+   if it is; return 0 and print an appropriate error message to STREAM
+   according to OPTIONS if it is not.  */
 
 static int
 value_check_printable (struct value *val, struct ui_file *stream,
-		       const struct value_print_options *options)
+		       const struct value_print_options *options,
+		       const struct language_defn *language)
 {
   if (val == 0)
     {
@@ -1131,22 +1178,28 @@ value_check_printable (struct value *val, struct ui_file *stream,
       return 0;
     }
 
-  if (val->entirely_optimized_out ())
+  /* Checking the availability of a large array printed a chunk at a
+     time would read it in full.  Its elements are checked as they are
+     printed instead.  */
+  if (!val_print_array_in_chunks_p (val, language))
     {
-      if (options->summary && !val_print_scalar_type_p (val->type ()))
-	gdb_printf (stream, "...");
-      else
-	val_print_optimized_out (val, stream);
-      return 0;
-    }
+      if (val->entirely_optimized_out ())
+	{
+	  if (options->summary && !val_print_scalar_type_p (val->type ()))
+	    gdb_printf (stream, "...");
+	  else
+	    val_print_optimized_out (val, stream);
+	  return 0;
+	}
 
-  if (val->entirely_unavailable ())
-    {
-      if (options->summary && !val_print_scalar_type_p (val->type ()))
-	gdb_printf (stream, "...");
-      else
-	val_print_unavailable (stream);
-      return 0;
+      if (val->entirely_unavailable ())
+	{
+	  if (options->summary && !val_print_scalar_type_p (val->type ()))
+	    gdb_printf (stream, "...");
+	  else
+	    val_print_unavailable (stream);
+	  return 0;
+	}
     }
 
   if (val->type ()->code () == TYPE_CODE_INTERNAL_FUNCTION)
@@ -1180,7 +1233,7 @@ common_val_print_checked (struct value *val, struct ui_file *stream,
 			  const struct value_print_options *options,
 			  const struct language_defn *language)
 {
-  if (!value_check_printable (val, stream, options))
+  if (!value_check_printable (val, stream, options, language))
     return;
   common_val_print (val, stream, recurse, options, language);
 }
@@ -1194,7 +1247,7 @@ value_print (struct value *val, struct ui_file *stream,
 {
   scoped_value_mark free_values;
 
-  if (!value_check_printable (val, stream, options))
+  if (!value_check_printable (val, stream, options, current_language))
     return;
 
   if (!options->raw)
@@ -1999,6 +2052,48 @@ value_print_array_elements (struct value *val, struct ui_file *stream,
       len = 0;
     }
 
+  /* A lazy VAL is a large array in memory, see
+     val_print_array_in_chunks_p.  Read it a chunk of elements at a
+     time, so that only the current chunk is held in memory.  */
+  value_ref_ptr chunk;
+  unsigned int chunk_low = 0;
+  unsigned int chunk_len = 0;
+  unsigned int chunk_max
+    = std::max<ULONGEST> (1, (array_print_chunk_size
+			      / check_typedef (elttype)->length ()));
+  struct type *chunk_type = nullptr;
+
+  auto element_at = [&] (unsigned int idx) -> struct value *
+    {
+      if (!val->lazy ())
+	return val->from_component_bitsize (elttype, bit_stride * idx,
+					    bit_stride);
+
+      if (chunk == nullptr || idx < chunk_low || idx >= chunk_low + chunk_len)
+	{
+	  chunk_low = idx;
+	  chunk_len = std::min (chunk_max, len - chunk_low);
+
+	  struct type *this_type = chunk_type;
+	  if (this_type == nullptr || chunk_len != chunk_max)
+	    {
+	      this_type = lookup_array_range_type (elttype, 0, chunk_len - 1);
+	      if (chunk_len == chunk_max)
+		chunk_type = this_type;
+	    }
+
+	  CORE_ADDR addr = (val->address ()
+			    + chunk_low * (bit_stride / TARGET_CHAR_BIT));
+	  chunk = release_value (value_at_lazy (this_type, addr));
+	  chunk->set_stack (val->stack ());
+	  chunk->fetch_lazy ();
+	}
+
+      return chunk->from_component_bitsize (elttype,
+					    bit_stride * (idx - chunk_low),
+					    bit_stride);
+    };
+
   annotate_array_section_begin (i, elttype);
 
   bool need_comma = i != 0;
@@ -2006,9 +2101,7 @@ value_print_array_elements (struct value *val, struct ui_file *stream,
     {
       scoped_value_mark free_values;
 
-      struct value *element = val->from_component_bitsize (elttype,
-							   bit_stride * i,
-							   bit_stride);
+      struct value *element = element_at (i);
 
       /* If requested, skip printing of zero value fields.  */
       if (!options->zero_value_print && value_is_zero (element))
@@ -2048,10 +2141,7 @@ value_print_array_elements (struct value *val, struct ui_file *stream,
 		 clean up temporary values asap to prevent allocating a large
 		 amount of them.  */
 	      scoped_value_mark free_values_inner;
-	      struct value *rep_elt
-		= val->from_component_bitsize (elttype,
-					       rep1 * bit_stride,
-					       bit_stride);
+	      struct value *rep_elt = element_at (rep1);
 	      bool repeated = ((available
 				&& rep_elt->entirely_available ()
 				&& element->contents_eq (rep_elt))
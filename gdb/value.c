@@ -711,10 +711,49 @@ value::contents_eq (const struct value *val2) const
   return contents_eq (0, val2, 0, len1);
 }
 
+/* An entry of the value history.  */
+
+struct value_history_entry
+{
+  value_history_entry (value_ref_ptr val, ULONGEST tick)
+    : val (std::move (val)), last_use (tick)
+  {}
+
+  value_ref_ptr val;
+
+  /* When the entry was last recorded or accessed, used to find the
+     least recently used entries when the history grows too large.  */
+  ULONGEST last_use;
+
+  /* The number of bytes of contents of VAL counted in
+     value_history_bytes.  */
+  ULONGEST counted_bytes = 0;
+};
+
 /* The value-history records all the values printed by print commands
    during this session.  */
 
-static std::vector<value_ref_ptr> value_history;
+static std::vector<value_history_entry> value_history;
+
+/* Incremented every time an entry of the value history is used.  */
+
+static ULONGEST value_history_tick;
+
+/* The number of bytes of contents held by the values of the value
+   history.  This is updated when values are recorded and discarded,
+   and may miss values fetched later, see update_value_history_bytes.  */
+
+static ULONGEST value_history_bytes;
+
+/* The number of values of the value history whose contents were
+   discarded to honor "set max-value-history-size".  */
+
+static ULONGEST value_history_discarded;
+
+/* The maximum number of bytes of contents held by the value history,
+   or UINT_MAX for no limit.  */
+
+static unsigned int max_value_history_size = UINT_MAX;
 
 
 /* List of all value objects currently allocated
@@ -1659,6 +1698,108 @@ value::set_component_location (const struct value *whole)
 
 /* Access to the value history.  */
 
+/* See value.h.  */
+
+ULONGEST
+value::allocated_contents_size () const
+{
+  if (m_lazy || m_contents == nullptr)
+    return 0;
+
+  if (m_limited_length != 0)
+    return m_limited_length;
+
+  return m_enclosing_type->length ();
+}
+
+/* See value.h.  */
+
+bool
+value::discard_history_contents ()
+{
+  gdb_assert (m_in_history);
+
+  /* Only values read from memory can be read again later.  Values
+     whose availability was established while fetching them are kept
+     too, as that information would be lost.  */
+  if (m_lazy
+      || m_lval != lval_memory
+      || m_bitsize != 0
+      || m_is_zero
+      || m_limited_length != 0
+      || !m_unavailable.empty ()
+      || !m_optimized_out.empty ())
+    return false;
+
+  m_contents.reset ();
+  m_lazy = true;
+  return true;
+}
+
+/* Bring value_history_bytes up to date with the contents the values of
+   the value history hold now.  A value recorded lazy may have been
+   fetched since, for instance if it is shared with a Python or Guile
+   object.  This walks the whole history, so it is only done when the
+   count matters: before discarding contents, and for "maint info
+   value-memory".  */
+
+static void
+update_value_history_bytes ()
+{
+  for (value_history_entry &entry : value_history)
+    {
+      ULONGEST size = entry.val->allocated_contents_size ();
+      value_history_bytes -= entry.counted_bytes;
+      value_history_bytes += size;
+      entry.counted_bytes = size;
+    }
+}
+
+/* Discard the contents of the least recently used values of the value
+   history until the history holds no more than max_value_history_size
+   bytes of contents.  The most recent value is never discarded, and
+   neither are values referenced from outside the history, such as by
+   Python or Guile objects, whose users expect their contents to stay
+   put.  */
+
+static void
+enforce_value_history_size ()
+{
+  if (max_value_history_size == UINT_MAX
+      || value_history_bytes <= max_value_history_size
+      || value_history.size () < 2)
+    return;
+
+  update_value_history_bytes ();
+  if (value_history_bytes <= max_value_history_size)
+    return;
+
+  std::vector<value_history_entry *> candidates;
+  for (size_t i = 0; i + 1 < value_history.size (); ++i)
+    if (!value_history[i].val->lazy ()
+	&& value_history[i].val->reference_count () == 1)
+      candidates.push_back (&value_history[i]);
+
+  std::sort (candidates.begin (), candidates.end (),
+	     [] (const value_history_entry *a, const value_history_entry *b)
+	     {
+	       return a->last_use < b->last_use;
+	     });
+
+  for (value_history_entry *entry : candidates)
+    {
+      if (value_history_bytes <= max_value_history_size)
+	break;
+
+      if (entry->val->discard_history_contents ())
+	{
+	  value_history_bytes -= entry->counted_bytes;
+	  entry->counted_bytes = 0;
+	  ++value_history_discarded;
+	}
+    }
+}
+
 /* Record a new value in the value history.
    Returns the absolute history index of the entry.  */
 
@@ -1683,7 +1824,20 @@ value::record_latest ()
 	  && calculate_limited_array_length (m_type) <= max_value_size)
 	m_limited_length = max_value_size;
 
-      fetch_lazy ();
+      /* A value from memory that the history could not keep anyway,
+	 because it is larger than max-value-history-size, is left lazy.
+	 It is read from memory when it is used, which for large arrays
+	 is done a chunk at a time when printing.  */
+      bool too_large_for_history
+	= (m_limited_length == 0
+	   && max_value_history_size != UINT_MAX
+	   && m_lval == lval_memory
+	   && m_bitsize == 0
+	   && !m_is_zero
+	   && m_enclosing_type->length () > max_value_history_size);
+
+      if (!too_large_for_history)
+	fetch_lazy ();
     }
 
   ULONGEST limit = m_limited_length;
@@ -1698,7 +1852,12 @@ value::record_latest ()
      but the current contents of that location.  c'est la vie...  */
   set_modifiable (false);
 
-  value_history.push_back (release_value (this));
+  value_history.emplace_back (release_value (this), ++value_history_tick);
+
+  value_history_entry &entry = value_history.back ();
+  entry.counted_bytes = entry.val->allocated_contents_size ();
+  value_history_bytes += entry.counted_bytes;
+  enforce_value_history_size ();
 
   return value_history.size ();
 }
@@ -1727,7 +1886,11 @@ access_value_history (int num)
 
   absnum--;
 
-  return value_history[absnum]->copy ();
+  /* If the contents of the value were discarded, the copy is lazy and
+     its contents are read again from memory when needed.  */
+  value_history_entry &entry = value_history[absnum];
+  entry.last_use = ++value_history_tick;
+  return entry.val->copy ();
 }
 
 /* See value.h.  */
@@ -2459,8 +2622,8 @@ preserve_values (struct objfile *objfile)
      it is soon to be deleted.  */
   htab_up copied_types = create_copied_types_hash ();
 
-  for (const value_ref_ptr &item : value_history)
-    item->preserve (objfile, copied_types.get ());
+  for (const value_history_entry &item : value_history)
+    item.val->preserve (objfile, copied_types.get ());
 
   for (auto &pair : internalvars)
     preserve_one_internalvar (&pair.second, objfile, copied_types.get ());
@@ -2521,6 +2684,79 @@ show_convenience (const char *ignore, int from_tty)
 		    "$foo = 5\" to define them.\n"));
     }
 }
+
+/* Implement the "set max-value-history-size" command.  Discard
+   contents right away if the history now exceeds the new limit.  */
+
+static void
+set_max_value_history_size (const char *args, int from_tty,
+			    struct cmd_list_element *c)
+{
+  if (max_value_history_size != UINT_MAX)
+    update_value_history_bytes ();
+  enforce_value_history_size ();
+}
+
+/* Implement the "show max-value-history-size" command.  */
+
+static void
+show_max_value_history_size (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  if (max_value_history_size == UINT_MAX)
+    gdb_printf (file, _("Maximum value history size is unlimited.\n"));
+  else
+    gdb_printf (file, _("Maximum value history size is %u bytes.\n"),
+		max_value_history_size);
+}
+
+/* Implement the "maint info value-memory" command.  */
+
+static void
+maintenance_info_value_memory (const char *args, int from_tty)
+{
+  update_value_history_bytes ();
+
+  ULONGEST lazy = 0;
+  for (const value_history_entry &entry : value_history)
+    if (entry.val->lazy ())
+      ++lazy;
+
+  gdb_printf (_("Value history: %s values, %s bytes of contents.\n"),
+	      pulongest (value_history.size ()),
+	      pulongest (value_history_bytes));
+  gdb_printf (_("  Values with contents to be read again: %s\n"),
+	      pulongest (lazy));
+  gdb_printf (_("  Contents discarded so far: %s times\n"),
+	      pulongest (value_history_discarded));
+  if (max_value_history_size == UINT_MAX)
+    gdb_printf (_("  Size limit: unlimited\n"));
+  else
+    gdb_printf (_("  Size limit: %u bytes\n"), max_value_history_size);
+
+  ULONGEST var_count = 0;
+  ULONGEST var_bytes = 0;
+  for (auto &pair : internalvars)
+    {
+      internalvar &var = pair.second;
+
+      if (var.kind != INTERNALVAR_VALUE)
+	continue;
+
+      ++var_count;
+      var_bytes += var.u.value->allocated_contents_size ();
+    }
+
+  gdb_printf (_("Convenience variables: %s values, %s bytes of contents.\n"),
+	      pulongest (var_count), pulongest (var_bytes));
+
+  ULONGEST temp_bytes = 0;
+  for (const value_ref_ptr &val : all_values)
+    temp_bytes += val->allocated_contents_size ();
+
+  gdb_printf (_("Temporary values: %s values, %s bytes of contents.\n"),
+	      pulongest (all_values.size ()), pulongest (temp_bytes));
+}
 
 
 /* See value.h.  */
@@ -4275,6 +4511,24 @@ Convenience functions are defined via the Python API."
 Elements of value history around item number IDX (or last ten)."),
 	   &showlist);
 
+  add_setshow_uinteger_cmd ("max-value-history-size", class_support,
+			    &max_value_history_size, _("\
+Set the maximum size of the contents held by the value history."), _("\
+Show the maximum size of the contents held by the value history."), _("\
+Use this to bound the memory, in bytes, that the value history uses for\n\
+the contents of its values.  When the limit is exceeded, the contents of\n\
+the least recently used values that were read from the inferior's memory\n\
+are discarded, and read again from memory if the value is used later.\n\
+Literal \"unlimited\" or zero means no limit."),
+			    set_max_value_history_size,
+			    show_max_value_history_size,
+			    &setlist, &showlist);
+
+  add_cmd ("value-memory", class_maintenance, maintenance_info_value_memory,
+	   _("\
+Show the memory used by the value history and convenience variables."),
+	   &maintenanceinfolist);
+
   add_com ("init-if-undefined", class_vars, init_if_undefined_command, _("\
 Initialize a convenience variable if necessary.\n\
 init-if-undefined VARIABLE = EXPRESSION\n\
@@ -485,6 +485,10 @@ struct value
      drops to 0, it will be freed.  */
   void decref ();
 
+  /* Return the number of references to this value.  */
+  int reference_count () const
+  { return m_reference_count; }
+
   /* Given a value, determine whether the contents bytes starting at
      OFFSET and extending for LENGTH bytes are available.  This returns
      true if all bytes in the given range are available, false if any
@@ -612,6 +616,16 @@ struct value
      in the history.  The value is removed from the value chain.  */
   int record_latest ();
 
+  /* Return the number of bytes of contents GDB holds for this value,
+     or 0 if the value is lazy.  */
+  ULONGEST allocated_contents_size () const;
+
+  /* Discard the contents of this value, which must be in the value
+     history, so that they are read again from the inferior's memory
+     the next time they are needed.  Return false if the contents of
+     this value cannot be read again and were kept.  */
+  bool discard_history_contents ();
+
 private:
 
   /* Type of value; either not an lval, or one of the various
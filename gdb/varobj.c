@@ -23,16 +23,20 @@
 #include "gdbcmd.h"
 #include "block.h"
 #include "valprint.h"
+#include "c-lang.h"
 #include "gdbsupport/gdb_regex.h"
 
 #include "varobj.h"
 #include "gdbthread.h"
 #include "inferior.h"
 #include "varobj-iter.h"
+#include "native-printer.h"
 #include "parser-defs.h"
 #include "gdbarch.h"
 #include <algorithm>
 #include "observable.h"
+#include "target-dcache.h"
+#include "gdbsupport/scope-exit.h"
 
 #if HAVE_PYTHON
 #include "python/python.h"
@@ -132,6 +136,11 @@ struct varobj_dynamic
      new printer object is needed, and one will be constructed.  */
   PyObject *pretty_printer = NULL;
 
+  /* Whether a native pretty-printer provides the children of this
+     varobj.  This takes precedence over the default Python
+     pretty-printer, as native pretty-printers do when printing.  */
+  bool native_children = false;
+
   /* The iterator returned by the printer's 'children' method, or NULL
      if not available.  */
   std::unique_ptr<varobj_iter> child_iter;
@@ -643,6 +652,13 @@ install_dynamic_child (struct varobj *var,
 static std::unique_ptr<varobj_iter>
 varobj_get_iterator (struct varobj *var)
 {
+  if (var->dynamic->native_children)
+    {
+      value_print_options opts;
+      varobj_formatted_print_options (&opts, var->format);
+      return native_printer_get_children_iterator (var->value.get (), &opts);
+    }
+
 #if HAVE_PYTHON
   if (var->dynamic->pretty_printer)
     {
@@ -793,22 +809,28 @@ varobj_list_children (struct varobj *var, int *from, int *to)
 
   /* If we're called when the list of children is not yet initialized,
      allocate enough elements in it.  */
-  while (var->children.size () < var->num_children)
-    var->children.push_back (NULL);
+  if (var->children.size () < var->num_children)
+    var->children.resize (var->num_children, NULL);
+
+  /* Only create the children in the requested range, so that listing
+     a window of the elements of a huge array does not cost more than
+     the size of the window.  The other children are created if and
+     when they are requested.  */
+  varobj_restrict_range (var->children, from, to);
 
-  for (int i = 0; i < var->num_children; i++)
+  for (int i = *from; i < *to; i++)
     {
       if (var->children[i] == NULL)
 	{
 	  /* Either it's the first call to varobj_list_children for
-	     this variable object, and the child was never created,
-	     or it was explicitly deleted by the client.  */
+	     this variable object covering this child, and the child
+	     was never created, or it was explicitly deleted by the
+	     client.  */
 	  std::string name = name_of_child (var, i);
 	  var->children[i] = create_child (var, i, name);
 	}
     }
 
-  varobj_restrict_range (var->children, from, to);
   return var->children;
 }
 
@@ -927,7 +949,8 @@ varobj_get_attributes (const struct varobj *var)
 bool
 varobj_is_dynamic_p (const struct varobj *var)
 {
-  return var->dynamic->pretty_printer != NULL;
+  return (var->dynamic->pretty_printer != NULL
+	  || var->dynamic->native_children);
 }
 
 std::string
@@ -1025,6 +1048,7 @@ install_visualizer (struct varobj_dynamic *var, PyObject *constructor,
   Py_XDECREF (var->pretty_printer);
   var->pretty_printer = visualizer;
 
+  var->native_children = false;
   var->child_iter.reset (nullptr);
 }
 
@@ -1103,6 +1127,38 @@ construct_visualizer (struct varobj *var, PyObject *constructor)
 static void
 install_new_value_visualizer (struct varobj *var)
 {
+  /* A visualizer set with -var-set-visualizer, or None, overrides the
+     native pretty-printers.  */
+  if (var->dynamic->constructor == NULL)
+    {
+      bool native = false;
+
+      if (pretty_printing && var->value != NULL && !CPLUS_FAKE_CHILD (var))
+	{
+	  value_print_options opts;
+	  varobj_formatted_print_options (&opts, var->format);
+	  native = native_printer_has_children (var->value.get (), &opts);
+	}
+
+      if (native != var->dynamic->native_children)
+	{
+	  var->dynamic->native_children = native;
+	  var->dynamic->child_iter.reset (nullptr);
+	}
+    }
+
+  if (var->dynamic->native_children)
+    {
+#if HAVE_PYTHON
+      if (var->dynamic->pretty_printer != NULL && gdb_python_initialized)
+	{
+	  gdbpy_enter_varobj enter_py (var);
+	  Py_CLEAR (var->dynamic->pretty_printer);
+	}
+#endif
+      return;
+    }
+
 #if HAVE_PYTHON
   /* If the constructor is None, then we want the raw value.  If VAR
      does not have a value, just skip this.  */
@@ -1189,7 +1245,7 @@ install_new_value (struct varobj *var, struct value *value, bool initial)
   /* If the type has custom visualizer, we consider it to be always
      changeable.  FIXME: need to make sure this behaviour will not
      mess up read-sensitive values.  */
-  if (var->dynamic->pretty_printer != NULL)
+  if (varobj_is_dynamic_p (var))
     changeable = true;
 
   need_to_fetch = changeable;
@@ -1262,7 +1318,7 @@ install_new_value (struct varobj *var, struct value *value, bool initial)
      should not be fetched.  */
   std::string print_value;
   if (value != NULL && !value->lazy ()
-      && var->dynamic->pretty_printer == NULL)
+      && !varobj_is_dynamic_p (var))
     print_value = varobj_value_get_print_value (value, var->format, var);
 
   /* If the type is changeable, compare the old and the new values.
@@ -1277,7 +1333,7 @@ install_new_value (struct varobj *var, struct value *value, bool initial)
 	 varobj as changed.  */
       if (var->updated)
 	changed = true;
-      else if (var->dynamic->pretty_printer == NULL)
+      else if (!varobj_is_dynamic_p (var))
 	{
 	  /* Try to compare the values.  That requires that both
 	     values are non-lazy.  */
@@ -1330,7 +1386,7 @@ install_new_value (struct varobj *var, struct value *value, bool initial)
 
   /* If we installed a pretty-printer, re-compare the printed version
      to see if the variable changed.  */
-  if (var->dynamic->pretty_printer != NULL)
+  if (varobj_is_dynamic_p (var))
     {
       print_value = varobj_value_get_print_value (var->value.get (),
 						  var->format, var);
@@ -1434,6 +1490,205 @@ varobj_value_has_mutated (const struct varobj *var, struct value *new_value,
     return false;
 }
 
+/* Whether a batch prefetch of the memory of all the root variable
+   objects is in effect, see scoped_varobj_prefetch.  */
+
+static bool varobj_prefetch_active = false;
+
+/* Return true if the values of the variable object ROOT are read from
+   the memory of the current inferior.  */
+
+static bool
+varobj_root_in_current_inferior (const struct varobj_root *root)
+{
+  if (root->valid_block == NULL || root->floating || root->thread_id == 0)
+    return true;
+
+  thread_info *thread = find_thread_global_id (root->thread_id);
+  return thread != NULL && thread->inf == current_inferior ();
+}
+
+/* Append to RANGES the memory ranges the current values of VAR and of
+   the children of VAR that varobj_update would visit were read from.  */
+
+static void
+collect_varobj_memory_ranges
+  (struct varobj *var, std::vector<std::pair<CORE_ADDR, ULONGEST>> *ranges)
+{
+  std::vector<struct varobj *> stack { var };
+
+  while (!stack.empty ())
+    {
+      struct varobj *v = stack.back ();
+      stack.pop_back ();
+
+      struct value *val = v->value.get ();
+      if (val != NULL
+	  && val->lval () == lval_memory
+	  && !val->lazy ()
+	  && val->bitsize () == 0
+	  && val->type ()->length () > 0)
+	ranges->emplace_back (val->address (), val->type ()->length ());
+
+      for (varobj *c : v->children)
+	if (c != NULL && !c->frozen)
+	  stack.push_back (c);
+    }
+}
+
+/* Read the memory ranges in RANGES from the target in as few requests
+   as possible, so that the memory reads done while updating variable
+   objects are served locally.  Overlapping and adjacent ranges are
+   merged.  Ranges that cannot be read are ignored; the update reports
+   the error, if any, for the value concerned.  */
+
+static void
+prefetch_varobj_memory_ranges
+  (std::vector<std::pair<CORE_ADDR, ULONGEST>> &ranges)
+{
+  if (ranges.empty ())
+    return;
+
+  std::sort (ranges.begin (), ranges.end ());
+
+  CORE_ADDR start = ranges[0].first;
+  CORE_ADDR end = start + ranges[0].second;
+
+  auto prefetch = [] (CORE_ADDR addr, ULONGEST len)
+    {
+      try
+	{
+	  target_prefetch_memory (addr, len);
+	}
+      catch (const gdb_exception_error &except)
+	{
+	}
+    };
+
+  for (const auto &range : ranges)
+    {
+      if (range.first > end)
+	{
+	  prefetch (start, end - start);
+	  start = range.first;
+	}
+      end = std::max (end, range.first + range.second);
+    }
+  prefetch (start, end - start);
+}
+
+/* See varobj.h.  */
+
+scoped_varobj_prefetch::scoped_varobj_prefetch ()
+{
+  if (varobj_prefetch_active)
+    return;
+
+  std::vector<std::pair<CORE_ADDR, ULONGEST>> ranges;
+  for (struct varobj_root *root : rootlist)
+    if (root->is_valid
+	&& !root->rootvar->frozen
+	&& varobj_root_in_current_inferior (root))
+      collect_varobj_memory_ranges (root->rootvar, &ranges);
+
+  prefetch_varobj_memory_ranges (ranges);
+  varobj_prefetch_active = true;
+  m_active = true;
+}
+
+/* See varobj.h.  */
+
+scoped_varobj_prefetch::~scoped_varobj_prefetch ()
+{
+  if (!m_active)
+    return;
+
+  target_prefetch_invalidate ();
+  varobj_prefetch_active = false;
+}
+
+/* Return true if the printed value of VAR, and the list of its
+   children, only depend on the bytes of its value.  This is not the
+   case for references, which are printed with the object they refer
+   to, for pointers to characters, which are printed with the string
+   they point to, and for pointers to classes when "set print object"
+   is on, whose dynamic type depends on the object they point to.  Only
+   the C and C++ rules are known here.  */
+
+static bool
+varobj_value_self_contained_p (const struct varobj *var)
+{
+  if (var->root->lang_ops != &c_varobj_ops
+      && var->root->lang_ops != &cplus_varobj_ops)
+    return false;
+
+  struct type *type = check_typedef (var->value->type ());
+  if (TYPE_IS_REFERENCE (type))
+    return false;
+
+  if (type->code () != TYPE_CODE_PTR)
+    return true;
+
+  struct type *target = type->target_type ();
+  if (c_textual_element_type (target, 0))
+    return false;
+
+  struct value_print_options opts;
+  get_user_print_options (&opts);
+  if (opts.objectprint
+      && check_typedef (target)->code () == TYPE_CODE_STRUCT)
+    return false;
+
+  return true;
+}
+
+/* Return true if VAR, whose parent did not change, still has the value
+   it had after the last update: its value was read from memory, its
+   printed value only depends on that memory, and the target memory it
+   was read from holds the same bytes.  Then there is no need to
+   compute a new value.  */
+
+static bool
+varobj_memory_unchanged_p (const struct varobj *var)
+{
+  struct value *val = var->value.get ();
+
+  if (val == NULL
+      || var->updated
+      || var->not_fetched
+      || varobj_is_dynamic_p (var))
+    return false;
+
+  if (val->lval () != lval_memory
+      || val->lazy ()
+      || val->bitsize () != 0
+      || !val->entirely_available ()
+      || val->optimized_out ()
+      || !varobj_value_self_contained_p (var))
+    return false;
+
+  ULONGEST len = val->type ()->length ();
+  gdb::byte_vector buf (len);
+  if (target_read_memory (val->address (), buf.data (), len) != 0)
+    return false;
+
+  return memcmp (buf.data (), val->contents ().data (), len) == 0;
+}
+
+/* Return true if the values OLD_VAL and NEW_VAL of a variable object
+   live at the same place in memory, which means that the children of
+   the variable object live at the same place too, unless its type
+   changed.  */
+
+static bool
+varobj_value_same_location_p (struct value *old_val, struct value *new_val)
+{
+  return (old_val != NULL && new_val != NULL
+	  && old_val->lval () == lval_memory
+	  && new_val->lval () == lval_memory
+	  && old_val->address () == new_val->address ());
+}
+
 /* Update the values for a variable and its children.  This is a
    two-pronged attack.  First, re-parse the value for the root's
    expression to see if it's changed.  Then go all the way
@@ -1471,9 +1726,32 @@ varobj_update (struct varobj **varp, bool is_explicit)
       return result;
     }
 
+  /* Fetch the memory the values were read from last time in one go,
+     unless the caller already did it for all the variable objects.
+     Most of it is read again below, either to compute the new values
+     or to find out that they did not change.  */
+  bool same_inferior = varobj_root_in_current_inferior ((*varp)->root);
+  bool prefetched = false;
+  if (!varobj_prefetch_active && same_inferior)
+    {
+      std::vector<std::pair<CORE_ADDR, ULONGEST>> ranges;
+
+      collect_varobj_memory_ranges (*varp, &ranges);
+      prefetch_varobj_memory_ranges (ranges);
+      prefetched = true;
+    }
+  SCOPE_EXIT
+    {
+      /* Other threads may be running in non-stop mode, don't let the
+	 prefetched memory outlive the update.  */
+      if (prefetched)
+	target_prefetch_invalidate ();
+    };
+
   if ((*varp)->root->rootvar == *varp)
     {
       varobj_update_result r (*varp);
+      value_ref_ptr old_value = (*varp)->value;
 
       /* Update the root variable.  value_of_root can return NULL
 	 if the variable is no longer around, i.e. we stepped out of
@@ -1491,6 +1769,10 @@ varobj_update (struct varobj **varp, bool is_explicit)
       if (newobj == NULL)
 	r.status = VAROBJ_NOT_IN_SCOPE;
       r.value_installed = true;
+      r.unchanged_in_place
+	= (same_inferior && !r.changed && !r.type_changed
+	   && varobj_value_same_location_p (old_value.get (),
+					    (*varp)->value.get ()));
 
       if (r.status == VAROBJ_NOT_IN_SCOPE)
 	{
@@ -1513,10 +1795,20 @@ varobj_update (struct varobj **varp, bool is_explicit)
       struct varobj *v = r.varobj;
 
       /* Update this variable, unless it's a root, which is already
-	 updated.  */
-      if (!r.value_installed)
+	 updated.  If neither the parent nor the memory this variable
+	 was read from changed, then its value did not either; keep
+	 it.  */
+      if (!r.value_installed
+	  && r.parent_unchanged_in_place
+	  && varobj_memory_unchanged_p (v))
+	{
+	  r.value_installed = true;
+	  r.unchanged_in_place = true;
+	}
+      else if (!r.value_installed)
 	{
 	  struct type *new_type;
+	  value_ref_ptr old_value = v->value;
 
 	  newobj = value_of_child (v->parent, v->index);
 	  if (update_type_if_necessary (v, newobj))
@@ -1543,6 +1835,16 @@ varobj_update (struct varobj **varp, bool is_explicit)
 	      r.changed = true;
 	      v->updated = false;
 	    }
+
+	  /* C++ fake children (public/protected/private) have no value
+	     of their own, they stand for their parent.  */
+	  if (CPLUS_FAKE_CHILD (v))
+	    r.unchanged_in_place = r.parent_unchanged_in_place;
+	  else
+	    r.unchanged_in_place
+	      = (!r.changed && !r.type_changed
+		 && varobj_value_same_location_p (old_value.get (),
+						  v->value.get ()));
 	}
 
       /* We probably should not get children of a dynamic varobj, but
@@ -1643,7 +1945,10 @@ varobj_update (struct varobj **varp, bool is_explicit)
 
 	  /* Child may be NULL if explicitly deleted by -var-delete.  */
 	  if (c != NULL && !c->frozen)
-	    stack.emplace_back (c);
+	    {
+	      stack.emplace_back (c);
+	      stack.back ().parent_unchanged_in_place = r.unchanged_in_place;
+	    }
 	}
 
       if (r.changed || r.type_changed)
@@ -2102,7 +2407,7 @@ my_value_of_variable (struct varobj *var, enum varobj_display_formats format)
 {
   if (var->root->is_valid)
     {
-      if (var->dynamic->pretty_printer != NULL)
+      if (varobj_is_dynamic_p (var))
 	return varobj_value_get_print_value (var->value.get (), var->format,
 					     var);
       else if (var->parent != nullptr && varobj_is_dynamic_p (var->parent))
@@ -78,6 +78,14 @@ struct varobj_update_result
      be yet installed.  Don't use this outside varobj.c.  */
   bool value_installed = false;
 
+  /* These are used internally by varobj_update to skip recomputing the
+     values of children whose parent did not change: the first is set
+     if the value of varobj did not change and is still at the same
+     place in memory, the second if that is the case for the parent of
+     varobj.  Don't use them outside varobj.c.  */
+  bool unchanged_in_place = false;
+  bool parent_unchanged_in_place = false;
+
   /* This will be non-NULL when new children were added to the varobj.
      It lists the new children (which must necessarily come at the end
      of the child list) added during an update.  The caller is
@@ -286,7 +294,8 @@ extern int varobj_get_num_children (struct varobj *var);
    return, *FROM and *TO will be updated to indicate the real range
    that was returned.  The resulting vector will contain at least the
    children from *FROM to just before *TO; it might contain more
-   children, depending on whether any more were available.  */
+   children, depending on whether any more were available.  Children
+   outside of that range that were never requested are NULL.  */
 extern const std::vector<varobj *> &
   varobj_list_children (struct varobj *var, int *from, int *to);
 
@@ -314,6 +323,27 @@ extern void all_root_varobjs (gdb::function_view<void (struct varobj *var)>);
 extern std::vector<varobj_update_result>
   varobj_update (struct varobj **varp, bool is_explicit);
 
+/* While an instance of this class is alive, the target memory the
+   values of all the variable objects were last read from is held
+   locally, having been read in as few requests as possible when the
+   instance was created.  Use this when updating many variable
+   objects; each call to varobj_update otherwise does the same for
+   the variable object it updates.  */
+
+class scoped_varobj_prefetch
+{
+public:
+  scoped_varobj_prefetch ();
+  ~scoped_varobj_prefetch ();
+
+  DISABLE_COPY_AND_ASSIGN (scoped_varobj_prefetch);
+
+private:
+  /* False if another instance was already alive when this one was
+     created.  */
+  bool m_active = false;
+};
+
 /* Try to recreate any global or floating varobj.  This is called after
    changing symbol files.  */
 
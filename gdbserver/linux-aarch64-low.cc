@@ -141,6 +141,8 @@ protected:
 
   bool low_supports_range_stepping () override;
 
+  bool low_range_stepping_stops_at (CORE_ADDR pc) override;
+
   bool low_supports_catch_syscall () override;
 
   void low_get_syscall_trapinfo (regcache *regcache, int *sysno) override;
@@ -3404,6 +3406,31 @@ aarch64_target::low_supports_range_stepping ()
   return true;
 }
 
+/* Implementation of linux target ops method
+   "low_range_stepping_stops_at".  */
+
+bool
+aarch64_target::low_range_stepping_stops_at (CORE_ADDR pc)
+{
+  uint32_t insn;
+
+  /* Stepping from a load exclusive to its store exclusive clears the
+     exclusive monitor, so the store fails and the sequence loops
+     forever.  Stop at the load; GDB steps over the whole sequence
+     with breakpoints, like it does without range stepping.  This
+     matches the check in gdb/aarch64-tdep.c
+     (aarch64_software_single_step).  AArch32 code is not range
+     stepped through either.  */
+  if (!is_64bit_tdesc ())
+    return true;
+
+  if (target_read_uint32 (pc, &insn) != 0)
+    return true;
+
+  /* Load/store exclusive class, with the L bit set.  */
+  return (insn & 0x3f000000) == 0x08000000 && (insn & (1 << 22)) != 0;
+}
+
 /* Implementation of target ops method "sw_breakpoint_from_kind".  */
 
 const gdb_byte *
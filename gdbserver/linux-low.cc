@@ -3290,8 +3290,11 @@ linux_process_target::wait_1 (ptid_t ptid, target_waitstatus *ourstatus,
     }
 
   /* Note that all addresses are always "out of the step range" when
-     there's no range to begin with.  */
-  in_step_range = lwp_in_step_range (event_child);
+     there's no range to begin with.  Where the low target can't range
+     step from the PC, treat it as out of the range too, so that GDB
+     steps from there.  */
+  in_step_range = (lwp_in_step_range (event_child)
+		   && !low_range_stepping_stops_at (event_child->stop_pc));
 
   /* If GDB wanted this thread to single step, and the thread is out
      of the step range, we always want to report the SIGTRAP, and let
@@ -3337,7 +3340,7 @@ linux_process_target::wait_1 (ptid_t ptid, target_waitstatus *ourstatus,
       if (trace_event)
 	threads_debug_printf ("Tracepoint event.");
 
-      if (lwp_in_step_range (event_child))
+      if (in_step_range)
 	threads_debug_printf ("Range stepping pc 0x%s [0x%s, 0x%s).",
 			      paddress (event_child->stop_pc),
 			      paddress (event_child->step_range_start),
@@ -3396,7 +3399,7 @@ linux_process_target::wait_1 (ptid_t ptid, target_waitstatus *ourstatus,
 	    if (event_child->step_range_start == event_child->step_range_end)
 	      threads_debug_printf
 		("GDB wanted to single-step, reporting event.");
-	    else if (!lwp_in_step_range (event_child))
+	    else if (!in_step_range)
 	      threads_debug_printf ("Out of step range, reporting event.");
 	  }
 
@@ -5988,6 +5991,12 @@ linux_process_target::low_supports_range_stepping ()
   return false;
 }
 
+bool
+linux_process_target::low_range_stepping_stops_at (CORE_ADDR pc)
+{
+  return false;
+}
+
 bool
 linux_process_target::supports_pid_to_exec_file ()
 {
@@ -688,9 +688,21 @@ class linux_process_target : public process_stratum_target
      success, -1 on failure.  */
   virtual int low_get_thread_area (int lwpid, CORE_ADDR *addrp);
 
-  /* Returns true if the low target supports range stepping.  */
+  /* Returns true if the low target supports range stepping.  Range
+     stepping single-steps the thread until its PC leaves the range, so
+     only architectures where that can't livelock should opt in.  For
+     example, on PowerPC, single-stepping a lwarx/stwcx. sequence
+     clears the reservation and the stwcx. fails forever.  */
   virtual bool low_supports_range_stepping ();
 
+  /* Return true if range stepping must stop at PC, even inside the
+     range, and let GDB step from there.  Targets that support range
+     stepping but have load-exclusive/store-exclusive sequences return
+     true at the load, since single-stepping the sequence would make
+     the store fail forever.  GDB steps over the whole sequence at
+     once.  */
+  virtual bool low_range_stepping_stops_at (CORE_ADDR pc);
+
   /* Return true if the target supports catch syscall.  Such targets
      override the low_get_syscall_trapinfo method below.  */
   virtual bool low_supports_catch_syscall ();
@@ -106,6 +106,8 @@ protected:
   bool low_breakpoint_at (CORE_ADDR pc) override;
 
   int low_get_thread_area (int lwpid, CORE_ADDR *addrp) override;
+
+  bool low_supports_range_stepping () override;
 };
 
 /* The singleton target ops object.  */
@@ -806,6 +808,18 @@ s390_target::low_get_thread_area (int lwpid, CORE_ADDR *addrp)
   return 0;
 }
 
+/* Implementation of linux target ops method
+   "low_supports_range_stepping".  */
+
+bool
+s390_target::low_supports_range_stepping ()
+{
+  /* z/Architecture has no load-reserved/store-conditional pairs that
+     single-stepping could break; atomic updates are done by single
+     compare-and-swap instructions.  */
+  return true;
+}
+
 
 /* Fast tracepoint support.
 
@@ -106,6 +106,13 @@ struct btrace_config_bts
      This is unsigned int and not size_t since it is registered as
      control variable for "set record btrace bts buffer-size".  */
   unsigned int size;
+
+  /* The size in bytes of the ring in a temporary file the trace is
+     continuously copied to while the inferior runs, or zero if the trace
+     is only read from the branch trace buffer when it is needed.
+
+     This is unsigned int for the same reason as SIZE.  */
+  unsigned int spill_size;
 };
 
 /* An Intel Processor Trace configuration.  */
@@ -117,6 +124,13 @@ struct btrace_config_pt
      This is unsigned int and not size_t since it is registered as
      control variable for "set record btrace pt buffer-size".  */
   unsigned int size;
+
+  /* The size in bytes of the ring in a temporary file the trace is
+     continuously copied to while the inferior runs, or zero if the trace
+     is only read from the branch trace buffer when it is needed.
+
+     This is unsigned int for the same reason as SIZE.  */
+  unsigned int spill_size;
 };
 
 /* A branch tracing configuration.